@@ -17,7 +17,7 @@
 
 #include "apc.h"
 
-int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
+static int add_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
 {
     /* Validate input parameters */
     if (head1 == NULL || tail1 == NULL || head2 == NULL || tail2 == NULL || headR == NULL)
@@ -26,6 +26,7 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
     }
 
     /* Step 1: Count decimal places in both numbers */
+    STAT_PHASE_BEGIN(align_start);
     int decimal1 = count_decimal_places(*head1);
     int decimal2 = count_decimal_places(*head2);
     int max_decimal = (decimal1 > decimal2) ? decimal1 : decimal2;
@@ -46,11 +47,15 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
     /* Step 3: Remove decimal points (store position for later) */
+    STAT_PHASE_BEGIN(remove_dot_start);
     remove_dot(head1);
     remove_dot(head2);
     
     /* Update tail pointers after removing decimal */
+    STAT_ADD(list_traversals, 2);
     Dlist *temp = *head1;
     while (temp != NULL && temp->next != NULL)
     {
@@ -64,8 +69,11 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         temp = temp->next;
     }
     *tail2 = temp;
+    STAT_PHASE_END(STAT_PHASE_REMOVE_DOT, remove_dot_start);
 
     /* Step 4: Perform addition from right to left */
+    STAT_PHASE_BEGIN(kernel_start);
+    STAT_ADD(list_traversals, 1);
     Dlist *t1 = *tail1;
     Dlist *t2 = *tail2;
     int carry = 0;
@@ -76,6 +84,7 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         int val2 = (t2 != NULL) ? t2->data : 0;
 
         int sum = val1 + val2 + carry;
+        STAT_ADD(digit_ops, 1);
         carry = sum / 10;
         int digit = sum % 10;
 
@@ -88,13 +97,17 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         if (t2 != NULL) t2 = t2->prev;
     }
 
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
     /* Step 5: Insert decimal point if needed */
+    STAT_PHASE_BEGIN(normalize_start);
     if (max_decimal > 0)
     {
         /* Find the position to insert decimal from the right */
         Dlist *temp_r = *headR;
         
         /* Move to the end */
+        STAT_ADD(list_traversals, 1);
         while (temp_r != NULL && temp_r->next != NULL)
         {
             temp_r = temp_r->next;
@@ -109,7 +122,7 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         /* Insert decimal point */
         if (temp_r != NULL)
         {
-            Dlist *decimal_node = malloc(sizeof(Dlist));
+            Dlist *decimal_node = node_alloc();
             if (decimal_node == NULL)
             {
                 return FAILURE;
@@ -128,6 +141,7 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
     }
 
     /* Update tailR pointer */
+    STAT_ADD(list_traversals, 1);
     temp = *headR;
     while (temp != NULL && temp->next != NULL)
     {
@@ -150,5 +164,18 @@ int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist *
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * Statistics builds time the whole operation around the list arithmetic
+ */
+int addition(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = add_lists(head1, tail1, head2, tail2, headR, tailR);
+    STAT_OP_END(STAT_OP_ADD, op_start);
+    return status;
+}
@@ -13,6 +13,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /* Macro Definitions */
 #define SUCCESS 0
@@ -20,6 +23,25 @@
 #define TRUE 1
 #define FALSE 0
 
+/* Default number of decimal places computed by division (overridable at runtime) */
+#define DIVISION_PRECISION 10
+
+/* Operator character of a named operator ("square 12") in perform_operation */
+#define OPERATOR_SQUARE 's'
+
+/* Operator character of a modular power ("4 ^ 13 mod 497") in perform_operation */
+#define OPERATOR_POWER_MOD 'p'
+
+/* Operator characters of the roots ("sqrt 2", "isqrt 99", "27 root 3") in perform_operation */
+#define OPERATOR_SQRT 'q'
+#define OPERATOR_ISQRT 'i'
+#define OPERATOR_ROOT 'r'
+
+/* Operator characters of "12 gcd 18", "4 lcm 6" and "3 invmod 7" in perform_operation */
+#define OPERATOR_GCD 'g'
+#define OPERATOR_LCM 'l'
+#define OPERATOR_INVMOD 'v'
+
 /* Type Definitions */
 typedef int data_t;
 
@@ -30,6 +52,52 @@ typedef enum {
     SECOND_LARGER = 2
 } ComparisonResult;
 
+/* Rounding applied to the last digit of a division result */
+typedef enum {
+    ROUND_TRUNCATE = 0,   /* Toward zero (default) */
+    ROUND_HALF_EVEN,      /* To nearest, ties to even digit */
+    ROUND_HALF_UP,        /* To nearest, ties away from zero */
+    ROUND_FLOOR,          /* Toward negative infinity */
+    ROUND_CEIL            /* Toward positive infinity */
+} RoundingMode;
+
+/* Result formatting (grouping applies to the integer part of plain notation only) */
+typedef struct {
+    int group_size;         /* Integer digits per group (0 = no grouping) */
+    char group_separator;   /* Character placed between groups */
+    int scientific;         /* TRUE for d.ddd...e+N notation */
+    int significant;        /* Mantissa digits in scientific notation (0 = all), rounded half up
+                               and padded with zeros */
+    int radix;              /* 10, or 16 for 0x... hexadecimal integers */
+} FormatOptions;
+
+/* Representation of operands and results on the command line */
+typedef enum {
+    NUMBER_FORMAT_TEXT = 0,   /* Decimal (or 0x hexadecimal) text */
+    NUMBER_FORMAT_BINARY      /* Binary number files (bn_binary.c) */
+} NumberFormat;
+
+/* Calculator Options (parsed from leading --option arguments) */
+typedef struct {
+    int precision;          /* Fractional digits produced by division */
+    RoundingMode rounding;  /* Rounding mode for the last fractional digit */
+    const char *batch_path; /* Batch input file ("-" = stdin), NULL for one expression */
+    int threads;            /* Batch workers and threads of one large operation (0 = all online cores) */
+    int tune;               /* TRUE to measure and save the kernel thresholds */
+    const char *tune_path;  /* Thresholds file to write (NULL = default location) */
+    int stats;              /* TRUE to print operation statistics to stderr */
+    FormatOptions format;   /* How results are written */
+    NumberFormat input_format;  /* Operands are text or binary number file paths */
+    NumberFormat output_format; /* Result as text or a binary number on stdout */
+    const char *stream_path;    /* Out-of-core result file for --stream, NULL otherwise */
+} CalcOptions;
+
+/* Thread Pool (opaque; see thread_pool.c) */
+typedef struct thread_pool ThreadPool;
+
+/* Pool task: receives its argument and the index of the worker running it */
+typedef void (*task_fn)(void *arg, int worker);
+
 /* Doubly Linked List Node Structure */
 typedef struct node {
     struct node *prev;
@@ -37,14 +105,123 @@ typedef struct node {
     struct node *next;
 } Dlist;
 
-/* Big Number Structure (for future enhancement) */
+/* Operations and phases timed by the statistics layer (stats.c) */
+typedef enum {
+    STAT_OP_PARSE = 0,
+    STAT_OP_FORMAT,
+    STAT_OP_ADD,
+    STAT_OP_SUB,
+    STAT_OP_MUL,
+    STAT_OP_DIV,
+    STAT_OP_POW,              /* bn_power, bn_power_mod               */
+    STAT_OP_MOD,              /* bn_mod, bn_divmod                    */
+    STAT_OP_ROOT,             /* bn_sqrt, bn_isqrt, bn_root           */
+    STAT_OP_GCD,              /* bn_gcd, bn_gcdext, bn_lcm, bn_invmod */
+    STAT_OP_COUNT
+} StatOp;
+
+typedef enum {
+    STAT_PHASE_ALIGN = 0,     /* Matching decimal places        */
+    STAT_PHASE_REMOVE_DOT,    /* Dropping '.' nodes from lists  */
+    STAT_PHASE_KERNEL,        /* The digit / limb arithmetic    */
+    STAT_PHASE_NORMALIZE,     /* Rounding, zero trimming, '.'   */
+    STAT_PHASE_COUNT
+} StatPhase;
+
+/* Statistics Counters (per thread; all zero unless built with -DAPC_STATS) */
 typedef struct {
-    Dlist *head;
-    Dlist *tail;
-    int is_negative;
+    uint64_t node_allocs;                  /* List nodes handed out                  */
+    uint64_t node_frees;                   /* List nodes released                    */
+    uint64_t node_recycled;                /* ... allocations served by freed nodes  */
+    uint64_t node_slabs;                   /* malloc calls made for node slabs       */
+    uint64_t node_peak_live;               /* Most list nodes in use at once         */
+    uint64_t list_traversals;              /* Node-by-node walks over a list         */
+    uint64_t digit_ops;                    /* Single-digit arithmetic steps (lists)  */
+    uint64_t limb_ops;                     /* Limb arithmetic steps (BigNumber)      */
+    uint64_t op_calls[STAT_OP_COUNT];      /* Outermost operations completed         */
+    uint64_t op_ns[STAT_OP_COUNT];         /* Wall time of those operations          */
+    uint64_t phase_ns[STAT_PHASE_COUNT];   /* Wall time per phase                    */
+} OpStats;
+
+/* Limb Definitions: a limb stores 9 decimal digits (base 10^9) */
+typedef uint32_t limb_t;
+#define LIMB_BASE 1000000000u
+#define LIMB_DIGITS 9
+
+/* Largest product (na + nb limbs) the three-prime NTT can compute exactly */
+#define NTT_MAX_LENGTH ((size_t)1 << 23)
+
+/* Kernel crossover points in limbs, loaded at startup (see thresholds.c).
+ * An operand of at least 'karatsuba' limbs is multiplied with Karatsuba, 'toom3' with
+ * Toom-3, 'ntt' with the NTT; 'newton_div' switches division to Newton reciprocals and
+ * 'parallel_add' spreads limb_add / limb_sub over the parallel_for threads, 'parallel_mul'
+ * limb_mul (from this shorter operand on). */
+typedef struct {
+    size_t karatsuba;
+    size_t toom3;
+    size_t ntt;
+    size_t newton_div;
+    size_t parallel_add;
+    size_t parallel_mul;
+} Thresholds;
+
+/* Body of a parallel loop: called once for every index below the loop count */
+typedef void (*parallel_fn)(void *arg, size_t index);
+
+/* Big Number Structure (contiguous base-10^9 representation)
+ * value = (-1)^is_negative * magnitude * 10^(-decimal_places)
+ * where magnitude = sum(limbs[i] * LIMB_BASE^i) */
+typedef struct {
+    limb_t *limbs;       /* Magnitude, least significant limb first */
+    size_t length;       /* Number of limbs in use (0 means the value is zero) */
+    size_t capacity;     /* Number of limbs allocated */
+    int is_negative;     /* TRUE if value < 0 (zero is never negative) */
     int decimal_places;  /* Number of digits after decimal point */
 } BigNumber;
 
+/* Running Fletcher-64 sums of a binary number file */
+typedef struct {
+    uint64_t low;
+    uint64_t high;
+} BinaryChecksum;
+
+/* Sequential reader of a binary number file (limbs least significant first) */
+typedef struct {
+    FILE *file;
+    int swapped;             /* File written on a host of the other byte order */
+    int failed;              /* Read error or a limb >= LIMB_BASE */
+    int is_negative;
+    int decimal_places;
+    uint64_t limb_count;     /* Limbs in the file */
+    uint64_t remaining;      /* Limbs not read yet */
+    uint64_t checksum;       /* Checksum stored in the header */
+    BinaryChecksum sums;     /* Checksum of what was read so far */
+} BinaryReader;
+
+/* Sequential writer of a binary number file (limbs least significant first) */
+typedef struct {
+    FILE *file;
+    uint64_t limb_count;     /* Limbs announced in the header */
+    uint64_t written;        /* Limbs written so far */
+    BinaryChecksum sums;
+} BinaryWriter;
+
+/* Barrett reduction modulo a fixed modulus (barrett.c) */
+typedef struct {
+    limb_t *modulus;         /* m, k limbs plus one zero limb */
+    size_t length;           /* k: limbs of m */
+    limb_t *mu;              /* floor(B^2k / m) */
+    size_t mu_length;
+    limb_t *scratch;         /* Work space of barrett_reduce */
+} BarrettContext;
+
+/* File mapping behind a read-only BigNumber view (bn_map_binary) */
+typedef struct {
+    void *base;          /* Mapped file (NULL if none) */
+    size_t size;         /* Mapped bytes */
+    limb_t *copy;        /* Byte-swapped limbs for a file of the other byte order (or NULL) */
+} BinaryMapping;
+
 /* ========================================
  * LIST MANIPULATION FUNCTIONS
  * ======================================== */
@@ -78,6 +255,22 @@ void print_list(Dlist *head);
  */
 void free_list(Dlist **head);
 
+/* ========================================
+ * NODE POOL FUNCTIONS
+ * ======================================== */
+
+/**
+ * @brief Allocate a list node from the calling thread's slab pool
+ * @return Uninitialized node, or NULL if a new slab could not be allocated
+ */
+Dlist *node_alloc(void);
+
+/**
+ * @brief Return a node to the pool's free list for reuse
+ * @param node Node obtained from node_alloc (NULL is ignored)
+ */
+void node_free(Dlist *node);
+
 /* ========================================
  * UTILITY FUNCTIONS
  * ======================================== */
@@ -164,7 +357,7 @@ ComparisonResult compare(int len1, int len2, Dlist *head1, Dlist *head2);
 void parse_operands(char **argv, int arg_index, int start_char, Dlist **head, Dlist **tail);
 
 /**
- * @brief Validate if a string is a valid number
+ * @brief Validate if a string is a valid number (decimal, or a "0x" hexadecimal integer)
  * @param str String to validate
  * @return TRUE if valid, FALSE otherwise
  */
@@ -225,42 +418,917 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, D
  */
 int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR);
 
+/* ========================================
+ * LIMB KERNEL FUNCTIONS
+ * Operate on raw little-endian base-10^9 limb arrays
+ * ======================================== */
+
+/**
+ * @brief Compare two limb arrays by magnitude
+ * @param a First array (no leading zero limbs)
+ * @param na Number of limbs in a
+ * @param b Second array (no leading zero limbs)
+ * @param nb Number of limbs in b
+ * @return FIRST_LARGER, SECOND_LARGER or NUMBERS_EQUAL
+ */
+ComparisonResult limb_compare(const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief Length of a limb array without its leading zero limbs
+ * @return Number of limbs up to and including the most significant nonzero one
+ */
+size_t limb_trimmed_length(const limb_t *x, size_t n);
+
+/**
+ * @brief x += 1 in place (the carry is dropped if it leaves the n limbs)
+ */
+void limb_increment(limb_t *x, size_t n);
+
+/**
+ * @brief x -= 1 in place (x must be nonzero)
+ */
+void limb_decrement(limb_t *x, size_t n);
+
+/**
+ * @brief r = a + b where na >= nb (r may alias a or b)
+ * @param r Output array with room for na limbs
+ * @return Carry out of the top limb (0 or 1)
+ */
+limb_t limb_add(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief r = a - b where na >= nb (r may alias a or b)
+ * @param r Output array with room for na limbs
+ * @return Borrow out of the top limb (0 or 1)
+ */
+limb_t limb_sub(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief r = a * m for a single limb multiplier (r may alias a)
+ * @return Carry out of the top limb
+ */
+limb_t limb_mul_small(limb_t *r, const limb_t *a, size_t n, limb_t m);
+
+/**
+ * @brief q = a / d for a single nonzero limb divisor (q may alias a)
+ * @return Remainder of the division
+ */
+limb_t limb_div_small(limb_t *q, const limb_t *a, size_t n, limb_t d);
+
+/**
+ * @brief r = a * b using schoolbook multiplication
+ * @param r Output array with room for na + nb limbs (must not alias a or b)
+ */
+void limb_mul_schoolbook(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief r = a^2 using schoolbook squaring (each cross product computed once)
+ * @param r Output array with room for 2n limbs (must not alias a)
+ */
+void limb_sqr_schoolbook(limb_t *r, const limb_t *a, size_t n);
+
+/**
+ * @brief r = a * b, dispatching to schoolbook, Karatsuba, Toom-3 or NTT by operand size.
+ *        The same array passed twice (a == b, na == nb) is squared with limb_sqr.
+ *        Building with -DAPC_MUL_CROSSCHECK verifies every NTT product against schoolbook.
+ * @param r Output array with room for na + nb limbs (must not alias a or b)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int limb_mul(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief r = a^2 with the squaring variant of the kernel limb_mul would pick for n x n limbs
+ * @param r Output array with room for 2n limbs (must not alias a)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int limb_sqr(limb_t *r, const limb_t *a, size_t n);
+
+/**
+ * @brief r = a * b via three-prime number-theoretic transform and CRT (exact);
+ *        a square (a == b, na == nb) needs one forward transform per prime instead of two
+ * @param r Output array with room for na + nb limbs (must not alias a or b)
+ * @return SUCCESS on success, FAILURE on memory error or na + nb > NTT_MAX_LENGTH
+ */
+int limb_mul_ntt(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief Long division (Knuth Algorithm D) of a by b
+ * @param q Output quotient with room for na - nb + 1 limbs (may be NULL)
+ * @param r Output remainder with room for nb limbs (may be NULL)
+ * @param a Dividend, na >= nb
+ * @param b Divisor, no leading zero limbs, nb >= 1
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int limb_divmod(limb_t *q, limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief Quotient and remainder of a / b, dispatching between Knuth Algorithm D and
+ *        Newton-Raphson reciprocal division by operand size (same contract as limb_divmod)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int limb_div(limb_t *q, limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb);
+
+/**
+ * @brief Integer square root s = floor(sqrt(a)) and remainder r = a - s^2, from a Newton
+ *        iteration on the reciprocal square root
+ * @param s Output with room for ceil(n / 2) limbs
+ * @param r Output with room for ceil(n / 2) + 1 limbs, or NULL
+ * @param a Input limbs (leading zero limbs allowed)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int limb_sqrt(limb_t *s, limb_t *r, const limb_t *a, size_t n);
+
+/* ========================================
+ * ALGORITHM THRESHOLDS
+ * ======================================== */
+
+/**
+ * @brief Thresholds used by limb_mul and limb_div; the thresholds file is read on first use
+ * @return Current thresholds (never NULL)
+ */
+const Thresholds *thresholds(void);
+
+/**
+ * @brief Replace the thresholds in effect, raising values below each algorithm's minimum.
+ *        Not synchronised with running operations: call it while no other thread computes.
+ * @param t New thresholds
+ */
+void set_thresholds(const Thresholds *t);
+
+/**
+ * @brief Fill in the compiled-in default thresholds
+ * @param t Output thresholds
+ */
+void default_thresholds(Thresholds *t);
+
+/**
+ * @brief Path of the thresholds file ($APC_THRESHOLDS, else $HOME/.apc_thresholds)
+ * @param path Output buffer
+ * @param size Size of the buffer
+ * @return SUCCESS, or FAILURE if no location is known or the buffer is too small
+ */
+int thresholds_file_path(char *path, size_t size);
+
+/**
+ * @brief Read a thresholds file; names it does not mention keep their value in 't'
+ * @param path File to read
+ * @param t In: fallback values, out: values from the file (clamped)
+ * @return SUCCESS, or FAILURE if the file cannot be opened
+ */
+int load_thresholds(const char *path, Thresholds *t);
+
+/**
+ * @brief Write thresholds in the format read by load_thresholds
+ * @return SUCCESS, or FAILURE if the file cannot be written
+ */
+int save_thresholds(const char *path, const Thresholds *t);
+
+/* ========================================
+ * BIG NUMBER FUNCTIONS
+ * ======================================== */
+
+/**
+ * @brief Initialize a BigNumber to zero without allocating
+ * @param num Number to initialize
+ */
+void bn_init(BigNumber *num);
+
+/**
+ * @brief Release the limb storage of a BigNumber and reset it to zero
+ * @param num Number to free
+ */
+void bn_free(BigNumber *num);
+
+/**
+ * @brief Make sure a BigNumber can hold at least capacity limbs
+ * @param num Number to grow
+ * @param capacity Required number of limbs
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_reserve(BigNumber *num, size_t capacity);
+
+/**
+ * @brief Strip leading zero limbs and clear the sign of zero
+ * @param num Number to normalize
+ */
+void bn_normalize(BigNumber *num);
+
+/**
+ * @brief Exchange the contents of two BigNumbers
+ */
+void bn_swap(BigNumber *a, BigNumber *b);
+
+/**
+ * @brief Deep-copy src into dest (dest is reused if large enough)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_copy(BigNumber *dest, const BigNumber *src);
+
+/**
+ * @brief Check whether a BigNumber is zero
+ * @return TRUE if zero, FALSE otherwise
+ */
+int bn_is_zero(const BigNumber *num);
+
+/**
+ * @brief Set a number to a non-negative integer that fits 64 bits
+ * @return SUCCESS on success, FAILURE on memory error (see last_error)
+ */
+int bn_set_small(BigNumber *num, uint64_t value);
+
+/**
+ * @brief Multiply the magnitude by 10^digits and add digits to decimal_places,
+ *        so the value is unchanged but represented with more fractional digits
+ * @param num Number to rescale in place
+ * @param digits Number of extra fractional digits (>= 0)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_scale_up(BigNumber *num, int digits);
+
+/**
+ * @brief Drop the decimal places of a number whose fractional digits are all zero (2.000 -> 2)
+ * @param num Number to convert
+ * @param result Output integer with decimal_places 0 (may alias num)
+ * @return SUCCESS, or FAILURE if num has a non-zero fractional part or on memory error (see last_error)
+ */
+int bn_to_integer(const BigNumber *num, BigNumber *result);
+
+/**
+ * @brief Bring two numbers to a common number of decimal places.
+ *        The operand with fewer decimal places is copied into scratch and rescaled;
+ *        the inputs themselves are never modified.
+ * @param a First number
+ * @param b Second number
+ * @param scratch Caller-owned storage for the rescaled copy (free with bn_free)
+ * @param a_out Output: a or its rescaled copy
+ * @param b_out Output: b or its rescaled copy
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_align_decimals(const BigNumber *a, const BigNumber *b, BigNumber *scratch,
+                      const BigNumber **a_out, const BigNumber **b_out);
+
+/**
+ * @brief Compare the absolute values of two numbers (decimals aligned)
+ * @return FIRST_LARGER if |a| > |b|, SECOND_LARGER if |a| < |b|, NUMBERS_EQUAL otherwise
+ */
+ComparisonResult bn_compare_abs(const BigNumber *a, const BigNumber *b);
+
+/**
+ * @brief Compare two signed numbers (decimals aligned)
+ * @return FIRST_LARGER if a > b, SECOND_LARGER if a < b, NUMBERS_EQUAL otherwise
+ */
+ComparisonResult bn_compare(const BigNumber *a, const BigNumber *b);
+
+/**
+ * @brief Parse a decimal string (optional '-', digits, optional '.') or a hexadecimal integer
+ *        ("0x" prefix) into a BigNumber, validating it in the same pass
+ * @param num Output number (existing storage is reused; zero if the text is invalid)
+ * @param str String to parse
+ * @return SUCCESS on success, FAILURE on invalid input or memory error (see last_error)
+ */
+int bn_from_string(BigNumber *num, const char *str);
+
+/**
+ * @brief Format a BigNumber into a reusable buffer (trailing fractional zeros removed)
+ * @param num Number to format
+ * @param text In/out: buffer (may be NULL), grown with realloc when too small
+ * @param text_capacity In/out: size of *text in bytes
+ * @param text_length Output: length of the formatted string (may be NULL)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_format(const BigNumber *num, char **text, size_t *text_capacity, size_t *text_length);
+
+/**
+ * @brief Format a BigNumber into a reusable buffer with digit grouping, scientific notation or
+ *        in hexadecimal
+ * @param num Number to format
+ * @param format Layout options (NULL = plain, same as bn_format)
+ * @param text In/out: buffer (may be NULL), grown with realloc when too small
+ * @param text_capacity In/out: size of *text in bytes
+ * @param text_length Output: length of the formatted string (may be NULL)
+ * @return SUCCESS on success, FAILURE on memory error or a hexadecimal non-integer (see last_error)
+ */
+int bn_format_with(const BigNumber *num, const FormatOptions *format, char **text,
+                   size_t *text_capacity, size_t *text_length);
+
+/**
+ * @brief Format a BigNumber as a decimal string (trailing fractional zeros removed)
+ * @param num Number to format
+ * @return Newly allocated string (caller frees), or NULL on memory error
+ */
+char *bn_to_string(const BigNumber *num);
+
+/**
+ * @brief Print a BigNumber to stdout with a single write
+ * @param num Number to print
+ * @param format Layout options (NULL = plain)
+ */
+void bn_print(const BigNumber *num, const FormatOptions *format);
+
+/**
+ * @brief Write the nine decimal digits of a limb, leading zeros included (no terminator)
+ * @param slot Output with room for LIMB_DIGITS characters
+ * @param limb Limb value (< LIMB_BASE)
+ */
+void limb_to_digits(char *slot, limb_t limb);
+
+/**
+ * @brief |result| = |a| + |b| with decimal alignment (sign of result cleared)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_add_abs(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief |result| = |a| - |b| with decimal alignment, requires |a| >= |b|
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_sub_abs(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief Signed addition: result = a + b (result may alias a or b)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_add(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief Signed subtraction: result = a - b (result may alias a or b)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_subtract(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief Signed multiplication: result = a * b (result may alias a or b)
+ *        decimal_places of the result = a.decimal_places + b.decimal_places
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_multiply(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief Square: result = a * a (result may alias a); bn_multiply squares equal operands too
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int bn_square(const BigNumber *a, BigNumber *result);
+
+/**
+ * @brief Signed division: result = a / b with 'precision' fractional digits
+ * @param a Dividend
+ * @param b Divisor
+ * @param result Output quotient (may alias a or b)
+ * @param precision Number of fractional digits to compute (>= 0)
+ * @param mode Rounding applied to the last computed digit
+ * @return SUCCESS on success, FAILURE on division by zero, bad precision or memory error
+ */
+int bn_divide(const BigNumber *a, const BigNumber *b, BigNumber *result,
+              int precision, RoundingMode mode);
+
+/**
+ * @brief Truncating division with remainder: quotient = trunc(a / b) (an integer) and
+ *        remainder = a - quotient * b (sign of a, decimals of the more precise operand),
+ *        both from one division
+ * @param quotient Output quotient, or NULL (may alias a or b)
+ * @param remainder Output remainder, or NULL (may alias a or b; not the same as quotient)
+ * @return SUCCESS on success, FAILURE on division by zero or memory error
+ */
+int bn_divmod(const BigNumber *a, const BigNumber *b, BigNumber *quotient, BigNumber *remainder);
+
+/**
+ * @brief Remainder of bn_divmod alone: remainder = a % b. Long divisors are reduced with a
+ *        Barrett context cached per thread, so repeated reductions by one modulus skip
+ *        the full division.
+ * @return SUCCESS on success, FAILURE on division by zero or memory error
+ */
+int bn_mod(const BigNumber *a, const BigNumber *b, BigNumber *remainder);
+
+/**
+ * @brief Parse a rounding mode name (truncate, half-even, half-up, floor, ceil)
+ * @param name Mode name
+ * @param mode Output: parsed mode
+ * @return SUCCESS if the name is known, FAILURE otherwise
+ */
+int parse_rounding_mode(const char *name, RoundingMode *mode);
+
+/* ========================================
+ * POWERS
+ * ======================================== */
+
+/**
+ * @brief Barrett context for reduction modulo m
+ * @param ctx Output context (release with barrett_free)
+ * @param m Modulus, no leading zero limbs
+ * @param k Limbs of m (>= 1)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int barrett_init(BarrettContext *ctx, const limb_t *m, size_t k);
+
+/**
+ * @brief r = x mod m (two multiplications per k limbs of x above the lowest k)
+ * @param r Output with room for k limbs (zero padded; must not alias x)
+ * @param x Value of any length, e.g. a product of two residues (nx = 2k)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+int barrett_reduce(const BarrettContext *ctx, limb_t *r, const limb_t *x, size_t nx);
+
+/**
+ * @brief Release a context from barrett_init
+ */
+void barrett_free(BarrettContext *ctx);
+
+/**
+ * @brief Context for modulus m from the calling thread's cache of recent moduli, created on
+ *        a miss. It stays valid until this thread has looked up a few other moduli or
+ *        calls barrett_cache_clear.
+ * @param m Modulus, no leading zero limbs
+ * @param k Limbs of m (>= 1)
+ * @return The context, or NULL on memory error
+ */
+const BarrettContext *barrett_cached(const limb_t *m, size_t k);
+
+/**
+ * @brief Release the calling thread's cached Barrett contexts (done automatically when a thread exits)
+ */
+void barrett_cache_clear(void);
+
+/**
+ * @brief result = base ^ exponent by sliding-window powering.
+ *        A decimal base gives base.decimal_places * exponent decimal places; a negative
+ *        exponent divides 1 by the power with 'precision' fractional digits.
+ * @param base Any number
+ * @param exponent Integer; unless |base| is 0 or 1 the power may have at most ~75M digits
+ * @param result Output (may alias base or exponent)
+ * @param precision Fractional digits of a negative power (>= 0)
+ * @param mode Rounding of a negative power
+ * @return SUCCESS on success, FAILURE on a non-integer exponent, a too large power (checked
+ *         before any work), 0 ^ negative, or memory error (see last_error)
+ */
+int bn_power(const BigNumber *base, const BigNumber *exponent, BigNumber *result,
+             int precision, RoundingMode mode);
+
+/**
+ * @brief result = base ^ exponent mod modulus, with Barrett reduction (0 <= result < modulus)
+ * @param base Integer (a negative base is reduced to its non-negative residue)
+ * @param exponent Non-negative integer of any size
+ * @param modulus Positive integer
+ * @param result Output (may alias any input)
+ * @return SUCCESS on success, FAILURE on a non-integer or negative argument, zero modulus or
+ *         memory error (see last_error)
+ */
+int bn_power_mod(const BigNumber *base, const BigNumber *exponent, const BigNumber *modulus,
+                 BigNumber *result);
+
+/* ========================================
+ * ROOTS
+ * ======================================== */
+
+/**
+ * @brief result = sqrt(a) rounded to 'precision' fractional digits (exactly rounded)
+ * @param a Non-negative number
+ * @param result Output (may alias a)
+ * @param precision Fractional digits of the result (>= 0)
+ * @param mode Rounding of the last digit
+ * @return SUCCESS on success, FAILURE on a negative a or memory error (see last_error)
+ */
+int bn_sqrt(const BigNumber *a, BigNumber *result, int precision, RoundingMode mode);
+
+/**
+ * @brief result = floor(sqrt(a)), an integer
+ * @param a Non-negative number
+ * @param result Output (may alias a)
+ * @return SUCCESS on success, FAILURE on a negative a or memory error (see last_error)
+ */
+int bn_isqrt(const BigNumber *a, BigNumber *result);
+
+/**
+ * @brief result = a^(1/degree) rounded to 'precision' fractional digits (exactly rounded).
+ *        A negative a has the real root of an odd degree.
+ * @param a Any number (non-negative for an even degree)
+ * @param degree Integer from 2 to 1000000
+ * @param result Output (may alias a or degree)
+ * @param precision Fractional digits of the result (>= 0)
+ * @param mode Rounding of the last digit
+ * @return SUCCESS on success, FAILURE on an invalid degree, even root of a negative number
+ *         or memory error (see last_error)
+ */
+int bn_root(const BigNumber *a, const BigNumber *degree, BigNumber *result, int precision, RoundingMode mode);
+
+/* ========================================
+ * GREATEST COMMON DIVISOR
+ * ======================================== */
+
+/**
+ * @brief result = gcd(a, b) >= 0 (binary GCD, Lehmer steps or half-GCD by size)
+ * @param a Integer (decimal places allowed if the fraction is zero)
+ * @param b Integer
+ * @param result Output, 0 only for gcd(0, 0) (may alias a or b)
+ * @return SUCCESS on success, FAILURE on a non-integer operand or memory error (see last_error)
+ */
+int bn_gcd(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief Extended GCD: g = gcd(a, b) = a * s + b * t, with |s| <= |b| / 2g when b != 0
+ * @param a Integer
+ * @param b Integer
+ * @param g Output GCD (may alias a or b)
+ * @param s Output cofactor of a, or NULL
+ * @param t Output cofactor of b, or NULL (g, s and t must be different numbers)
+ * @return SUCCESS on success, FAILURE on a non-integer operand or memory error (see last_error)
+ */
+int bn_gcdext(const BigNumber *a, const BigNumber *b, BigNumber *g, BigNumber *s, BigNumber *t);
+
+/**
+ * @brief result = lcm(a, b) = |a * b| / gcd(a, b), 0 if either is 0
+ * @param result Output (may alias a or b)
+ * @return SUCCESS on success, FAILURE on a non-integer operand or memory error (see last_error)
+ */
+int bn_lcm(const BigNumber *a, const BigNumber *b, BigNumber *result);
+
+/**
+ * @brief result = a^-1 mod m in [0, m), from the extended GCD
+ * @param a Integer coprime to m
+ * @param m Positive integer
+ * @param result Output (may alias a or m)
+ * @return SUCCESS on success, FAILURE on a non-integer operand, a modulus <= 0, gcd(a, m) != 1
+ *         or memory error (see last_error)
+ */
+int bn_invmod(const BigNumber *a, const BigNumber *m, BigNumber *result);
+
+/* ========================================
+ * RADIX CONVERSION
+ * ======================================== */
+
+/**
+ * @brief Integer magnitude of a BigNumber as 32-bit words (divide and conquer, O(M(n) log n))
+ * @param num Number to convert (its fractional part must be zero)
+ * @param words Output: newly allocated words, least significant first (caller frees)
+ * @param count Output: number of words (0 for zero)
+ * @return SUCCESS on success, FAILURE on a fractional value or memory error (see last_error)
+ */
+int bn_to_binary(const BigNumber *num, uint32_t **words, size_t *count);
+
+/**
+ * @brief Set a BigNumber to an integer given as 32-bit words (divide and conquer, O(M(n) log n))
+ * @param num Output number (existing storage is reused)
+ * @param words Magnitude, least significant word first
+ * @param count Number of words
+ * @param negative TRUE for a negative value
+ * @return SUCCESS on success, FAILURE on memory error (see last_error)
+ */
+int bn_from_binary(BigNumber *num, const uint32_t *words, size_t count, int negative);
+
+/* ========================================
+ * BINARY SERIALIZATION
+ * ======================================== */
+
+/**
+ * @brief Write a BigNumber in the binary format (32-byte header, then the raw limbs)
+ * @param out Destination stream (opened in binary mode)
+ * @param num Number to write
+ * @return SUCCESS on success, FAILURE on a write error (see last_error)
+ */
+int bn_write_binary(FILE *out, const BigNumber *num);
+
+/**
+ * @brief Write a BigNumber to a binary number file
+ * @return SUCCESS on success, FAILURE on an I/O error (see last_error)
+ */
+int bn_save_binary(const char *path, const BigNumber *num);
+
+/**
+ * @brief Read a binary number file into a BigNumber that owns its limbs
+ * @param num Output number (existing storage is reused)
+ * @return SUCCESS on success, FAILURE on an I/O, format or checksum error (see last_error)
+ */
+int bn_load_binary(const char *path, BigNumber *num);
+
+/**
+ * @brief Memory-map a binary number file as a read-only BigNumber (no copy, no parse)
+ * @param path File to map
+ * @param view Output: number whose limbs point into the mapping; use only as an operand and
+ *             never pass it to bn_free or as a result
+ * @param mapping Output: mapping to release with bn_unmap_binary
+ * @return SUCCESS on success, FAILURE on an I/O, format or checksum error (see last_error)
+ */
+int bn_map_binary(const char *path, BigNumber *view, BinaryMapping *mapping);
+
+/**
+ * @brief Release a view created by bn_map_binary (view becomes zero)
+ */
+void bn_unmap_binary(BigNumber *view, BinaryMapping *mapping);
+
+/**
+ * @brief Open a binary number file and read its header (sign, scale and limb count)
+ * @return SUCCESS on success, FAILURE on an I/O or format error (see last_error)
+ */
+int binary_reader_open(BinaryReader *reader, const char *path);
+
+/**
+ * @brief Read up to 'max' of the next limbs, least significant first
+ * @return Limbs read (0 at the end or after an error)
+ */
+size_t binary_reader_read(BinaryReader *reader, limb_t *limbs, size_t max);
+
+/**
+ * @brief Close a reader; if every limb was read the checksum must match
+ * @return SUCCESS, or FAILURE on a read error, bad limb or checksum mismatch (see last_error)
+ */
+int binary_reader_close(BinaryReader *reader);
+
+/**
+ * @brief Create a binary number file whose limbs will be appended in order
+ * @param limb_count Exact number of limbs that will be written
+ * @return SUCCESS on success, FAILURE on an I/O error (see last_error)
+ */
+int binary_writer_open(BinaryWriter *writer, const char *path, int negative, int decimal_places,
+                       uint64_t limb_count);
+
+/**
+ * @brief Append limbs, least significant first
+ * @return SUCCESS on success, FAILURE on an I/O error or too many limbs (see last_error)
+ */
+int binary_writer_write(BinaryWriter *writer, const limb_t *limbs, size_t n);
+
+/**
+ * @brief Store the checksum and close the file
+ * @return SUCCESS on success, FAILURE on an I/O error or missing limbs (see last_error)
+ */
+int binary_writer_close(BinaryWriter *writer);
+
 /* ========================================
  * MAIN PROGRAM HELPER FUNCTIONS
  * ======================================== */
 
+/**
+ * @brief Check that a string is one of the supported operators (+, -, x, /, %, ^)
+ * @param str Operator token
+ * @return TRUE if valid, FALSE otherwise
+ */
+int validate_operator(const char *str);
+
+/**
+ * @brief Look up a named operator written before its single operand ("square 12")
+ * @param str Operator token
+ * @return Its operator character (OPERATOR_SQUARE, OPERATOR_SQRT, OPERATOR_ISQRT), or '\0'
+ *         if str names none
+ */
+char unary_operator(const char *str);
+
+/**
+ * @brief Look up an operator written between its two operands ("2 x 3", "27 root 3")
+ * @param str Operator token
+ * @return Its operator character (+, -, x, /, %, ^, OPERATOR_ROOT, OPERATOR_GCD, OPERATOR_LCM or
+ *         OPERATOR_INVMOD), or '\0' if str names none
+ */
+char binary_operator(const char *str);
+
 /**
  * @brief Parse and validate command line arguments
+ *        Leading options: --precision=N, --rounding=MODE, --batch [FILE], --threads=N
+ *        In batch mode no operands are expected and the outputs stay NULL.
+ *        Expressions are "<number> <operator> <number>", "<unary operator> <number>"
+ *        or "<number> ^ <number> mod <number>".
  * @param argc Argument count
  * @param argv Argument vector
  * @param operand1 Output: first operand string
- * @param operand2 Output: second operand string
+ * @param operand2 Output: second operand string (NULL for a unary operator)
+ * @param operand3 Output: modulus string of a modular power (NULL otherwise)
  * @param operator Output: operator character
+ * @param options Output: calculator options (defaults filled in)
  * @return SUCCESS if valid, FAILURE otherwise
  */
-int parse_arguments(int argc, char *argv[], char **operand1, char **operand2, char *operator);
+int parse_arguments(int argc, char *argv[], char **operand1, char **operand2, char **operand3,
+                    char *operator, CalcOptions *options);
 
 /**
  * @brief Perform the requested arithmetic operation
- * @param head1 Pointer to the head pointer of first number
- * @param tail1 Pointer to the tail pointer of first number
- * @param head2 Pointer to the head pointer of second number
- * @param tail2 Pointer to the tail pointer of second number
- * @param headR Pointer to the head pointer of result
- * @param tailR Pointer to the tail pointer of result
- * @param operator Arithmetic operator (+, -, x, /)
- * @param is_op1_negative Flag indicating if operand 1 is negative
- * @param is_op2_negative Flag indicating if operand 2 is negative
- * @param op1_bigger Flag indicating if operand 1 is bigger
- * @param op2_bigger Flag indicating if operand 2 is bigger
- * @param decimal1 Number of decimal places in operand 1
- * @param decimal2 Number of decimal places in operand 2
+ * @param num1 First operand
+ * @param num2 Second operand (unused by a unary operator, may be NULL)
+ * @param num3 Modulus of OPERATOR_POWER_MOD (unused otherwise, may be NULL)
+ * @param result Output: signed result of the operation
+ * @param operator Arithmetic operator (+, -, x, /, %, ^), OPERATOR_ROOT, OPERATOR_GCD,
+ *                 OPERATOR_LCM, OPERATOR_INVMOD, unary operator
+ *                 (OPERATOR_SQUARE, OPERATOR_SQRT, OPERATOR_ISQRT) or OPERATOR_POWER_MOD
+ * @param options Division and root precision and rounding mode
  * @return SUCCESS if operation completed, FAILURE otherwise
  */
-int perform_operation(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, 
-                      Dlist **headR, Dlist **tailR, char operator,
-                      int is_op1_negative, int is_op2_negative, 
-                      int op1_bigger, int op2_bigger, int is_both_equal,
-                      int decimal1, int decimal2);
+int perform_operation(const BigNumber *num1, const BigNumber *num2, const BigNumber *num3, BigNumber *result,
+                      char operator, const CalcOptions *options);
+
+/**
+ * @brief Load a command-line operand: parse text, or map a binary number file read-only
+ * @param token Operand text, or a file path with --input-format=bin
+ * @param options Calculator options (input_format)
+ * @param num Output number (must hold no storage when mapping)
+ * @param mapping Output: file mapping (base is NULL for a parsed operand)
+ * @return SUCCESS on success, FAILURE otherwise (see last_error)
+ */
+int load_operand(const char *token, const CalcOptions *options, BigNumber *num, BinaryMapping *mapping);
+
+/**
+ * @brief Release an operand filled by load_operand (unmaps or frees)
+ */
+void release_operand(BigNumber *num, BinaryMapping *mapping);
+
+/* ========================================
+ * ERROR REPORTING
+ * ======================================== */
+
+/**
+ * @brief Record why the current operation failed (per thread, nothing is printed)
+ * @param message Static message text
+ */
+void set_last_error(const char *message);
+
+/**
+ * @brief Clear the calling thread's failure reason
+ */
+void clear_last_error(void);
+
+/**
+ * @brief Reason for the calling thread's last failure
+ * @return Message text ("Operation failed" if no reason was recorded)
+ */
+const char *last_error(void);
+
+/* ========================================
+ * STATISTICS
+ * ======================================== */
+
+/* Instrumentation hooks: compiled in with -DAPC_STATS (make stats), empty otherwise */
+#ifdef APC_STATS
+extern _Thread_local OpStats stats_local;
+#define STAT_ADD(counter, n)            (stats_local.counter += (uint64_t)(n))
+#define STAT_MAX(counter, n)            (stats_local.counter = ((uint64_t)(n) > stats_local.counter) \
+                                                               ? (uint64_t)(n) : stats_local.counter)
+#define STAT_OP_BEGIN(timer)            uint64_t timer = stats_op_begin()
+#define STAT_OP_END(op, timer)          stats_op_end((op), (timer))
+#define STAT_PHASE_BEGIN(timer)         uint64_t timer = stats_clock_ns()
+#define STAT_PHASE_END(phase, timer)    stats_phase_end((phase), (timer))
+#define STAT_FLUSH()                    stats_flush()
+#else
+#define STAT_ADD(counter, n)            ((void)0)
+#define STAT_MAX(counter, n)            ((void)0)
+#define STAT_OP_BEGIN(timer)            ((void)0)
+#define STAT_OP_END(op, timer)          ((void)0)
+#define STAT_PHASE_BEGIN(timer)         ((void)0)
+#define STAT_PHASE_END(phase, timer)    ((void)0)
+#define STAT_FLUSH()                    ((void)0)
+#endif
+
+/**
+ * @brief Whether the library was built with -DAPC_STATS
+ * @return TRUE or FALSE
+ */
+int stats_enabled(void);
+
+/**
+ * @brief Monotonic clock used for the timings
+ * @return Nanoseconds since an arbitrary start point
+ */
+uint64_t stats_clock_ns(void);
+
+/**
+ * @brief Enter an operation (use STAT_OP_BEGIN)
+ * @return Start time for stats_op_end
+ */
+uint64_t stats_op_begin(void);
+
+/**
+ * @brief Leave an operation; only the thread's outermost operation is recorded
+ */
+void stats_op_end(StatOp op, uint64_t start);
+
+/**
+ * @brief Add the time since 'start' to a phase of the outermost operation
+ */
+void stats_phase_end(StatPhase phase, uint64_t start);
+
+/**
+ * @brief Copy the calling thread's counters
+ */
+void stats_get(OpStats *stats);
+
+/**
+ * @brief Zero the calling thread's counters
+ */
+void stats_reset(void);
+
+/**
+ * @brief Move the calling thread's counters into the process totals
+ */
+void stats_flush(void);
+
+/**
+ * @brief Process totals (flushed counters plus the calling thread's)
+ */
+void stats_total(OpStats *stats);
+
+/**
+ * @brief Print counters as a table
+ */
+void stats_print(FILE *out, const OpStats *stats);
+
+/* ========================================
+ * THREAD POOL
+ * ======================================== */
+
+/**
+ * @brief Number of online processors
+ * @return Processor count (at least 1)
+ */
+int online_cpu_count(void);
+
+/**
+ * @brief Start a work-stealing pool
+ * @param threads Number of worker threads (values below 1 mean 1)
+ * @return Pool handle, or NULL on failure
+ */
+ThreadPool *thread_pool_create(int threads);
+
+/**
+ * @brief Queue a task; it runs as fn(arg, worker_index) on some worker
+ * @return SUCCESS if queued, FAILURE on memory error
+ */
+int thread_pool_submit(ThreadPool *pool, task_fn fn, void *arg);
+
+/**
+ * @brief Block until every submitted task has finished
+ */
+void thread_pool_wait(ThreadPool *pool);
+
+/**
+ * @brief Number of worker threads in the pool
+ */
+int thread_pool_size(const ThreadPool *pool);
+
+/**
+ * @brief Run the remaining tasks, stop the workers and free the pool
+ */
+void thread_pool_destroy(ThreadPool *pool);
+
+/* ========================================
+ * PARALLEL LOOPS
+ * ======================================== */
+
+/**
+ * @brief Threads a parallel loop may use, the calling thread included
+ * @return set_parallel_threads value, or the number of online processors by default
+ */
+int parallel_threads(void);
+
+/**
+ * @brief Set the threads used by parallel loops (the shared pool is sized on first use)
+ * @param threads Thread count (0 = every online processor)
+ */
+void set_parallel_threads(int threads);
+
+/**
+ * @brief Run fn(arg, i) for every i < count on the shared pool and the calling thread;
+ *        returns when all have finished. Loops nested inside a piece run serially.
+ * @param count Number of independent pieces
+ * @param fn Loop body
+ * @param arg Passed to every call
+ */
+void parallel_for(size_t count, parallel_fn fn, void *arg);
+
+/* ========================================
+ * BATCH EVALUATION
+ * ======================================== */
+
+/**
+ * @brief Evaluate newline-delimited "number operator number" expressions
+ *        and write one result per line to stdout (input order preserved).
+ *        Malformed or failing lines produce an "[ERROR]: ..." line.
+ *        With more than one thread the lines are evaluated on a thread pool.
+ * @param options Division settings, thread count and batch_path ("-" reads stdin)
+ * @return SUCCESS if every line evaluated, FAILURE otherwise
+ */
+int run_batch(const CalcOptions *options);
+
+/* ========================================
+ * STREAMING ARITHMETIC
+ * ======================================== */
+
+/**
+ * @brief Add or subtract two numbers stored in files, in bounded memory, writing the result
+ *        to options->stream_path (decimal text, or a binary number file with
+ *        output_format = NUMBER_FORMAT_BINARY). Failures are printed as "[ERROR]: ...".
+ * @param options stream_path and output_format
+ * @param path1 First operand file (decimal text or binary number file)
+ * @param operator '+' or '-'
+ * @param path2 Second operand file
+ * @return SUCCESS if the result was written, FAILURE otherwise
+ */
+int run_stream(const CalcOptions *options, const char *path1, char operator, const char *path2);
+
+/* ========================================
+ * THRESHOLD TUNING
+ * ======================================== */
+
+/**
+ * @brief Time every kernel against the next smaller one on this machine, print the
+ *        measurements, and save the resulting crossover points to the thresholds file
+ * @param options tune_path selects the output file (NULL = thresholds_file_path)
+ * @return SUCCESS if the thresholds were written, FAILURE otherwise
+ */
+int run_tune(const CalcOptions *options);
 
 #endif /* APC_H */
\ No newline at end of file
@@ -0,0 +1,312 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : barrett.c
+ * Description   : Barrett reduction modulo a fixed base-10^9 modulus
+ * Functions     : barrett_init, barrett_reduce, barrett_free, barrett_cached, barrett_cache_clear
+ *
+ * Algorithm     : For a modulus m of k limbs (B = 10^9) the context keeps mu = floor(B^2k / m),
+ *                 computed once with limb_div. A value x < B^2k (any product of two residues)
+ *                 is then reduced with two multiplications and no division (HAC 14.42):
+ *
+ *                     q = floor(floor(x / B^(k-1)) * mu / B^(k+1))
+ *                     r = (x - q * m) mod B^(k+1)
+ *                     while r >= m: r = r - m        (at most twice)
+ *
+ *                 q underestimates floor(x / m) by at most 2, so r < 3m fits k + 1 limbs and the
+ *                 differences are taken modulo B^(k+1), where borrows are simply dropped.
+ *
+ *                 A longer x is folded from the top: its top 2k limbs are reduced first, then
+ *                 the remainder (k limbs) with the next k limbs of x below it, which is again
+ *                 below B^2k, until the lowest limb is consumed.
+ *
+ *                 Montgomery reduction would need R = B^k coprime to m, i.e. no factor 2 or 5;
+ *                 Barrett works for every modulus and keeps the operands in plain form.
+ *
+ * Cache         : barrett_cached() keeps the contexts of the last BARRETT_CACHE_SIZE moduli of
+ *                 the calling thread, so a stream of reductions by a few fixed moduli computes
+ *                 each mu once instead of dividing in full every time.
+ *
+ * Threads       : A context owns its scratch space, so one context serves one thread at a time.
+ *                 The cache is thread-local for the same reason; a thread that fills it also
+ *                 registers a pthread key whose destructor releases it when the thread exits.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+#include <pthread.h>
+
+/* Moduli whose contexts barrett_cached() keeps per thread */
+#define BARRETT_CACHE_SIZE 4
+
+/* Cached contexts and the clock value of their last use (0 = empty slot) */
+static _Thread_local BarrettContext cache[BARRETT_CACHE_SIZE];
+static _Thread_local unsigned long cache_used[BARRETT_CACHE_SIZE];
+static _Thread_local unsigned long cache_clock;
+
+/* Thread-exit hook: the key's value is non-NULL while this thread's cache holds contexts */
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+static int cache_key_ready = FALSE;
+static _Thread_local int cache_registered = FALSE;
+
+/**
+ * @brief Key destructor: release the exiting thread's cache
+ */
+static void cache_destructor(void *unused)
+{
+    (void)unused;
+    barrett_cache_clear();
+}
+
+/**
+ * @brief Create the thread-exit key (once per process)
+ */
+static void cache_key_create(void)
+{
+    cache_key_ready = (pthread_key_create(&cache_key, cache_destructor) == 0);
+}
+
+/**
+ * @brief Arrange for this thread's cache to be released when the thread exits
+ */
+static void cache_register(void)
+{
+    if (cache_registered)
+    {
+        return;
+    }
+
+    pthread_once(&cache_key_once, cache_key_create);
+    if (cache_key_ready && pthread_setspecific(cache_key, &cache_registered) == 0)
+    {
+        cache_registered = TRUE;
+    }
+}
+
+/**
+ * @brief Compare two arrays of the same length n (leading zero limbs allowed)
+ */
+static ComparisonResult compare_padded(const limb_t *a, const limb_t *b, size_t n)
+{
+    while (n > 0)
+    {
+        n--;
+        if (a[n] != b[n])
+        {
+            return (a[n] > b[n]) ? FIRST_LARGER : SECOND_LARGER;
+        }
+    }
+    return NUMBERS_EQUAL;
+}
+
+/**
+ * Prepare reduction modulo m: keep a copy of m and mu = floor(B^2k / m)
+ */
+int barrett_init(BarrettContext *ctx, const limb_t *m, size_t k)
+{
+    ctx->modulus = NULL;
+    ctx->mu = NULL;
+    ctx->scratch = NULL;
+    ctx->length = k;
+
+    /* mu has at most k + 2 limbs; the scratch holds q1 * mu, q * m, r and a folding window */
+    size_t numerator_len = 2 * k + 1;
+    ctx->modulus = malloc((k + 1) * sizeof(limb_t));
+    ctx->mu = malloc((k + 2) * sizeof(limb_t));
+    ctx->scratch = malloc((numerator_len + 6 * k + 8) * sizeof(limb_t));
+    if (ctx->modulus == NULL || ctx->mu == NULL || ctx->scratch == NULL)
+    {
+        barrett_free(ctx);
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    /* Modulus padded with one zero limb, so r and m compare over k + 1 limbs */
+    memcpy(ctx->modulus, m, k * sizeof(limb_t));
+    ctx->modulus[k] = 0;
+
+    /* B^2k in the scratch: 2k zero limbs and a one */
+    limb_t *numerator = ctx->scratch;
+    memset(numerator, 0, 2 * k * sizeof(limb_t));
+    numerator[2 * k] = 1;
+
+    if (limb_div(ctx->mu, NULL, numerator, numerator_len, m, k) == FAILURE)
+    {
+        barrett_free(ctx);
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    ctx->mu_length = k + 2;
+    while (ctx->mu_length > 0 && ctx->mu[ctx->mu_length - 1] == 0)
+    {
+        ctx->mu_length--;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief r = x mod m for x < B^2k (r must not alias x)
+ */
+static int reduce_short(const BarrettContext *ctx, limb_t *r, const limb_t *x, size_t nx)
+{
+    size_t k = ctx->length;
+
+    /* x < B^(k-1) <= m is already reduced */
+    if (nx < k)
+    {
+        memcpy(r, x, nx * sizeof(limb_t));
+        memset(r + nx, 0, (k - nx) * sizeof(limb_t));
+        return SUCCESS;
+    }
+
+    limb_t *q2 = ctx->scratch;                         /* q1 * mu: 2k + 3 limbs  */
+    limb_t *qm = q2 + 2 * k + 3;                       /* q * m:   2k + 3 limbs  */
+    limb_t *rem = qm + 2 * k + 3;                      /* r:       k + 1 limbs   */
+
+    /* q = floor(q1 * mu / B^(k+1)) with q1 = floor(x / B^(k-1)) */
+    size_t q1_len = nx - (k - 1);
+    if (limb_mul(q2, x + k - 1, q1_len, ctx->mu, ctx->mu_length) == FAILURE)
+    {
+        return FAILURE;
+    }
+    size_t q2_len = q1_len + ctx->mu_length;
+    const limb_t *q = q2 + k + 1;
+    size_t q_len = (q2_len > k + 1) ? q2_len - (k + 1) : 0;
+    while (q_len > 0 && q[q_len - 1] == 0)
+    {
+        q_len--;
+    }
+
+    /* r = (x - q * m) mod B^(k+1) */
+    size_t low = (nx < k + 1) ? nx : k + 1;
+    memcpy(rem, x, low * sizeof(limb_t));
+    memset(rem + low, 0, (k + 1 - low) * sizeof(limb_t));
+
+    if (q_len > 0)
+    {
+        if (limb_mul(qm, q, q_len, ctx->modulus, k) == FAILURE)
+        {
+            return FAILURE;
+        }
+        size_t qm_len = q_len + k;
+        if (qm_len < k + 1)
+        {
+            memset(qm + qm_len, 0, (k + 1 - qm_len) * sizeof(limb_t));
+        }
+        limb_sub(rem, rem, k + 1, qm, k + 1);
+    }
+
+    while (compare_padded(rem, ctx->modulus, k + 1) != SECOND_LARGER)
+    {
+        limb_sub(rem, rem, k + 1, ctx->modulus, k + 1);
+    }
+
+    memcpy(r, rem, k * sizeof(limb_t));
+    return SUCCESS;
+}
+
+/**
+ * r = x mod m
+ */
+int barrett_reduce(const BarrettContext *ctx, limb_t *r, const limb_t *x, size_t nx)
+{
+    size_t k = ctx->length;
+
+    if (nx <= 2 * k)
+    {
+        return reduce_short(ctx, r, x, nx);
+    }
+
+    /* Top 2k limbs first, then the remainder over the next k limbs below it */
+    limb_t *window = ctx->scratch + 5 * k + 7;
+    size_t position = nx - 2 * k;
+    if (reduce_short(ctx, r, x + position, 2 * k) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    while (position > 0)
+    {
+        size_t chunk = (position < k) ? position : k;
+        position -= chunk;
+        memcpy(window, x + position, chunk * sizeof(limb_t));
+        memcpy(window + chunk, r, k * sizeof(limb_t));
+        if (reduce_short(ctx, r, window, chunk + k) == FAILURE)
+        {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Release the context's storage
+ */
+void barrett_free(BarrettContext *ctx)
+{
+    free(ctx->modulus);
+    free(ctx->mu);
+    free(ctx->scratch);
+    ctx->modulus = NULL;
+    ctx->mu = NULL;
+    ctx->scratch = NULL;
+    ctx->length = 0;
+    ctx->mu_length = 0;
+}
+
+/**
+ * Context for reduction modulo m from this thread's cache (created on a miss)
+ */
+const BarrettContext *barrett_cached(const limb_t *m, size_t k)
+{
+    size_t victim = 0;
+
+    for (size_t i = 0; i < BARRETT_CACHE_SIZE; i++)
+    {
+        if (cache_used[i] != 0 && cache[i].length == k
+            && memcmp(cache[i].modulus, m, k * sizeof(limb_t)) == 0)
+        {
+            cache_used[i] = ++cache_clock;
+            return &cache[i];
+        }
+        if (cache_used[i] < cache_used[victim])
+        {
+            victim = i;
+        }
+    }
+
+    /* Miss: replace the least recently used context */
+    if (cache_used[victim] != 0)
+    {
+        barrett_free(&cache[victim]);
+        cache_used[victim] = 0;
+    }
+    if (barrett_init(&cache[victim], m, k) == FAILURE)
+    {
+        return NULL;
+    }
+    cache_used[victim] = ++cache_clock;
+    cache_register();
+    return &cache[victim];
+}
+
+/**
+ * Release this thread's cached contexts
+ */
+void barrett_cache_clear(void)
+{
+    for (size_t i = 0; i < BARRETT_CACHE_SIZE; i++)
+    {
+        if (cache_used[i] != 0)
+        {
+            barrett_free(&cache[i]);
+            cache_used[i] = 0;
+        }
+    }
+
+    /* Nothing left to release at exit (the destructor has already cleared the key itself) */
+    if (cache_registered)
+    {
+        pthread_setspecific(cache_key, NULL);
+        cache_registered = FALSE;
+    }
+}
@@ -0,0 +1,721 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : batch.c
+ * Description   : Non-interactive evaluation of many expressions from a file or stdin
+ * Function      : run_batch
+ * Input Params  : options - Division settings, thread count; batch_path names the input ("-" = stdin)
+ * Return Value  : SUCCESS if every line evaluated, FAILURE on any bad line or I/O error
+ *
+ * Format        : One expression per line, "<number> <operator> <number>",
+ *                 "<unary operator> <number>" or "<number> ^ <number> mod <number>" separated
+ *                 by blanks (e.g. "123.45 + 67.89", "square 12", "4 ^ 13 mod 497"); with
+ *                 --input-format=bin the numbers are paths of binary number files, mapped
+ *                 read-only for the line. Each line produces exactly one output line: the bare
+ *                 result, an "[ERROR]: ..." message, or an empty line for an empty input line,
+ *                 so output line N always belongs to input line N.
+ *
+ * Reuse         : The line buffer, the operand and result BigNumbers and the output text
+ *                 buffer live for the whole run and only grow, so after warm-up a line costs no
+ *                 allocations at all and throughput is bounded by parsing and arithmetic, not
+ *                 process startup.
+ *
+ * Threads       : With more than one thread the input is read in blocks of up to
+ *                 BATCH_BLOCK_LINES lines. A block is cut into tasks of at most BATCH_TASK_LINES
+ *                 lines / BATCH_TASK_BYTES bytes and the tasks run on the work-stealing pool, each
+ *                 worker with its own BigNumbers. Every task renders its lines into a private
+ *                 output buffer; the main thread acts as the reorder buffer, writing the task
+ *                 outputs strictly in input order as each one completes. Two blocks alternate, so
+ *                 the next block is read while the current one is still being evaluated.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <pthread.h>
+
+/* Initial line buffer size (doubles for longer lines) */
+#define BATCH_LINE_SIZE 256
+
+/* Output is written once this many bytes are pending */
+#define BATCH_OUTPUT_BUFFER (1 << 16)
+
+/* Lines and bytes read per block in threaded mode */
+#define BATCH_BLOCK_LINES 65536
+#define BATCH_BLOCK_BYTES (16u << 20)
+
+/* Upper bounds of one pool task (lines and input bytes) */
+#define BATCH_TASK_LINES 256
+#define BATCH_TASK_BYTES (64u << 10)
+
+/* Growing text buffer */
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} OutputBuffer;
+
+/* Per-thread evaluation state, reused across lines */
+typedef struct {
+    BigNumber num1;
+    BigNumber num2;
+    BigNumber num3;
+    BigNumber result;
+    char *text;
+    size_t text_capacity;
+} BatchWorkspace;
+
+struct batch_block;
+
+/* Shared state of a threaded run */
+typedef struct {
+    const CalcOptions *options;
+    BatchWorkspace *workspaces;     /* One per pool worker, plus the caller's */
+    pthread_mutex_t lock;           /* Guards the 'done' flags of all tasks */
+    pthread_cond_t task_done;
+} BatchRun;
+
+/* A run of consecutive lines evaluated by one pool task */
+typedef struct {
+    BatchRun *run;
+    struct batch_block *block;
+    size_t first;           /* Index of the first line in the block */
+    size_t count;           /* Number of lines                      */
+    OutputBuffer out;       /* Rendered result lines                */
+    int failed;
+    int done;
+} BatchTask;
+
+/* Lines read from the input, stored back to back with '\0' separators */
+typedef struct batch_block {
+    char *data;
+    size_t used;
+    size_t capacity;
+    size_t *offsets;        /* Start of every line in 'data' */
+    size_t line_count;
+    size_t first_line_number;
+    BatchTask *tasks;
+    size_t task_count;
+    size_t task_capacity;
+} BatchBlock;
+
+/**
+ * @brief Read one line of any length into a growing buffer, without the newline
+ * @return SUCCESS if a line was read, FAILURE at end of input or on memory error
+ */
+static int read_line(FILE *input, char **line, size_t *capacity, size_t *line_length)
+{
+    size_t length = 0;
+
+    if (*line == NULL)
+    {
+        *line = malloc(BATCH_LINE_SIZE);
+        if (*line == NULL)
+        {
+            fprintf(stderr, "[ERROR]: Memory allocation failed in read_line\n");
+            return FAILURE;
+        }
+        *capacity = BATCH_LINE_SIZE;
+    }
+
+    while (fgets(*line + length, (int)(*capacity - length), input) != NULL)
+    {
+        length += strlen(*line + length);
+
+        if (length > 0 && (*line)[length - 1] == '\n')
+        {
+            break;
+        }
+
+        /* Buffer full without a newline: grow and keep reading the same line */
+        if (length + 1 == *capacity)
+        {
+            char *grown = realloc(*line, *capacity * 2);
+            if (grown == NULL)
+            {
+                fprintf(stderr, "[ERROR]: Memory allocation failed in read_line\n");
+                return FAILURE;
+            }
+            *line = grown;
+            *capacity *= 2;
+        }
+    }
+
+    if (length == 0)
+    {
+        return FAILURE;
+    }
+
+    /* Strip "\n" or "\r\n" */
+    while (length > 0 && ((*line)[length - 1] == '\n' || (*line)[length - 1] == '\r'))
+    {
+        (*line)[--length] = '\0';
+    }
+
+    *line_length = length;
+    return SUCCESS;
+}
+
+/**
+ * @brief Split a line in place into at most max_tokens blank-separated tokens
+ * @return Number of tokens found (max_tokens + 1 if there are more)
+ */
+static int split_tokens(char *line, char **tokens, int max_tokens)
+{
+    int count = 0;
+
+    while (*line != '\0')
+    {
+        while (*line == ' ' || *line == '\t')
+        {
+            line++;
+        }
+        if (*line == '\0')
+        {
+            break;
+        }
+
+        if (count == max_tokens)
+        {
+            return max_tokens + 1;
+        }
+        tokens[count++] = line;
+
+        while (*line != '\0' && *line != ' ' && *line != '\t')
+        {
+            line++;
+        }
+        if (*line != '\0')
+        {
+            *line++ = '\0';
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Append bytes to an output buffer, growing it as needed
+ */
+static int output_append(OutputBuffer *out, const char *text, size_t length)
+{
+    if (out->length + length > out->capacity)
+    {
+        size_t capacity = (out->capacity > 0) ? out->capacity : BATCH_LINE_SIZE;
+        while (capacity < out->length + length)
+        {
+            capacity *= 2;
+        }
+
+        char *grown = realloc(out->data, capacity);
+        if (grown == NULL)
+        {
+            fprintf(stderr, "[ERROR]: Memory allocation failed in output_append\n");
+            return FAILURE;
+        }
+        out->data = grown;
+        out->capacity = capacity;
+    }
+
+    memcpy(out->data + out->length, text, length);
+    out->length += length;
+    return SUCCESS;
+}
+
+/**
+ * @brief Append an "[ERROR]: <message> on line N" line
+ */
+static void output_error(OutputBuffer *out, const char *message, size_t line_number)
+{
+    char text[160];
+    int length = snprintf(text, sizeof(text), "[ERROR]: %s on line %zu\n", message, line_number);
+
+    if (length > 0)
+    {
+        output_append(out, text, ((size_t)length < sizeof(text)) ? (size_t)length : sizeof(text) - 1);
+    }
+}
+
+/**
+ * @brief Evaluate one expression line and append its output line
+ * @return SUCCESS if the line evaluated, FAILURE otherwise (an error line is written)
+ */
+static int evaluate_line(char *line, size_t line_number, const CalcOptions *options,
+                         BatchWorkspace *ws, OutputBuffer *out)
+{
+    char *tokens[5];
+    int count = split_tokens(line, tokens, 5);
+
+    if (count == 0)
+    {
+        return output_append(out, "\n", 1);
+    }
+
+    /* "<number> <operator> <number>", "<unary operator> <number>" (no second operand)
+       or "<number> ^ <number> mod <number>" (a third operand) */
+    char operator = '\0';
+    const char *token1 = NULL;
+    const char *token2 = NULL;
+    const char *token3 = NULL;
+    if (count == 5 && strcmp(tokens[1], "^") == 0 && strcmp(tokens[3], "mod") == 0)
+    {
+        operator = OPERATOR_POWER_MOD;
+        token1 = tokens[0];
+        token2 = tokens[2];
+        token3 = tokens[4];
+    }
+    else if (count == 3 && binary_operator(tokens[1]) != '\0')
+    {
+        operator = binary_operator(tokens[1]);
+        token1 = tokens[0];
+        token2 = tokens[2];
+    }
+    else if (count == 2 && unary_operator(tokens[0]) != '\0')
+    {
+        operator = unary_operator(tokens[0]);
+        token1 = tokens[1];
+    }
+    else
+    {
+        output_error(out, "Invalid expression", line_number);
+        return FAILURE;
+    }
+
+    /* Text operands are parsed into the workspace, binary ones mapped as read-only views */
+    const BigNumber *operand1 = &ws->num1;
+    const BigNumber *operand2 = &ws->num2;
+    const BigNumber *operand3 = &ws->num3;
+    BigNumber view1, view2, view3;
+    BinaryMapping map1 = { NULL, 0, NULL };
+    BinaryMapping map2 = { NULL, 0, NULL };
+    BinaryMapping map3 = { NULL, 0, NULL };
+    bn_init(&view1);
+    bn_init(&view2);
+    bn_init(&view3);
+
+    int status;
+    if (options->input_format == NUMBER_FORMAT_BINARY)
+    {
+        operand1 = &view1;
+        operand2 = &view2;
+        operand3 = &view3;
+        status = bn_map_binary(token1, &view1, &map1);
+        if (status == SUCCESS && token2 != NULL)
+        {
+            status = bn_map_binary(token2, &view2, &map2);
+        }
+        if (status == SUCCESS && token3 != NULL)
+        {
+            status = bn_map_binary(token3, &view3, &map3);
+        }
+        if (status == FAILURE)
+        {
+            output_error(out, last_error(), line_number);
+        }
+    }
+    else
+    {
+        status = bn_from_string(&ws->num1, token1);
+        if (status == SUCCESS && token2 != NULL)
+        {
+            status = bn_from_string(&ws->num2, token2);
+        }
+        if (status == SUCCESS && token3 != NULL)
+        {
+            status = bn_from_string(&ws->num3, token3);
+        }
+        if (status == FAILURE)
+        {
+            output_error(out, "Invalid operand", line_number);
+        }
+    }
+
+    size_t text_length = 0;
+    if (status == SUCCESS)
+    {
+        status = perform_operation(operand1, operand2, operand3, &ws->result, operator, options);
+        if (status == SUCCESS)
+        {
+            status = bn_format_with(&ws->result, &options->format, &ws->text, &ws->text_capacity, &text_length);
+        }
+        if (status == FAILURE)
+        {
+            output_error(out, last_error(), line_number);
+        }
+    }
+
+    bn_unmap_binary(&view1, &map1);
+    bn_unmap_binary(&view2, &map2);
+    bn_unmap_binary(&view3, &map3);
+    if (status == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    ws->text[text_length++] = '\n';
+    return output_append(out, ws->text, text_length);
+}
+
+/**
+ * @brief Prepare an empty workspace
+ */
+static void workspace_init(BatchWorkspace *ws)
+{
+    bn_init(&ws->num1);
+    bn_init(&ws->num2);
+    bn_init(&ws->num3);
+    bn_init(&ws->result);
+    ws->text = NULL;
+    ws->text_capacity = 0;
+}
+
+/**
+ * @brief Release a workspace's numbers and text buffer
+ */
+static void workspace_free(BatchWorkspace *ws)
+{
+    bn_free(&ws->num1);
+    bn_free(&ws->num2);
+    bn_free(&ws->num3);
+    bn_free(&ws->result);
+    free(ws->text);
+    ws->text = NULL;
+}
+
+/**
+ * @brief Single-threaded run: evaluate and write line by line
+ */
+static int run_batch_serial(FILE *input, const CalcOptions *options)
+{
+    char *line = NULL;
+    size_t line_capacity = 0;
+    size_t line_length = 0;
+    OutputBuffer out = { NULL, 0, 0 };
+
+    BatchWorkspace ws;
+    workspace_init(&ws);
+
+    int status = SUCCESS;
+    size_t line_number = 0;
+
+    while (read_line(input, &line, &line_capacity, &line_length) == SUCCESS)
+    {
+        if (evaluate_line(line, ++line_number, options, &ws, &out) == FAILURE)
+        {
+            status = FAILURE;
+        }
+
+        if (out.length >= BATCH_OUTPUT_BUFFER)
+        {
+            fwrite(out.data, 1, out.length, stdout);
+            out.length = 0;
+        }
+    }
+
+    fwrite(out.data, 1, out.length, stdout);
+
+    workspace_free(&ws);
+    free(line);
+    free(out.data);
+
+    return status;
+}
+
+/**
+ * @brief Pool task: evaluate a run of lines into the task's output buffer
+ */
+static void batch_task(void *arg, int worker)
+{
+    BatchTask *task = arg;
+    BatchBlock *block = task->block;
+    BatchWorkspace *ws = &task->run->workspaces[worker];
+    int failed = FALSE;
+
+    task->out.length = 0;
+    for (size_t i = task->first; i < task->first + task->count; i++)
+    {
+        if (evaluate_line(block->data + block->offsets[i], block->first_line_number + i,
+                          task->run->options, ws, &task->out) == FAILURE)
+        {
+            failed = TRUE;
+        }
+    }
+
+    /* Hand this worker's statistics to the process totals before reporting done */
+    STAT_FLUSH();
+
+    pthread_mutex_lock(&task->run->lock);
+    task->failed = failed;
+    task->done = TRUE;
+    pthread_cond_broadcast(&task->run->task_done);
+    pthread_mutex_unlock(&task->run->lock);
+}
+
+/**
+ * @brief Read up to BATCH_BLOCK_LINES lines into a block and cut it into tasks
+ * @return SUCCESS (line_count == 0 at end of input), FAILURE on memory error
+ */
+static int read_block(FILE *input, BatchBlock *block, BatchRun *run, char **line, size_t *line_capacity,
+                      size_t first_line_number)
+{
+    size_t line_length = 0;
+
+    block->used = 0;
+    block->line_count = 0;
+    block->task_count = 0;
+    block->first_line_number = first_line_number;
+
+    while (block->line_count < BATCH_BLOCK_LINES && block->used < BATCH_BLOCK_BYTES
+           && read_line(input, line, line_capacity, &line_length) == SUCCESS)
+    {
+        if (block->used + line_length + 1 > block->capacity)
+        {
+            size_t capacity = (block->capacity > 0) ? block->capacity : BATCH_OUTPUT_BUFFER;
+            while (capacity < block->used + line_length + 1)
+            {
+                capacity *= 2;
+            }
+            char *grown = realloc(block->data, capacity);
+            if (grown == NULL)
+            {
+                fprintf(stderr, "[ERROR]: Memory allocation failed in read_block\n");
+                return FAILURE;
+            }
+            block->data = grown;
+            block->capacity = capacity;
+        }
+
+        if (block->offsets == NULL)
+        {
+            block->offsets = malloc(BATCH_BLOCK_LINES * sizeof(size_t));
+            if (block->offsets == NULL)
+            {
+                fprintf(stderr, "[ERROR]: Memory allocation failed in read_block\n");
+                return FAILURE;
+            }
+        }
+
+        block->offsets[block->line_count++] = block->used;
+        memcpy(block->data + block->used, *line, line_length + 1);
+        block->used += line_length + 1;
+    }
+
+    /* Cut the block into tasks bounded by line count and input bytes */
+    size_t first = 0;
+    while (first < block->line_count)
+    {
+        size_t count = 0;
+        size_t bytes = 0;
+        while (first + count < block->line_count && count < BATCH_TASK_LINES && bytes < BATCH_TASK_BYTES)
+        {
+            size_t start = block->offsets[first + count];
+            size_t end = (first + count + 1 < block->line_count) ? block->offsets[first + count + 1] : block->used;
+            bytes += end - start;
+            count++;
+        }
+
+        if (block->task_count == block->task_capacity)
+        {
+            size_t capacity = (block->task_capacity > 0) ? block->task_capacity * 2 : 64;
+            BatchTask *grown = realloc(block->tasks, capacity * sizeof(BatchTask));
+            if (grown == NULL)
+            {
+                fprintf(stderr, "[ERROR]: Memory allocation failed in read_block\n");
+                return FAILURE;
+            }
+            memset(grown + block->task_capacity, 0, (capacity - block->task_capacity) * sizeof(BatchTask));
+            block->tasks = grown;
+            block->task_capacity = capacity;
+        }
+
+        BatchTask *task = &block->tasks[block->task_count++];
+        task->run = run;
+        task->block = block;
+        task->first = first;
+        task->count = count;
+        task->failed = FALSE;
+        task->done = FALSE;
+
+        first += count;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Queue every task of a block on the pool
+ * @param inline_worker Workspace index reserved for tasks run by the calling thread
+ * @return SUCCESS, or FAILURE if a task could not be queued (it is evaluated inline)
+ */
+static int submit_block(ThreadPool *pool, BatchBlock *block, int inline_worker)
+{
+    int status = SUCCESS;
+
+    for (size_t i = 0; i < block->task_count; i++)
+    {
+        if (thread_pool_submit(pool, batch_task, &block->tasks[i]) == FAILURE)
+        {
+            /* Keep the output complete: the submitting thread runs the task itself */
+            batch_task(&block->tasks[i], inline_worker);
+            status = FAILURE;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Reorder buffer: write task outputs in input order as they complete
+ * @return SUCCESS if every line of the block evaluated, FAILURE otherwise
+ */
+static int write_block(BatchRun *run, BatchBlock *block)
+{
+    int status = SUCCESS;
+
+    for (size_t i = 0; i < block->task_count; i++)
+    {
+        BatchTask *task = &block->tasks[i];
+
+        pthread_mutex_lock(&run->lock);
+        while (!task->done)
+        {
+            pthread_cond_wait(&run->task_done, &run->lock);
+        }
+        pthread_mutex_unlock(&run->lock);
+
+        fwrite(task->out.data, 1, task->out.length, stdout);
+        if (task->failed)
+        {
+            status = FAILURE;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Free a block's storage and task output buffers
+ */
+static void block_free(BatchBlock *block)
+{
+    for (size_t i = 0; i < block->task_capacity; i++)
+    {
+        free(block->tasks[i].out.data);
+    }
+    free(block->tasks);
+    free(block->offsets);
+    free(block->data);
+}
+
+/**
+ * @brief Threaded run: double-buffered blocks on a work-stealing pool
+ */
+static int run_batch_parallel(FILE *input, const CalcOptions *options, int threads)
+{
+    ThreadPool *pool = thread_pool_create(threads);
+    if (pool == NULL)
+    {
+        /* No workers available: evaluate on this thread instead */
+        return run_batch_serial(input, options);
+    }
+
+    /* One workspace per worker plus one for tasks run inline by this thread */
+    BatchRun run;
+    run.options = options;
+    run.workspaces = malloc((size_t)(threads + 1) * sizeof(BatchWorkspace));
+    if (run.workspaces == NULL)
+    {
+        fprintf(stderr, "[ERROR]: Memory allocation failed in run_batch\n");
+        thread_pool_destroy(pool);
+        return FAILURE;
+    }
+    for (int i = 0; i <= threads; i++)
+    {
+        workspace_init(&run.workspaces[i]);
+    }
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.task_done, NULL);
+
+    BatchBlock blocks[2];
+    memset(blocks, 0, sizeof(blocks));
+    char *line = NULL;
+    size_t line_capacity = 0;
+    int current = 0;
+
+    int status = read_block(input, &blocks[0], &run, &line, &line_capacity, 1);
+    int reading = (status == SUCCESS);
+    if (reading && submit_block(pool, &blocks[0], threads) == FAILURE)
+    {
+        status = FAILURE;
+    }
+
+    while (reading && blocks[current].line_count > 0)
+    {
+        BatchBlock *block = &blocks[current];
+        BatchBlock *next = &blocks[1 - current];
+
+        /* Read ahead while the workers evaluate the current block */
+        reading = (read_block(input, next, &run, &line, &line_capacity,
+                              block->first_line_number + block->line_count) == SUCCESS);
+
+        if (write_block(&run, block) == FAILURE || !reading)
+        {
+            status = FAILURE;
+        }
+
+        if (reading && submit_block(pool, next, threads) == FAILURE)
+        {
+            status = FAILURE;
+        }
+        current = 1 - current;
+    }
+
+    /* Let any in-flight tasks finish before their blocks are freed */
+    thread_pool_wait(pool);
+    thread_pool_destroy(pool);
+
+    for (int i = 0; i <= threads; i++)
+    {
+        workspace_free(&run.workspaces[i]);
+    }
+    free(run.workspaces);
+    block_free(&blocks[0]);
+    block_free(&blocks[1]);
+    free(line);
+    pthread_mutex_destroy(&run.lock);
+    pthread_cond_destroy(&run.task_done);
+
+    return status;
+}
+
+int run_batch(const CalcOptions *options)
+{
+    FILE *input = stdin;
+    if (strcmp(options->batch_path, "-") != 0)
+    {
+        input = fopen(options->batch_path, "r");
+        if (input == NULL)
+        {
+            fprintf(stderr, "[ERROR]: Cannot open batch file '%s'\n", options->batch_path);
+            return FAILURE;
+        }
+    }
+
+    int threads = (options->threads > 0) ? options->threads : online_cpu_count();
+
+    int status = (threads > 1) ? run_batch_parallel(input, options, threads)
+                               : run_batch_serial(input, options);
+
+    if (ferror(input))
+    {
+        fprintf(stderr, "[ERROR]: Failed reading batch input\n");
+        status = FAILURE;
+    }
+
+    fflush(stdout);
+
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+
+    return status;
+}
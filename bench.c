@@ -0,0 +1,565 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bench.c
+ * Description   : Benchmark driver for the BigNumber engine (built by "make bench")
+ * Function      : main
+ *
+ * Measures      : parse, print, add, sub, mul, sqr, div, mod, sqrt and gcd on operands from 10
+ *                 to 10^7 digits (1-3-10 steps) for four input shapes:
+ *
+ *                     random  - uniformly random digits
+ *                     nines   - all 9s (longest carry / borrow chains)
+ *                     pow10   - 10^(n-1) (one non-zero limb, many zero limbs)
+ *                     decimal - half the digits after the point, the second operand with a
+ *                               different number of decimals (forces rescaling)
+ *
+ *                 Division divides an n-digit number by an n/2-digit one at the default
+ *                 precision, so the quotient also has about n/2 digits.
+ *
+ * Reports       : time per operation and per digit, heap allocations per operation and the
+ *                 peak heap bytes of one operation (from malloc/calloc/realloc/free wrappers
+ *                 linked in with -Wl,--wrap), and the process peak RSS so far (getrusage).
+ *                 Output is a table, CSV (--format=csv) or JSON (--format=json).
+ *
+ * Options       : --format=table|csv|json   --min-digits=N   --max-digits=N
+ *                 --min-time=SECONDS        --ops=parse,print,add,sub,mul,sqr,div,mod,sqrt,gcd
+ *                 --inputs=random,nines,pow10,decimal
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include "apc.h"
+#include <malloc.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <time.h>
+
+/* Largest operand size (digits) and default minimum measuring time per case */
+#define BENCH_MAX_DIGITS 10000000
+#define BENCH_MIN_TIME 0.05
+
+/* GCDs are timed on integers up to this size (O(M(n) log n) makes larger ones take minutes) */
+#define BENCH_GCD_MAX_DIGITS 1000000
+
+/* ========================================
+ * ALLOCATION COUNTING (-Wl,--wrap=...)
+ * ======================================== */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static atomic_size_t alloc_count;
+static atomic_size_t live_bytes;
+static atomic_size_t peak_bytes;
+
+/**
+ * @brief Account for a block entering or leaving the heap
+ */
+static void track(void *ptr, int adding)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    size_t size = malloc_usable_size(ptr);
+    if (!adding)
+    {
+        atomic_fetch_sub(&live_bytes, size);
+        return;
+    }
+
+    size_t live = atomic_fetch_add(&live_bytes, size) + size;
+    size_t peak = atomic_load(&peak_bytes);
+    while (live > peak && !atomic_compare_exchange_weak(&peak_bytes, &peak, live))
+    {
+    }
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    atomic_fetch_add(&alloc_count, 1);
+    track(ptr, TRUE);
+    return ptr;
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    void *ptr = __real_calloc(count, size);
+    atomic_fetch_add(&alloc_count, 1);
+    track(ptr, TRUE);
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    track(ptr, FALSE);
+    void *grown = __real_realloc(ptr, size);
+    atomic_fetch_add(&alloc_count, 1);
+    track((grown != NULL) ? grown : ptr, TRUE);
+    return grown;
+}
+
+void __wrap_free(void *ptr)
+{
+    track(ptr, FALSE);
+    __real_free(ptr);
+}
+
+/* ========================================
+ * BENCHMARK CASES
+ * ======================================== */
+
+typedef enum { OP_PARSE, OP_PRINT, OP_ADD, OP_SUB, OP_MUL, OP_SQR, OP_DIV, OP_MOD, OP_SQRT, OP_GCD, OP_COUNT } BenchOp;
+typedef enum { INPUT_RANDOM, INPUT_NINES, INPUT_POW10, INPUT_DECIMAL, INPUT_COUNT } InputKind;
+typedef enum { FORMAT_TABLE, FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+static const char *const OP_NAMES[OP_COUNT] = { "parse", "print", "add", "sub", "mul", "sqr", "div", "mod", "sqrt", "gcd" };
+static const char *const INPUT_NAMES[INPUT_COUNT] = { "random", "nines", "pow10", "decimal" };
+
+/* Benchmark settings */
+typedef struct {
+    OutputFormat format;
+    size_t min_digits;
+    size_t max_digits;
+    double min_time;
+    int ops[OP_COUNT];
+    int inputs[INPUT_COUNT];
+} BenchConfig;
+
+/* Prepared operands and scratch for one case */
+typedef struct {
+    char *text_a;
+    BigNumber a;
+    BigNumber b;
+    BigNumber result;
+    char *out;
+    size_t out_capacity;
+} BenchData;
+
+/* One measurement */
+typedef struct {
+    double seconds;         /* Per operation        */
+    size_t reps;
+    double allocs;          /* Per operation        */
+    size_t peak_heap;       /* Bytes above baseline */
+    long peak_rss_kb;
+} BenchResult;
+
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ull;
+
+/**
+ * @brief xorshift64* pseudo random digits (deterministic across runs)
+ */
+static int random_digit(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (int)(((rng_state * 0x2545F4914F6CDD1Dull) >> 33) % 10);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Build an operand string of 'digits' digits with the given shape
+ * @param decimals Digits after the decimal point (INPUT_DECIMAL only)
+ */
+static char *make_operand(size_t digits, InputKind kind, size_t decimals)
+{
+    char *text = malloc(digits + 2);
+    if (text == NULL)
+    {
+        return NULL;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < digits; i++)
+    {
+        char digit;
+        switch (kind)
+        {
+            case INPUT_NINES:
+                digit = '9';
+                break;
+
+            case INPUT_POW10:
+                digit = (i == 0) ? '1' : '0';
+                break;
+
+            default:
+                digit = (char)('0' + ((i == 0) ? 1 + random_digit() % 9 : random_digit()));
+                break;
+        }
+
+        if (kind == INPUT_DECIMAL && decimals > 0 && i == digits - decimals)
+        {
+            text[pos++] = '.';
+        }
+        text[pos++] = digit;
+    }
+    text[pos] = '\0';
+
+    return text;
+}
+
+/**
+ * @brief Run one operation once
+ */
+static int run_op(BenchOp op, BenchData *data)
+{
+    switch (op)
+    {
+        case OP_PARSE:
+            return bn_from_string(&data->result, data->text_a);
+
+        case OP_PRINT:
+            return bn_format(&data->a, &data->out, &data->out_capacity, NULL);
+
+        case OP_ADD:
+            return bn_add(&data->a, &data->b, &data->result);
+
+        case OP_SUB:
+            return bn_subtract(&data->a, &data->b, &data->result);
+
+        case OP_MUL:
+            return bn_multiply(&data->a, &data->b, &data->result);
+
+        case OP_SQR:
+            return bn_square(&data->a, &data->result);
+
+        case OP_DIV:
+            return bn_divide(&data->a, &data->b, &data->result, DIVISION_PRECISION, ROUND_TRUNCATE);
+
+        case OP_MOD:
+            return bn_mod(&data->a, &data->b, &data->result);
+
+        case OP_SQRT:
+            return bn_sqrt(&data->a, &data->result, DIVISION_PRECISION, ROUND_TRUNCATE);
+
+        case OP_GCD:
+            return bn_gcd(&data->a, &data->b, &data->result);
+
+        default:
+            return FAILURE;
+    }
+}
+
+/**
+ * @brief Time an operation: one warm-up call, then enough repetitions to fill min_time
+ */
+static int measure(BenchOp op, BenchData *data, double min_time, BenchResult *result)
+{
+    /* Warm-up also sizes the reusable buffers, so steady-state allocations are measured */
+    double start = now_seconds();
+    if (run_op(op, data) == FAILURE)
+    {
+        return FAILURE;
+    }
+    double once = now_seconds() - start;
+
+    size_t reps = 1;
+    if (once < min_time)
+    {
+        reps = (once > 0) ? (size_t)(min_time / once) + 1 : 1000000;
+        if (reps > 1000000)
+        {
+            reps = 1000000;
+        }
+    }
+
+    size_t allocs_before = atomic_load(&alloc_count);
+    size_t baseline = atomic_load(&live_bytes);
+    atomic_store(&peak_bytes, baseline);
+
+    start = now_seconds();
+    for (size_t i = 0; i < reps; i++)
+    {
+        run_op(op, data);
+    }
+    double elapsed = now_seconds() - start;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    result->seconds = elapsed / (double)reps;
+    result->reps = reps;
+    result->allocs = (double)(atomic_load(&alloc_count) - allocs_before) / (double)reps;
+    result->peak_heap = atomic_load(&peak_bytes) - baseline;
+    result->peak_rss_kb = usage.ru_maxrss;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Print one result row in the selected format
+ */
+static void report(const BenchConfig *config, BenchOp op, InputKind kind, size_t digits,
+                   const BenchResult *r, int first)
+{
+    double ns_op = r->seconds * 1e9;
+    double ns_digit = ns_op / (double)digits;
+
+    switch (config->format)
+    {
+        case FORMAT_CSV:
+            printf("%s,%s,%zu,%zu,%.1f,%.3f,%.2f,%zu,%ld\n", OP_NAMES[op], INPUT_NAMES[kind], digits,
+                   r->reps, ns_op, ns_digit, r->allocs, r->peak_heap, r->peak_rss_kb);
+            break;
+
+        case FORMAT_JSON:
+            printf("%s  {\"op\": \"%s\", \"input\": \"%s\", \"digits\": %zu, \"reps\": %zu, "
+                   "\"ns_per_op\": %.1f, \"ns_per_digit\": %.3f, \"allocs_per_op\": %.2f, "
+                   "\"peak_heap_bytes\": %zu, \"peak_rss_kb\": %ld}",
+                   first ? "" : ",\n", OP_NAMES[op], INPUT_NAMES[kind], digits, r->reps, ns_op, ns_digit,
+                   r->allocs, r->peak_heap, r->peak_rss_kb);
+            break;
+
+        default:
+            printf("%-6s %-8s %10zu %8zu %14.1f %12.3f %10.2f %14zu %12ld\n", OP_NAMES[op], INPUT_NAMES[kind],
+                   digits, r->reps, ns_op, ns_digit, r->allocs, r->peak_heap, r->peak_rss_kb);
+            break;
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Parse a comma separated list of names into enable flags
+ */
+static int parse_list(const char *list, const char *const *names, int count, int *enabled)
+{
+    for (int i = 0; i < count; i++)
+    {
+        enabled[i] = FALSE;
+    }
+
+    while (*list != '\0')
+    {
+        size_t length = strcspn(list, ",");
+        int found = FALSE;
+        for (int i = 0; i < count; i++)
+        {
+            if (strlen(names[i]) == length && strncmp(list, names[i], length) == 0)
+            {
+                enabled[i] = TRUE;
+                found = TRUE;
+            }
+        }
+        if (!found)
+        {
+            fprintf(stderr, "[ERROR]: Unknown name '%.*s'\n", (int)length, list);
+            return FAILURE;
+        }
+        list += length;
+        if (*list == ',')
+        {
+            list++;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Parse command line options into the configuration
+ */
+static int parse_config(int argc, char *argv[], BenchConfig *config)
+{
+    config->format = FORMAT_TABLE;
+    config->min_digits = 10;
+    config->max_digits = BENCH_MAX_DIGITS;
+    config->min_time = BENCH_MIN_TIME;
+    for (int i = 0; i < OP_COUNT; i++)
+    {
+        config->ops[i] = TRUE;
+    }
+    for (int i = 0; i < INPUT_COUNT; i++)
+    {
+        config->inputs[i] = TRUE;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        int status = SUCCESS;
+
+        if (strcmp(arg, "--format=csv") == 0)
+        {
+            config->format = FORMAT_CSV;
+        }
+        else if (strcmp(arg, "--format=json") == 0)
+        {
+            config->format = FORMAT_JSON;
+        }
+        else if (strcmp(arg, "--format=table") == 0)
+        {
+            config->format = FORMAT_TABLE;
+        }
+        else if (strncmp(arg, "--min-digits=", 13) == 0)
+        {
+            config->min_digits = strtoul(arg + 13, NULL, 10);
+        }
+        else if (strncmp(arg, "--max-digits=", 13) == 0)
+        {
+            config->max_digits = strtoul(arg + 13, NULL, 10);
+        }
+        else if (strncmp(arg, "--min-time=", 11) == 0)
+        {
+            config->min_time = strtod(arg + 11, NULL);
+        }
+        else if (strncmp(arg, "--ops=", 6) == 0)
+        {
+            status = parse_list(arg + 6, OP_NAMES, OP_COUNT, config->ops);
+        }
+        else if (strncmp(arg, "--inputs=", 9) == 0)
+        {
+            status = parse_list(arg + 9, INPUT_NAMES, INPUT_COUNT, config->inputs);
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR]: Unknown option '%s'\n", arg);
+            status = FAILURE;
+        }
+
+        if (status == FAILURE)
+        {
+            fprintf(stderr, "Usage: %s [--format=table|csv|json] [--min-digits=N] [--max-digits=N]\n"
+                            "       [--min-time=SECONDS] [--ops=parse,print,add,sub,mul,sqr,div,mod,sqrt,gcd]\n"
+                            "       [--inputs=random,nines,pow10,decimal]\n", argv[0]);
+            return FAILURE;
+        }
+    }
+
+    if (config->min_digits < 2)
+    {
+        config->min_digits = 2;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Prepare operands for one (input shape, size) combination
+ */
+static int prepare(BenchData *data, InputKind kind, size_t digits, BenchOp op)
+{
+    size_t digits_b = (op == OP_DIV || op == OP_MOD) ? digits / 2 : digits;
+    size_t decimals_a = (kind == INPUT_DECIMAL) ? digits / 2 : 0;
+    size_t decimals_b = (kind == INPUT_DECIMAL) ? digits_b / 3 : 0;
+
+    free(data->text_a);
+    data->text_a = make_operand(digits, kind, decimals_a);
+    char *text_b = make_operand(digits_b, kind, decimals_b);
+
+    int status = (data->text_a != NULL && text_b != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+    {
+        status = bn_from_string(&data->a, data->text_a);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_from_string(&data->b, text_b);
+    }
+
+    free(text_b);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchConfig config;
+    if (parse_config(argc, argv, &config) == FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+
+    BenchData data = { NULL, { 0 }, { 0 }, { 0 }, NULL, 0 };
+    bn_init(&data.a);
+    bn_init(&data.b);
+    bn_init(&data.result);
+
+    switch (config.format)
+    {
+        case FORMAT_CSV:
+            printf("op,input,digits,reps,ns_per_op,ns_per_digit,allocs_per_op,peak_heap_bytes,peak_rss_kb\n");
+            break;
+
+        case FORMAT_JSON:
+            printf("[\n");
+            break;
+
+        default:
+            printf("%-6s %-8s %10s %8s %14s %12s %10s %14s %12s\n", "op", "input", "digits", "reps",
+                   "ns/op", "ns/digit", "allocs/op", "peak heap B", "peak RSS KB");
+            break;
+    }
+
+    int status = SUCCESS;
+    int first = TRUE;
+
+    /* Sizes 10, 30, 100, 300, ... up to max_digits */
+    for (size_t decade = 10; decade <= config.max_digits && status == SUCCESS; decade *= 10)
+    {
+        size_t steps[2] = { decade, decade * 3 };
+        for (int s = 0; s < 2 && status == SUCCESS; s++)
+        {
+            size_t digits = steps[s];
+            if (digits < config.min_digits || digits > config.max_digits)
+            {
+                continue;
+            }
+
+            for (int kind = 0; kind < INPUT_COUNT && status == SUCCESS; kind++)
+            {
+                for (int op = 0; op < OP_COUNT && status == SUCCESS; op++)
+                {
+                    if (!config.inputs[kind] || !config.ops[op])
+                    {
+                        continue;
+                    }
+                    if (op == OP_GCD && (kind == INPUT_DECIMAL || digits > BENCH_GCD_MAX_DIGITS))
+                    {
+                        continue;
+                    }
+
+                    BenchResult result = { 0 };
+                    status = prepare(&data, (InputKind)kind, digits, (BenchOp)op);
+                    if (status == SUCCESS)
+                    {
+                        status = measure((BenchOp)op, &data, config.min_time, &result);
+                    }
+                    if (status == FAILURE)
+                    {
+                        fprintf(stderr, "[ERROR]: %s/%s at %zu digits failed: %s\n",
+                                OP_NAMES[op], INPUT_NAMES[kind], digits, last_error());
+                        break;
+                    }
+
+                    report(&config, (BenchOp)op, (InputKind)kind, digits, &result, first);
+                    first = FALSE;
+                }
+            }
+        }
+    }
+
+    if (config.format == FORMAT_JSON)
+    {
+        printf("\n]\n");
+    }
+
+    bn_free(&data.a);
+    bn_free(&data.b);
+    bn_free(&data.result);
+    free(data.text_a);
+    free(data.out);
+
+    return (status == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
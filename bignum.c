@@ -0,0 +1,321 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bignum.c
+ * Description   : Lifecycle and utility functions for the contiguous BigNumber representation
+ * Functions     : bn_init, bn_free, bn_reserve, bn_normalize, bn_swap, bn_copy, bn_is_zero,
+ *                 bn_set_small, bn_scale_up, bn_to_integer, bn_align_decimals, bn_compare_abs,
+ *                 bn_compare
+ *
+ * Representation: The magnitude is a packed array of base-10^9 limbs, least significant first.
+ *                 A 1M-digit operand needs ~111k limbs (~444 KB) instead of 1M list nodes.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Powers of ten that fit in a single limb, used for sub-limb rescaling */
+static const limb_t POW10[LIMB_DIGITS] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u
+};
+
+/**
+ * Initialize a BigNumber to zero
+ */
+void bn_init(BigNumber *num)
+{
+    num->limbs = NULL;
+    num->length = 0;
+    num->capacity = 0;
+    num->is_negative = FALSE;
+    num->decimal_places = 0;
+}
+
+/**
+ * Free limb storage and reset to zero
+ */
+void bn_free(BigNumber *num)
+{
+    if (num == NULL)
+    {
+        return;
+    }
+
+    free(num->limbs);
+    bn_init(num);
+}
+
+/**
+ * Grow the limb array to hold at least 'capacity' limbs
+ */
+int bn_reserve(BigNumber *num, size_t capacity)
+{
+    if (capacity <= num->capacity)
+    {
+        return SUCCESS;
+    }
+
+    limb_t *grown = realloc(num->limbs, capacity * sizeof(limb_t));
+    if (grown == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    num->limbs = grown;
+    num->capacity = capacity;
+    return SUCCESS;
+}
+
+/**
+ * Strip leading zero limbs; zero is never negative
+ */
+void bn_normalize(BigNumber *num)
+{
+    while (num->length > 0 && num->limbs[num->length - 1] == 0)
+    {
+        num->length--;
+    }
+
+    if (num->length == 0)
+    {
+        num->is_negative = FALSE;
+    }
+}
+
+/**
+ * Exchange two BigNumbers
+ */
+void bn_swap(BigNumber *a, BigNumber *b)
+{
+    BigNumber temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/**
+ * Deep-copy src into dest
+ */
+int bn_copy(BigNumber *dest, const BigNumber *src)
+{
+    if (dest == src)
+    {
+        return SUCCESS;
+    }
+
+    if (bn_reserve(dest, src->length) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    if (src->length > 0)
+    {
+        memcpy(dest->limbs, src->limbs, src->length * sizeof(limb_t));
+    }
+    dest->length = src->length;
+    dest->is_negative = src->is_negative;
+    dest->decimal_places = src->decimal_places;
+
+    return SUCCESS;
+}
+
+/**
+ * Check whether a number is zero
+ */
+int bn_is_zero(const BigNumber *num)
+{
+    return (num->length == 0) ? TRUE : FALSE;
+}
+
+/**
+ * Set a number to a non-negative integer below 2^64 (at most three limbs)
+ */
+int bn_set_small(BigNumber *num, uint64_t value)
+{
+    if (bn_reserve(num, 3) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    num->length = 0;
+    while (value > 0)
+    {
+        num->limbs[num->length++] = (limb_t)(value % LIMB_BASE);
+        value /= LIMB_BASE;
+    }
+    num->is_negative = FALSE;
+    num->decimal_places = 0;
+    return SUCCESS;
+}
+
+/**
+ * Rescale: magnitude *= 10^digits, decimal_places += digits
+ */
+int bn_scale_up(BigNumber *num, int digits)
+{
+    if (digits <= 0)
+    {
+        return SUCCESS;
+    }
+
+    num->decimal_places += digits;
+
+    if (num->length == 0)
+    {
+        return SUCCESS;
+    }
+
+    size_t limb_shift = (size_t)digits / LIMB_DIGITS;
+    int digit_shift = digits % LIMB_DIGITS;
+
+    if (bn_reserve(num, num->length + limb_shift + 1) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    /* Multiply by the sub-limb power of ten first */
+    if (digit_shift > 0)
+    {
+        limb_t carry = limb_mul_small(num->limbs, num->limbs, num->length, POW10[digit_shift]);
+        if (carry != 0)
+        {
+            num->limbs[num->length++] = carry;
+        }
+    }
+
+    /* Whole limbs of zeros are a plain memory shift */
+    if (limb_shift > 0)
+    {
+        memmove(num->limbs + limb_shift, num->limbs, num->length * sizeof(limb_t));
+        memset(num->limbs, 0, limb_shift * sizeof(limb_t));
+        num->length += limb_shift;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Same value with no decimal places, if the fractional digits are all zero
+ */
+int bn_to_integer(const BigNumber *num, BigNumber *result)
+{
+    size_t whole = (size_t)num->decimal_places / LIMB_DIGITS;
+    int partial = num->decimal_places % LIMB_DIGITS;
+
+    for (size_t i = 0; i < whole && i < num->length; i++)
+    {
+        if (num->limbs[i] != 0)
+        {
+            set_last_error("Value is not an integer");
+            return FAILURE;
+        }
+    }
+
+    BigNumber integer;
+    bn_init(&integer);
+    size_t n = (num->length > whole) ? num->length - whole : 0;
+
+    if (bn_reserve(&integer, n + 1) == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    if (n > 0)
+    {
+        memcpy(integer.limbs, num->limbs + whole, n * sizeof(limb_t));
+    }
+    integer.length = n;
+
+    /* Sub-limb digits: the division by 10^partial must be exact */
+    if (partial > 0 && n > 0 && limb_div_small(integer.limbs, integer.limbs, n, POW10[partial]) != 0)
+    {
+        bn_free(&integer);
+        set_last_error("Value is not an integer");
+        return FAILURE;
+    }
+
+    integer.is_negative = num->is_negative;
+    integer.decimal_places = 0;
+    bn_normalize(&integer);
+    bn_swap(result, &integer);
+    bn_free(&integer);
+    return SUCCESS;
+}
+
+/**
+ * Give a and b a common number of decimal places without touching the inputs
+ */
+int bn_align_decimals(const BigNumber *a, const BigNumber *b, BigNumber *scratch,
+                      const BigNumber **a_out, const BigNumber **b_out)
+{
+    *a_out = a;
+    *b_out = b;
+
+    if (a->decimal_places == b->decimal_places)
+    {
+        return SUCCESS;
+    }
+
+    /* Rescale a copy of the operand with fewer decimal places */
+    const BigNumber *coarse = (a->decimal_places < b->decimal_places) ? a : b;
+    const BigNumber *fine = (coarse == a) ? b : a;
+
+    if (bn_copy(scratch, coarse) == FAILURE
+        || bn_scale_up(scratch, fine->decimal_places - coarse->decimal_places) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    if (coarse == a)
+    {
+        *a_out = scratch;
+    }
+    else
+    {
+        *b_out = scratch;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Compare |a| and |b| after aligning their decimal places
+ */
+ComparisonResult bn_compare_abs(const BigNumber *a, const BigNumber *b)
+{
+    BigNumber scratch;
+    const BigNumber *x, *y;
+    ComparisonResult result;
+
+    bn_init(&scratch);
+
+    if (bn_align_decimals(a, b, &scratch, &x, &y) == FAILURE)
+    {
+        /* Out of memory: no reliable answer, treat as equal (error already reported) */
+        bn_free(&scratch);
+        return NUMBERS_EQUAL;
+    }
+
+    result = limb_compare(x->limbs, x->length, y->limbs, y->length);
+    bn_free(&scratch);
+
+    return result;
+}
+
+/**
+ * Signed comparison of a and b
+ */
+ComparisonResult bn_compare(const BigNumber *a, const BigNumber *b)
+{
+    /* Different signs: the non-negative one is larger (zero is never negative) */
+    if (a->is_negative != b->is_negative)
+    {
+        return a->is_negative ? SECOND_LARGER : FIRST_LARGER;
+    }
+
+    ComparisonResult magnitude = bn_compare_abs(a, b);
+    if (!a->is_negative || magnitude == NUMBERS_EQUAL)
+    {
+        return magnitude;
+    }
+
+    /* Both negative: the larger magnitude is the smaller value */
+    return (magnitude == FIRST_LARGER) ? SECOND_LARGER : FIRST_LARGER;
+}
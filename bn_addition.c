@@ -0,0 +1,111 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_addition.c
+ * Description   : Addition of two BigNumbers with decimal support
+ * Functions     : bn_add_abs, bn_add
+ * Input Params  : a, b   - Operands (never modified)
+ *                 result - Output number (may alias a or b)
+ * Return Value  : SUCCESS on successful operation, FAILURE otherwise
+ *
+ * Algorithm     : 1. Align decimal places by rescaling the operand with fewer fractional digits
+ *                 2. Add limb arrays from least to most significant limb with carry
+ *                 3. Signed addition reduces to |a| + |b| or |a| - |b| depending on the signs
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/**
+ * |result| = |a| + |b|
+ */
+int bn_add_abs(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    BigNumber scratch, sum;
+    const BigNumber *x, *y;
+
+    bn_init(&scratch);
+    bn_init(&sum);
+
+    /* Step 1: Align decimal places */
+    STAT_PHASE_BEGIN(align_start);
+    if (bn_align_decimals(a, b, &scratch, &x, &y) == FAILURE)
+    {
+        bn_free(&scratch);
+        return FAILURE;
+    }
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
+    /* Longer operand first so the kernel can run the carry through its tail */
+    if (x->length < y->length)
+    {
+        const BigNumber *temp = x;
+        x = y;
+        y = temp;
+    }
+
+    if (bn_reserve(&sum, x->length + 1) == FAILURE)
+    {
+        bn_free(&scratch);
+        return FAILURE;
+    }
+
+    /* Step 2: Add with carry */
+    STAT_PHASE_BEGIN(kernel_start);
+    sum.limbs[x->length] = limb_add(sum.limbs, x->limbs, x->length, y->limbs, y->length);
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
+    STAT_PHASE_BEGIN(normalize_start);
+    sum.length = x->length + 1;
+    sum.decimal_places = x->decimal_places;
+    bn_normalize(&sum);
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
+    bn_swap(result, &sum);
+    bn_free(&sum);
+    bn_free(&scratch);
+
+    return SUCCESS;
+}
+
+/**
+ * Signed addition: result = a + b
+ */
+int bn_add(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    if (a == NULL || b == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    int a_negative = a->is_negative;
+    int b_negative = b->is_negative;
+    int negative;
+    int status;
+
+    STAT_OP_BEGIN(op_start);
+
+    /* Same signs: add magnitudes, result keeps the common sign */
+    if (a_negative == b_negative)
+    {
+        negative = a_negative;
+        status = bn_add_abs(a, b, result);
+    }
+    /* Different signs: subtract smaller magnitude from larger, sign of the larger */
+    else if (bn_compare_abs(a, b) == SECOND_LARGER)
+    {
+        negative = b_negative;
+        status = bn_sub_abs(b, a, result);
+    }
+    else
+    {
+        negative = a_negative;
+        status = bn_sub_abs(a, b, result);
+    }
+
+    if (status == SUCCESS)
+    {
+        result->is_negative = negative;
+        bn_normalize(result);
+    }
+
+    STAT_OP_END(STAT_OP_ADD, op_start);
+    return status;
+}
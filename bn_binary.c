@@ -0,0 +1,544 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_binary.c
+ * Description   : Binary on-disk format for BigNumbers, with memory-mapped read-only loading
+ * Functions     : bn_write_binary, bn_save_binary, bn_load_binary, bn_map_binary, bn_unmap_binary,
+ *                 binary_reader_open, binary_reader_read, binary_reader_close,
+ *                 binary_writer_open, binary_writer_write, binary_writer_close
+ *
+ * Format        : A 32-byte header followed by the raw limbs, least significant first:
+ *
+ *                   offset  size  field
+ *                        0     4  magic "APCN"
+ *                        4     4  byte order mark 0x01020304 in the writer's byte order
+ *                        8     2  format version (1)
+ *                       10     2  flags (bit 0: negative)
+ *                       12     4  decimal_places (signed, >= 0)
+ *                       16     8  limb count
+ *                       24     8  checksum
+ *                       32   4*n  limbs (uint32, each < 10^9)
+ *
+ *                 Every field is written in the writer's byte order; the byte order mark tells
+ *                 the reader whether to swap. The checksum is a Fletcher-64 over the flags,
+ *                 decimal_places, limb count and limbs, so a truncated, corrupted or mismatched
+ *                 file is rejected instead of silently producing a wrong value.
+ *
+ * Mapping       : bn_map_binary maps the file and points a BigNumber straight at the limbs in
+ *                 the mapping (the header keeps them 4-byte aligned), so a huge constant costs
+ *                 one checksum pass instead of a parse. The view is read-only: pass it only as
+ *                 an operand and release it with bn_unmap_binary, never with bn_free. Files
+ *                 written on a host of the other byte order are swapped into a private copy.
+ *
+ * Streaming     : BinaryReader / BinaryWriter move limbs in order through a small buffer, so
+ *                 files larger than memory can be processed (stream.c). The reader checks the
+ *                 checksum once the last limb is read; the writer fills it in when closed.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BINARY_MAGIC "APCN"
+#define BINARY_BYTE_ORDER 0x01020304u
+#define BINARY_VERSION 1
+#define BINARY_FLAG_NEGATIVE 0x1u
+
+/* Fletcher-64 modulus, and the longest run that cannot overflow the 64-bit sums */
+#define FLETCHER_MODULUS 0xFFFFFFFFull
+#define FLETCHER_BLOCK 32768
+
+/* On-disk header (32 bytes, no padding) */
+typedef struct {
+    char magic[4];
+    uint32_t byte_order;
+    uint16_t version;
+    uint16_t flags;
+    int32_t decimal_places;
+    uint64_t limb_count;
+    uint64_t checksum;
+} BinaryHeader;
+
+_Static_assert(sizeof(BinaryHeader) == 32, "BinaryHeader must be 32 bytes");
+
+/**
+ * @brief Add words to the checksum; also report whether any of them is not a valid limb
+ * @return TRUE if a word is >= LIMB_BASE
+ */
+static int fletcher_update(BinaryChecksum *f, const uint32_t *words, size_t n)
+{
+    uint32_t invalid = 0;
+
+    while (n > 0)
+    {
+        size_t block = (n < FLETCHER_BLOCK) ? n : FLETCHER_BLOCK;
+        uint64_t low = f->low;
+        uint64_t high = f->high;
+
+        for (size_t i = 0; i < block; i++)
+        {
+            low += words[i];
+            high += low;
+            invalid |= (words[i] >= LIMB_BASE);
+        }
+
+        f->low = low % FLETCHER_MODULUS;
+        f->high = high % FLETCHER_MODULUS;
+        words += block;
+        n -= block;
+    }
+
+    return invalid ? TRUE : FALSE;
+}
+
+/**
+ * @brief Start a checksum with the header fields it covers
+ */
+static void checksum_begin(BinaryChecksum *f, const BinaryHeader *header)
+{
+    uint32_t fields[4] = {
+        header->flags,
+        (uint32_t)header->decimal_places,
+        (uint32_t)header->limb_count,
+        (uint32_t)(header->limb_count >> 32)
+    };
+
+    f->low = 0;
+    f->high = 0;
+    fletcher_update(f, fields, 4);
+}
+
+/**
+ * @brief Final 64-bit checksum value
+ */
+static uint64_t checksum_value(const BinaryChecksum *f)
+{
+    return (f->high << 32) | f->low;
+}
+
+/**
+ * @brief Checksum of the header fields followed by the limbs
+ * @param invalid Output: TRUE if a limb is out of range (may be NULL)
+ */
+static uint64_t binary_checksum(const BinaryHeader *header, const limb_t *limbs, int *invalid)
+{
+    BinaryChecksum f;
+    checksum_begin(&f, header);
+
+    int bad = fletcher_update(&f, limbs, (size_t)header->limb_count);
+    if (invalid != NULL)
+    {
+        *invalid = bad;
+    }
+
+    return checksum_value(&f);
+}
+
+/**
+ * @brief Convert the header to host byte order if the file was written on the other one
+ * @return TRUE if swapped, FALSE if already native, -1 if the file is not an APC number
+ */
+static int header_to_host(BinaryHeader *header)
+{
+    if (memcmp(header->magic, BINARY_MAGIC, 4) != 0)
+    {
+        return -1;
+    }
+
+    if (header->byte_order == BINARY_BYTE_ORDER)
+    {
+        return FALSE;
+    }
+    if (header->byte_order != __builtin_bswap32(BINARY_BYTE_ORDER))
+    {
+        return -1;
+    }
+
+    header->byte_order = BINARY_BYTE_ORDER;
+    header->version = __builtin_bswap16(header->version);
+    header->flags = __builtin_bswap16(header->flags);
+    header->decimal_places = (int32_t)__builtin_bswap32((uint32_t)header->decimal_places);
+    header->limb_count = __builtin_bswap64(header->limb_count);
+    header->checksum = __builtin_bswap64(header->checksum);
+    return TRUE;
+}
+
+/**
+ * @brief Fill a header for the host byte order (checksum left zero)
+ */
+static void header_init(BinaryHeader *header, int negative, int decimal_places, uint64_t limb_count)
+{
+    memcpy(header->magic, BINARY_MAGIC, 4);
+    header->byte_order = BINARY_BYTE_ORDER;
+    header->version = BINARY_VERSION;
+    header->flags = negative ? BINARY_FLAG_NEGATIVE : 0;
+    header->decimal_places = decimal_places;
+    header->limb_count = limb_count;
+    header->checksum = 0;
+}
+
+/**
+ * @brief Read a raw header from the start of a file, convert it to host byte order and check
+ *        it against the file size
+ * @param swapped Output: TRUE if the file was written on a host of the other byte order
+ * @return NULL if the header is usable, otherwise the reason it is not
+ */
+static const char *header_check(BinaryHeader *header, uint64_t file_size, int *swapped)
+{
+    *swapped = header_to_host(header);
+
+    if (*swapped < 0 || header->version != BINARY_VERSION || header->decimal_places < 0)
+    {
+        return "Not a binary number file";
+    }
+    if (header->limb_count > (file_size - sizeof(BinaryHeader)) / sizeof(limb_t)
+        || sizeof(BinaryHeader) + header->limb_count * sizeof(limb_t) != file_size)
+    {
+        return "Binary number file is truncated";
+    }
+
+    return NULL;
+}
+
+/**
+ * Write a BigNumber in the binary format
+ */
+int bn_write_binary(FILE *out, const BigNumber *num)
+{
+    BinaryHeader header;
+    header_init(&header, num->is_negative, num->decimal_places, num->length);
+    header.checksum = binary_checksum(&header, num->limbs, NULL);
+
+    if (fwrite(&header, sizeof(header), 1, out) != 1
+        || (num->length > 0 && fwrite(num->limbs, sizeof(limb_t), num->length, out) != num->length))
+    {
+        set_last_error("Cannot write binary number");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Write a BigNumber to a binary file
+ */
+int bn_save_binary(const char *path, const BigNumber *num)
+{
+    FILE *out = fopen(path, "wb");
+    if (out == NULL)
+    {
+        set_last_error("Cannot open binary number file for writing");
+        return FAILURE;
+    }
+
+    int status = bn_write_binary(out, num);
+    if (fclose(out) != 0 && status == SUCCESS)
+    {
+        set_last_error("Cannot write binary number");
+        status = FAILURE;
+    }
+
+    return status;
+}
+
+/**
+ * Map a binary file and make 'view' a read-only BigNumber over its limbs
+ */
+int bn_map_binary(const char *path, BigNumber *view, BinaryMapping *mapping)
+{
+    bn_init(view);
+    mapping->base = NULL;
+    mapping->size = 0;
+    mapping->copy = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        set_last_error("Cannot open binary number file");
+        return FAILURE;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(BinaryHeader))
+    {
+        close(fd);
+        set_last_error("Not a binary number file");
+        return FAILURE;
+    }
+
+    size_t size = (size_t)info.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        set_last_error("Cannot map binary number file");
+        return FAILURE;
+    }
+    mapping->base = base;
+    mapping->size = size;
+
+    BinaryHeader header;
+    int swapped;
+    memcpy(&header, base, sizeof(header));
+    const char *error = header_check(&header, size, &swapped);
+
+    const limb_t *limbs = (const limb_t *)(const void *)((const char *)base + sizeof(header));
+    size_t count = (size_t)header.limb_count;
+
+    /* Limbs from a host of the other byte order are swapped into a private copy */
+    if (error == NULL && swapped)
+    {
+        mapping->copy = malloc((count + 1) * sizeof(limb_t));
+        if (mapping->copy == NULL)
+        {
+            error = "Memory allocation failed";
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                mapping->copy[i] = __builtin_bswap32(limbs[i]);
+            }
+            limbs = mapping->copy;
+        }
+    }
+
+    if (error == NULL)
+    {
+        int invalid = FALSE;
+        if (binary_checksum(&header, limbs, &invalid) != header.checksum || invalid)
+        {
+            error = "Binary number file checksum mismatch";
+        }
+    }
+
+    if (error != NULL)
+    {
+        bn_unmap_binary(view, mapping);
+        set_last_error(error);
+        return FAILURE;
+    }
+
+    /* capacity 0 marks storage this BigNumber does not own */
+    view->limbs = (limb_t *)limbs;
+    view->length = count;
+    view->capacity = 0;
+    view->is_negative = (header.flags & BINARY_FLAG_NEGATIVE) ? TRUE : FALSE;
+    view->decimal_places = header.decimal_places;
+    bn_normalize(view);
+    return SUCCESS;
+}
+
+/**
+ * Release a view created by bn_map_binary
+ */
+void bn_unmap_binary(BigNumber *view, BinaryMapping *mapping)
+{
+    if (mapping->base != NULL)
+    {
+        munmap(mapping->base, mapping->size);
+    }
+    free(mapping->copy);
+
+    mapping->base = NULL;
+    mapping->size = 0;
+    mapping->copy = NULL;
+    bn_init(view);
+}
+
+/**
+ * Read a binary file into a BigNumber that owns its limbs
+ */
+int bn_load_binary(const char *path, BigNumber *num)
+{
+    BigNumber view;
+    BinaryMapping mapping;
+
+    if (bn_map_binary(path, &view, &mapping) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    int status = bn_copy(num, &view);
+    if (status == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    bn_unmap_binary(&view, &mapping);
+    return status;
+}
+
+/**
+ * Open a binary number file for reading its limbs in order
+ */
+int binary_reader_open(BinaryReader *reader, const char *path)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+    {
+        set_last_error("Cannot open binary number file");
+        return FAILURE;
+    }
+
+    struct stat info;
+    BinaryHeader header;
+    const char *error = NULL;
+    if (fstat(fileno(reader->file), &info) != 0 || info.st_size < (off_t)sizeof(header)
+        || fread(&header, sizeof(header), 1, reader->file) != 1)
+    {
+        error = "Not a binary number file";
+    }
+    else
+    {
+        error = header_check(&header, (uint64_t)info.st_size, &reader->swapped);
+    }
+
+    if (error != NULL)
+    {
+        fclose(reader->file);
+        reader->file = NULL;
+        set_last_error(error);
+        return FAILURE;
+    }
+
+    reader->is_negative = (header.flags & BINARY_FLAG_NEGATIVE) ? TRUE : FALSE;
+    reader->decimal_places = header.decimal_places;
+    reader->limb_count = header.limb_count;
+    reader->remaining = header.limb_count;
+    reader->checksum = header.checksum;
+    checksum_begin(&reader->sums, &header);
+    return SUCCESS;
+}
+
+/**
+ * Read the next limbs (least significant first)
+ */
+size_t binary_reader_read(BinaryReader *reader, limb_t *limbs, size_t max)
+{
+    size_t n = (reader->remaining < max) ? (size_t)reader->remaining : max;
+    if (n == 0 || reader->failed)
+    {
+        return 0;
+    }
+
+    if (fread(limbs, sizeof(limb_t), n, reader->file) != n)
+    {
+        reader->failed = TRUE;
+        return 0;
+    }
+
+    if (reader->swapped)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            limbs[i] = __builtin_bswap32(limbs[i]);
+        }
+    }
+
+    if (fletcher_update(&reader->sums, limbs, n))
+    {
+        reader->failed = TRUE;
+    }
+    reader->remaining -= n;
+    return n;
+}
+
+/**
+ * Close a reader; a file read to the end must match its checksum
+ */
+int binary_reader_close(BinaryReader *reader)
+{
+    int status = SUCCESS;
+
+    if (reader->failed || (reader->remaining == 0 && checksum_value(&reader->sums) != reader->checksum))
+    {
+        set_last_error("Binary number file checksum mismatch");
+        status = FAILURE;
+    }
+
+    if (reader->file != NULL)
+    {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+    return status;
+}
+
+/**
+ * Create a binary number file whose limbs are appended in order
+ */
+int binary_writer_open(BinaryWriter *writer, const char *path, int negative, int decimal_places,
+                       uint64_t limb_count)
+{
+    memset(writer, 0, sizeof(*writer));
+
+    BinaryHeader header;
+    header_init(&header, negative, decimal_places, limb_count);
+    checksum_begin(&writer->sums, &header);
+    writer->limb_count = limb_count;
+
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL || fwrite(&header, sizeof(header), 1, writer->file) != 1)
+    {
+        if (writer->file != NULL)
+        {
+            fclose(writer->file);
+            writer->file = NULL;
+        }
+        set_last_error("Cannot open binary number file for writing");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Append limbs (least significant first)
+ */
+int binary_writer_write(BinaryWriter *writer, const limb_t *limbs, size_t n)
+{
+    if (n > writer->limb_count - writer->written
+        || fwrite(limbs, sizeof(limb_t), n, writer->file) != n)
+    {
+        set_last_error("Cannot write binary number");
+        return FAILURE;
+    }
+
+    fletcher_update(&writer->sums, limbs, n);
+    writer->written += n;
+    return SUCCESS;
+}
+
+/**
+ * Fill in the checksum and close; every announced limb must have been written
+ */
+int binary_writer_close(BinaryWriter *writer)
+{
+    uint64_t checksum = checksum_value(&writer->sums);
+    int status = (writer->written == writer->limb_count) ? SUCCESS : FAILURE;
+
+    if (status == SUCCESS)
+    {
+        if (fseek(writer->file, (long)offsetof(BinaryHeader, checksum), SEEK_SET) != 0
+            || fwrite(&checksum, sizeof(checksum), 1, writer->file) != 1)
+        {
+            status = FAILURE;
+        }
+    }
+    if (fclose(writer->file) != 0)
+    {
+        status = FAILURE;
+    }
+    writer->file = NULL;
+
+    if (status == FAILURE)
+    {
+        set_last_error("Cannot write binary number");
+    }
+    return status;
+}
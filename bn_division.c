@@ -0,0 +1,381 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_division.c
+ * Description   : Division of two BigNumbers with decimal support
+ * Functions     : bn_divide, bn_divmod, bn_mod, parse_rounding_mode
+ * Input Params  : a         - Dividend (never modified)
+ *                 b         - Divisor  (never modified)
+ *                 result    - Quotient (may alias a or b)
+ *                 precision - Number of fractional digits to produce
+ *                 mode      - Rounding applied to the last produced digit
+ * Return Value  : SUCCESS on successful operation
+ *                 FAILURE on division by zero, negative precision or memory allocation error
+ *                 (the reason is left in last_error(), nothing is printed)
+ *
+ * Algorithm     : The whole quotient is computed as one scaled integer division instead of
+ *                 bringing digits down one at a time:
+ *
+ *                     a = A * 10^-da,  b = B * 10^-db
+ *                     a / b * 10^P = A * 10^(db - da + P) / B
+ *
+ *                 With P = precision, floor(A * 10^(db - da + P) / B) is exactly the quotient
+ *                 truncated to P fractional digits (same result as long division), and the
+ *                 remainder of that same division decides the rounding:
+ *
+ *                     truncate  : never adjust (toward zero)
+ *                     half-up   : round away from zero when 2r >= B
+ *                     half-even : round away from zero when 2r > B, or 2r == B and q is odd
+ *                     floor     : round away from zero when r != 0 and the result is negative
+ *                     ceil      : round away from zero when r != 0 and the result is positive
+ *
+ *                 The integer division itself runs on base-10^9 limbs through limb_div(), which
+ *                 uses Knuth Algorithm D for small operands and a Newton-Raphson reciprocal
+ *                 (a few fast multiplications) for large ones, so a million fractional digits
+ *                 cost a handful of multiplications rather than a million digit steps.
+ *
+ *   Remainder   : bn_divmod aligns the decimal points and divides the magnitudes once; the
+ *                 same limb_div call yields the truncated integer quotient and the remainder
+ *                 a - q * b (sign of a, C semantics). bn_mod needs only the remainder, so for a
+ *                 divisor of at least BARRETT_MIN_LIMBS limbs it reduces with the thread's
+ *                 cached Barrett context instead: after the first call by a modulus, every
+ *                 further one costs two multiplications per divisor length of the dividend.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Divisor limbs from which bn_mod reduces with a cached Barrett context */
+#define BARRETT_MIN_LIMBS 8
+
+/**
+ * @brief Decide whether the truncated quotient magnitude must be incremented
+ * @param q Truncated quotient limbs
+ * @param q_len Quotient length
+ * @param r Remainder limbs
+ * @param r_len Remainder length
+ * @param d Divisor limbs
+ * @param d_len Divisor length
+ * @param negative Sign of the exact result
+ * @param mode Rounding mode
+ * @param round_away Output: TRUE if |q| must become |q| + 1
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+static int rounding_increment(const limb_t *q, size_t q_len, const limb_t *r, size_t r_len,
+                              const limb_t *d, size_t d_len, int negative, RoundingMode mode,
+                              int *round_away)
+{
+    *round_away = FALSE;
+
+    /* Exact quotient: nothing to round */
+    while (r_len > 0 && r[r_len - 1] == 0)
+    {
+        r_len--;
+    }
+    if (r_len == 0 || mode == ROUND_TRUNCATE)
+    {
+        return SUCCESS;
+    }
+
+    switch (mode)
+    {
+        case ROUND_FLOOR:
+            *round_away = negative;
+            return SUCCESS;
+
+        case ROUND_CEIL:
+            *round_away = !negative;
+            return SUCCESS;
+
+        default:
+            break;
+    }
+
+    /* Nearest modes: compare twice the remainder against the divisor */
+    limb_t *twice = malloc((r_len + 1) * sizeof(limb_t));
+    if (twice == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    twice[r_len] = limb_mul_small(twice, r, r_len, 2);
+    size_t twice_len = (twice[r_len] != 0) ? r_len + 1 : r_len;
+
+    ComparisonResult half = limb_compare(twice, twice_len, d, d_len);
+    free(twice);
+
+    if (half == FIRST_LARGER)
+    {
+        *round_away = TRUE;
+    }
+    else if (half == NUMBERS_EQUAL)
+    {
+        /* Exact tie: half-up goes away from zero, half-even only from an odd digit */
+        int q_odd = (q_len > 0) ? (int)(q[0] & 1u) : FALSE;
+        *round_away = (mode == ROUND_HALF_UP) ? TRUE : q_odd;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Parse a rounding mode name
+ */
+int parse_rounding_mode(const char *name, RoundingMode *mode)
+{
+    static const struct {
+        const char *name;
+        RoundingMode mode;
+    } modes[] = {
+        { "truncate",  ROUND_TRUNCATE  },
+        { "half-even", ROUND_HALF_EVEN },
+        { "half-up",   ROUND_HALF_UP   },
+        { "floor",     ROUND_FLOOR     },
+        { "ceil",      ROUND_CEIL      },
+    };
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        if (strcmp(name, modes[i].name) == 0)
+        {
+            *mode = modes[i].mode;
+            return SUCCESS;
+        }
+    }
+
+    return FAILURE;
+}
+
+int bn_divide(const BigNumber *a, const BigNumber *b, BigNumber *result,
+              int precision, RoundingMode mode)
+{
+    if (a == NULL || b == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    if (precision < 0)
+    {
+        set_last_error("Division precision must not be negative");
+        return FAILURE;
+    }
+
+    /* ── Division by zero check ────────────────────────────────────── */
+    if (bn_is_zero(b))
+    {
+        set_last_error("Division by zero is undefined");
+        return FAILURE;
+    }
+
+    BigNumber numerator, denominator, quotient, remainder;
+    bn_init(&numerator);
+    bn_init(&denominator);
+    bn_init(&quotient);
+    bn_init(&remainder);
+
+    int negative = (a->is_negative != b->is_negative);
+
+    /* ── Scale so the integer quotient carries P fractional digits ─── */
+    long long exponent = (long long)b->decimal_places - a->decimal_places + precision;
+    if (exponent > INT_MAX || exponent < -(long long)INT_MAX)
+    {
+        set_last_error("Division precision too large");
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+    STAT_PHASE_BEGIN(align_start);
+
+    int status = bn_copy(&numerator, a);
+    if (status == SUCCESS)
+    {
+        status = bn_copy(&denominator, b);
+    }
+    if (status == SUCCESS)
+    {
+        status = (exponent >= 0) ? bn_scale_up(&numerator, (int)exponent)
+                                 : bn_scale_up(&denominator, (int)-exponent);
+    }
+
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
+    /* ── Integer division of the scaled magnitudes ─────────────────── */
+    STAT_PHASE_BEGIN(kernel_start);
+    if (status == SUCCESS)
+    {
+        if (numerator.length >= denominator.length)
+        {
+            size_t q_len = numerator.length - denominator.length + 1;
+            status = bn_reserve(&quotient, q_len + 1);
+            if (status == SUCCESS)
+            {
+                status = bn_reserve(&remainder, denominator.length);
+            }
+            if (status == SUCCESS)
+            {
+                status = limb_div(quotient.limbs, remainder.limbs, numerator.limbs, numerator.length,
+                                  denominator.limbs, denominator.length);
+                quotient.length = q_len;
+                remainder.length = denominator.length;
+            }
+        }
+        else
+        {
+            /* |numerator| < |denominator|: quotient 0, remainder is the numerator */
+            bn_swap(&remainder, &numerator);
+            status = bn_reserve(&quotient, 2);
+            if (status == SUCCESS)
+            {
+                quotient.limbs[0] = 0;
+                quotient.length = 1;
+            }
+        }
+    }
+
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
+    /* ── Round the last digit using the remainder ──────────────────── */
+    STAT_PHASE_BEGIN(normalize_start);
+    int round_away = FALSE;
+    if (status == SUCCESS)
+    {
+        status = rounding_increment(quotient.limbs, quotient.length, remainder.limbs, remainder.length,
+                                    denominator.limbs, denominator.length, negative, mode, &round_away);
+    }
+    if (status == SUCCESS && round_away)
+    {
+        limb_t one = 1;
+        quotient.limbs[quotient.length] = limb_add(quotient.limbs, quotient.limbs, quotient.length, &one, 1);
+        quotient.length++;
+    }
+
+    if (status == SUCCESS)
+    {
+        quotient.decimal_places = precision;
+        quotient.is_negative = negative;
+        bn_normalize(&quotient);
+        bn_swap(result, &quotient);
+    }
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
+    bn_free(&numerator);
+    bn_free(&denominator);
+    bn_free(&quotient);
+    bn_free(&remainder);
+
+    STAT_OP_END(STAT_OP_DIV, op_start);
+    return status;
+}
+
+/**
+ * @brief Remainder (and quotient) of the aligned magnitudes
+ * @param quotient Output quotient magnitude, or NULL
+ * @param barrett TRUE to take a remainder-only reduction from the Barrett cache
+ */
+static int divide_magnitudes(const BigNumber *x, const BigNumber *y, BigNumber *quotient,
+                             BigNumber *remainder, int barrett)
+{
+    if (x->length < y->length)
+    {
+        /* |x| < |y|: quotient 0, remainder x */
+        if (quotient != NULL)
+        {
+            quotient->length = 0;
+        }
+        if (bn_reserve(remainder, x->length) == FAILURE)
+        {
+            return FAILURE;
+        }
+        if (x->length > 0)
+        {
+            memcpy(remainder->limbs, x->limbs, x->length * sizeof(limb_t));
+        }
+        remainder->length = x->length;
+        return SUCCESS;
+    }
+
+    if (bn_reserve(remainder, y->length) == FAILURE)
+    {
+        return FAILURE;
+    }
+    remainder->length = y->length;
+
+    if (barrett && quotient == NULL)
+    {
+        const BarrettContext *ctx = barrett_cached(y->limbs, y->length);
+        return (ctx != NULL) ? barrett_reduce(ctx, remainder->limbs, x->limbs, x->length) : FAILURE;
+    }
+
+    size_t q_len = x->length - y->length + 1;
+    if (quotient != NULL)
+    {
+        if (bn_reserve(quotient, q_len) == FAILURE)
+        {
+            return FAILURE;
+        }
+        quotient->length = q_len;
+    }
+    return limb_div((quotient != NULL) ? quotient->limbs : NULL, remainder->limbs,
+                    x->limbs, x->length, y->limbs, y->length);
+}
+
+int bn_divmod(const BigNumber *a, const BigNumber *b, BigNumber *quotient, BigNumber *remainder)
+{
+    if (a == NULL || b == NULL || (quotient == NULL && remainder == NULL) || quotient == remainder)
+    {
+        return FAILURE;
+    }
+
+    if (bn_is_zero(b))
+    {
+        set_last_error("Division by zero is undefined");
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    /* Common decimal places: the quotient of the scaled integers is trunc(a / b) */
+    BigNumber scratch, q, r;
+    const BigNumber *x, *y;
+    bn_init(&scratch);
+    bn_init(&q);
+    bn_init(&r);
+
+    int status = bn_align_decimals(a, b, &scratch, &x, &y);
+    if (status == SUCCESS)
+    {
+        int barrett = (quotient == NULL && y->length >= BARRETT_MIN_LIMBS);
+        status = divide_magnitudes(x, y, (quotient != NULL) ? &q : NULL, &r, barrett);
+        if (status == FAILURE)
+        {
+            set_last_error("Memory allocation failed");
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        r.decimal_places = x->decimal_places;
+        r.is_negative = a->is_negative;
+        bn_normalize(&r);
+        q.is_negative = (a->is_negative != b->is_negative);
+        bn_normalize(&q);
+
+        if (quotient != NULL)
+        {
+            bn_swap(quotient, &q);
+        }
+        if (remainder != NULL)
+        {
+            bn_swap(remainder, &r);
+        }
+    }
+
+    bn_free(&scratch);
+    bn_free(&q);
+    bn_free(&r);
+
+    STAT_OP_END(STAT_OP_MOD, op_start);
+    return status;
+}
+
+int bn_mod(const BigNumber *a, const BigNumber *b, BigNumber *remainder)
+{
+    return bn_divmod(a, b, NULL, remainder);
+}
@@ -0,0 +1,826 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_gcd.c
+ * Description   : Greatest common divisor, least common multiple, extended GCD and modular inverse
+ * Functions     : bn_gcd, bn_gcdext, bn_lcm, bn_invmod
+ *
+ * Algorithm     : Every reduction keeps a unimodular matrix M (integer entries, det +-1) with
+ *
+ *                     (a; b) = M (a0; b0)
+ *
+ *                 so gcd(a, b) = gcd(a0, b0) at every point and, once b is 0, the first column
+ *                 of M holds the Bezout cofactors. Three tiers share that state:
+ *
+ *   Binary      : Operands below 10^18 (two limbs, no cofactors wanted) finish with Stein's
+ *                 binary GCD on uint64_t: shifts and subtractions, no division.
+ *
+ *   Lehmer      : The leading two limbs of a and b (at the same position) run Euclid in int64_t
+ *                 with Knuth's quotient test (TAOCP 4.5.2, Algorithm L): a quotient is taken only
+ *                 while (x + A) / (y + C) and (x + B) / (y + D) agree, so it is the quotient of
+ *                 the full numbers too. The cofactors A..D (kept below one limb) are then
+ *                 applied to the full operands in one pass, replacing about nine decimal
+ *                 digits' worth of full-length divisions. A step without an agreed quotient is
+ *                 a full division a mod b.
+ *
+ *   Half-GCD    : From HGCD_THRESHOLD limbs the reduction to half size recurses on top halves:
+ *                 the matrix that reduces the leading limbs of (a, b) by a quarter of their
+ *                 length also reduces the full numbers by about that much, applied with fast
+ *                 multiplications; a second recursion on the leading limbs of the result
+ *                 reaches half size. This costs O(M(n) log n) against O(n^2) for Lehmer. A
+ *                 matrix computed from the leading limbs can overshoot the exact remainder
+ *                 sequence by a step near its end; the results are then made non-negative and
+ *                 ordered by row sign changes and swaps, which keep M unimodular, so the GCD
+ *                 stays exact and only the size reduction is approximate.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Operands of at least this many limbs are reduced by half-GCD rather than Lehmer steps */
+#define HGCD_THRESHOLD 128
+
+/* Reduction state: the pair (a, b) and the tracked columns of (a; b) = M (a0; b0) */
+typedef struct {
+    BigNumber a;
+    BigNumber b;
+    BigNumber m[2][2];
+    int columns;             /* Columns of M kept up to date: 0 (GCD only), 1 (cofactors) or 2 */
+    BigNumber t0;            /* Scratch */
+    BigNumber t1;
+    BigNumber t2;
+} GcdState;
+
+static int reduce_below(GcdState *st, size_t s);
+
+/**
+ * @brief Prepare a state with a zero pair and M = identity
+ */
+static int state_init(GcdState *st, int columns)
+{
+    bn_init(&st->a);
+    bn_init(&st->b);
+    bn_init(&st->t0);
+    bn_init(&st->t1);
+    bn_init(&st->t2);
+    for (int i = 0; i < 2; i++)
+    {
+        bn_init(&st->m[i][0]);
+        bn_init(&st->m[i][1]);
+    }
+    st->columns = columns;
+
+    for (int j = 0; j < columns; j++)
+    {
+        if (bn_reserve(&st->m[j][j], 1) == FAILURE)
+        {
+            return FAILURE;
+        }
+        st->m[j][j].limbs[0] = 1;
+        st->m[j][j].length = 1;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Release a state
+ */
+static void state_free(GcdState *st)
+{
+    bn_free(&st->a);
+    bn_free(&st->b);
+    bn_free(&st->t0);
+    bn_free(&st->t1);
+    bn_free(&st->t2);
+    for (int i = 0; i < 2; i++)
+    {
+        bn_free(&st->m[i][0]);
+        bn_free(&st->m[i][1]);
+    }
+}
+
+/**
+ * @brief out = x * c for a small signed factor (|c| < LIMB_BASE)
+ */
+static int scale_small(const BigNumber *x, int64_t c, BigNumber *out)
+{
+    if (bn_reserve(out, x->length + 1) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    limb_t factor = (limb_t)((c < 0) ? -c : c);
+    out->limbs[x->length] = limb_mul_small(out->limbs, x->limbs, x->length, factor);
+    out->length = x->length + 1;
+    out->is_negative = (x->is_negative != (c < 0));
+    out->decimal_places = 0;
+    bn_normalize(out);
+    return SUCCESS;
+}
+
+/**
+ * @brief (x0; x1) = (c00 c01; c10 c11) (x0; x1) for small cofactors (|c| < LIMB_BASE)
+ */
+static int transform_small(int64_t c00, int64_t c01, int64_t c10, int64_t c11,
+                           BigNumber *x0, BigNumber *x1, GcdState *st)
+{
+    int status = scale_small(x0, c00, &st->t0);
+    if (status == SUCCESS)
+    {
+        status = scale_small(x1, c01, &st->t2);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_add(&st->t0, &st->t2, &st->t0);
+    }
+    if (status == SUCCESS)
+    {
+        status = scale_small(x0, c10, &st->t1);
+    }
+    if (status == SUCCESS)
+    {
+        status = scale_small(x1, c11, &st->t2);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_add(&st->t1, &st->t2, &st->t1);
+    }
+    if (status == SUCCESS)
+    {
+        bn_swap(x0, &st->t0);
+        bn_swap(x1, &st->t1);
+    }
+    return status;
+}
+
+/**
+ * @brief (x0; x1) = N (x0; x1) for the full matrix N of another state
+ */
+static int transform(const GcdState *n, BigNumber *x0, BigNumber *x1, GcdState *st)
+{
+    int status = bn_multiply(&n->m[0][0], x0, &st->t0);
+    if (status == SUCCESS)
+    {
+        status = bn_multiply(&n->m[0][1], x1, &st->t2);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_add(&st->t0, &st->t2, &st->t0);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_multiply(&n->m[1][0], x0, &st->t1);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_multiply(&n->m[1][1], x1, &st->t2);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_add(&st->t1, &st->t2, &st->t1);
+    }
+    if (status == SUCCESS)
+    {
+        bn_swap(x0, &st->t0);
+        bn_swap(x1, &st->t1);
+    }
+    return status;
+}
+
+/**
+ * @brief Make a >= b >= 0 by negating and swapping rows (M stays unimodular)
+ */
+static void order_pair(GcdState *st)
+{
+    if (st->a.is_negative)
+    {
+        st->a.is_negative = FALSE;
+        for (int j = 0; j < st->columns; j++)
+        {
+            st->m[0][j].is_negative = !st->m[0][j].is_negative;
+            bn_normalize(&st->m[0][j]);
+        }
+    }
+    if (st->b.is_negative)
+    {
+        st->b.is_negative = FALSE;
+        for (int j = 0; j < st->columns; j++)
+        {
+            st->m[1][j].is_negative = !st->m[1][j].is_negative;
+            bn_normalize(&st->m[1][j]);
+        }
+    }
+    if (bn_compare(&st->a, &st->b) == SECOND_LARGER)
+    {
+        bn_swap(&st->a, &st->b);
+        for (int j = 0; j < st->columns; j++)
+        {
+            bn_swap(&st->m[0][j], &st->m[1][j]);
+        }
+    }
+}
+
+/**
+ * @brief One Euclid step: (a, b) = (b, a mod b), rows (r0, r1) = (r1, r0 - q * r1)
+ */
+static int division_step(GcdState *st)
+{
+    int status = bn_divmod(&st->a, &st->b, &st->t0, &st->t1);
+    if (status == SUCCESS)
+    {
+        bn_swap(&st->a, &st->b);
+        bn_swap(&st->b, &st->t1);
+    }
+
+    for (int j = 0; j < st->columns && status == SUCCESS; j++)
+    {
+        status = bn_multiply(&st->t0, &st->m[1][j], &st->t1);
+        if (status == SUCCESS)
+        {
+            status = bn_subtract(&st->m[0][j], &st->t1, &st->m[0][j]);
+        }
+        if (status == SUCCESS)
+        {
+            bn_swap(&st->m[0][j], &st->m[1][j]);
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief One Lehmer step on the leading two limbs, or a division step when none applies
+ */
+static int lehmer_step(GcdState *st)
+{
+    size_t n = st->a.length;
+    if (n < 2 || st->b.length + 1 < n)
+    {
+        return division_step(st);
+    }
+
+    /* Leading limbs of a and b at the same position */
+    int64_t x = (int64_t)st->a.limbs[n - 1] * LIMB_BASE + st->a.limbs[n - 2];
+    int64_t y = (st->b.length == n) ? (int64_t)st->b.limbs[n - 1] * LIMB_BASE : 0;
+    y += st->b.limbs[n - 2];
+
+    /* Knuth's Algorithm L, with cofactors kept below LIMB_BASE */
+    int64_t c00 = 1, c01 = 0, c10 = 0, c11 = 1;
+    for (;;)
+    {
+        if (y + c10 <= 0 || y + c11 <= 0 || x + c00 < 0 || x + c01 < 0)
+        {
+            break;
+        }
+        int64_t q = (x + c00) / (y + c10);
+        if (q != (x + c01) / (y + c11))
+        {
+            break;
+        }
+        int64_t limit = 2 * (int64_t)LIMB_BASE;
+        if ((c10 != 0 && q > limit / (c10 < 0 ? -c10 : c10)) || (c11 != 0 && q > limit / (c11 < 0 ? -c11 : c11)))
+        {
+            break;
+        }
+        int64_t n10 = c00 - q * c10;
+        int64_t n11 = c01 - q * c11;
+        if (n10 <= -(int64_t)LIMB_BASE || n10 >= (int64_t)LIMB_BASE
+            || n11 <= -(int64_t)LIMB_BASE || n11 >= (int64_t)LIMB_BASE)
+        {
+            break;
+        }
+        c00 = c10;
+        c01 = c11;
+        c10 = n10;
+        c11 = n11;
+        int64_t r = x - q * y;
+        x = y;
+        y = r;
+    }
+
+    if (c01 == 0)
+    {
+        return division_step(st);
+    }
+
+    int status = transform_small(c00, c01, c10, c11, &st->a, &st->b, st);
+    for (int j = 0; j < st->columns && status == SUCCESS; j++)
+    {
+        status = transform_small(c00, c01, c10, c11, &st->m[0][j], &st->m[1][j], st);
+    }
+    if (status == SUCCESS)
+    {
+        order_pair(st);
+    }
+    return status;
+}
+
+/**
+ * @brief out = floor(x / B^p)
+ */
+static int leading_limbs(const BigNumber *x, size_t p, BigNumber *out)
+{
+    size_t length = (x->length > p) ? x->length - p : 0;
+    if (bn_reserve(out, length + 1) == FAILURE)
+    {
+        return FAILURE;
+    }
+    if (length > 0)
+    {
+        memcpy(out->limbs, x->limbs + p, length * sizeof(limb_t));
+    }
+    out->length = length;
+    out->is_negative = FALSE;
+    out->decimal_places = 0;
+    bn_normalize(out);
+    return SUCCESS;
+}
+
+/**
+ * @brief Reduce the leading limbs of st's pair (above limb p) to about s limbs and apply the
+ *        matrix that does it to st
+ */
+static int reduce_leading(GcdState *st, size_t p, size_t s)
+{
+    GcdState top;
+    int status = state_init(&top, 2);
+    if (status == SUCCESS)
+    {
+        status = leading_limbs(&st->a, p, &top.a);
+    }
+    if (status == SUCCESS)
+    {
+        status = leading_limbs(&st->b, p, &top.b);
+    }
+    if (status == SUCCESS)
+    {
+        status = reduce_below(&top, s);
+    }
+
+    /* (a; b) = N (a; b) and M = N M */
+    if (status == SUCCESS)
+    {
+        status = transform(&top, &st->a, &st->b, st);
+    }
+    for (int j = 0; j < st->columns && status == SUCCESS; j++)
+    {
+        status = transform(&top, &st->m[0][j], &st->m[1][j], st);
+    }
+    if (status == SUCCESS)
+    {
+        order_pair(st);
+    }
+
+    state_free(&top);
+    return status;
+}
+
+/**
+ * @brief Reduce st's pair (a >= b >= 0) until b has at most s limbs
+ */
+static int reduce_below(GcdState *st, size_t s)
+{
+    int status = SUCCESS;
+    size_t n = st->a.length;
+
+    /* Half-GCD: leading half to three quarters, then the leading limbs of that to s */
+    if (n >= HGCD_THRESHOLD && n > s && n - s >= HGCD_THRESHOLD / 2)
+    {
+        status = reduce_leading(st, s, (n - s) / 2 + 1);
+
+        if (status == SUCCESS && st->b.length > s && !bn_is_zero(&st->b))
+        {
+            status = division_step(st);
+        }
+
+        /* A first half that made no progress leaves the rest to Lehmer */
+        size_t k = st->a.length;
+        if (status == SUCCESS && st->b.length > s && k > s && 2 * s > k)
+        {
+            size_t p = 2 * s - k;
+            status = reduce_leading(st, p, s - p + 1);
+        }
+    }
+
+    /* Lehmer steps for the rest (and any overshoot left by the leading limbs) */
+    while (status == SUCCESS && st->b.length > s && !bn_is_zero(&st->b))
+    {
+        status = lehmer_step(st);
+    }
+    return status;
+}
+
+/**
+ * @brief gcd(a, b) of two 64-bit values by Stein's binary algorithm
+ */
+static uint64_t binary_gcd(uint64_t a, uint64_t b)
+{
+    if (a == 0 || b == 0)
+    {
+        return a | b;
+    }
+
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0)
+    {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+        {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+/**
+ * @brief Value of a non-negative number of at most two limbs
+ */
+static uint64_t small_value(const BigNumber *num)
+{
+    uint64_t value = 0;
+    for (size_t i = num->length; i-- > 0; )
+    {
+        value = value * LIMB_BASE + num->limbs[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Run the reduction to b = 0: st->a becomes the GCD of the starting pair
+ */
+static int reduce_to_gcd(GcdState *st)
+{
+    int status = SUCCESS;
+
+    while (status == SUCCESS && !bn_is_zero(&st->b))
+    {
+        if (st->columns == 0 && st->a.length <= 2)
+        {
+            uint64_t g = binary_gcd(small_value(&st->a), small_value(&st->b));
+            status = bn_reserve(&st->a, 2);
+            if (status == FAILURE)
+            {
+                break;
+            }
+            st->a.limbs[0] = (limb_t)(g % LIMB_BASE);
+            st->a.limbs[1] = (limb_t)(g / LIMB_BASE);
+            st->a.length = 2;
+            bn_normalize(&st->a);
+            st->b.length = 0;
+        }
+        else if (st->b.length >= HGCD_THRESHOLD && st->b.length + 1 >= st->a.length)
+        {
+            status = reduce_below(st, st->a.length / 2);
+            if (status == SUCCESS && !bn_is_zero(&st->b))
+            {
+                status = division_step(st);
+            }
+        }
+        else
+        {
+            status = lehmer_step(st);
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Integer magnitudes of two operands, a >= b
+ */
+static int integer_pair(const BigNumber *a, const BigNumber *b, BigNumber *x, BigNumber *y, const char *message)
+{
+    int status = bn_to_integer(a, x);
+    if (status == SUCCESS)
+    {
+        status = bn_to_integer(b, y);
+    }
+    if (status == FAILURE)
+    {
+        if (strcmp(last_error(), "Value is not an integer") == 0)
+        {
+            set_last_error(message);
+        }
+        return FAILURE;
+    }
+
+    x->is_negative = FALSE;
+    y->is_negative = FALSE;
+    return SUCCESS;
+}
+
+/**
+ * result = gcd(a, b)
+ */
+int bn_gcd(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    if (a == NULL || b == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    BigNumber x, y;
+    bn_init(&x);
+    bn_init(&y);
+
+    GcdState st;
+    int status = integer_pair(a, b, &x, &y, "GCD needs integer operands");
+    int ready = FALSE;
+    if (status == SUCCESS)
+    {
+        ready = TRUE;
+        status = state_init(&st, 0);
+    }
+    if (status == SUCCESS)
+    {
+        bn_swap(&st.a, &x);
+        bn_swap(&st.b, &y);
+        order_pair(&st);
+        status = reduce_to_gcd(&st);
+        if (status == SUCCESS)
+        {
+            bn_swap(result, &st.a);
+        }
+        else
+        {
+            set_last_error("Memory allocation failed");
+        }
+    }
+    else if (ready)
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    if (ready)
+    {
+        state_free(&st);
+    }
+    bn_free(&x);
+    bn_free(&y);
+
+    STAT_OP_END(STAT_OP_GCD, op_start);
+    return status;
+}
+
+/**
+ * g = gcd(a, b) = a * s + b * t
+ */
+int bn_gcdext(const BigNumber *a, const BigNumber *b, BigNumber *g, BigNumber *s, BigNumber *t)
+{
+    if (a == NULL || b == NULL || g == NULL || g == s || g == t || (s == t && s != NULL))
+    {
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    BigNumber x, y, u, v, w;
+    bn_init(&x);
+    bn_init(&y);
+    bn_init(&u);
+    bn_init(&v);
+    bn_init(&w);
+
+    GcdState st;
+    int status = integer_pair(a, b, &x, &y, "GCD needs integer operands");
+    int ready = FALSE;
+    int swapped = FALSE;
+    if (status == SUCCESS)
+    {
+        swapped = (bn_compare(&x, &y) == SECOND_LARGER);
+        if (swapped)
+        {
+            bn_swap(&x, &y);
+        }
+        x.is_negative = swapped ? b->is_negative : a->is_negative;
+        y.is_negative = swapped ? a->is_negative : b->is_negative;
+        bn_normalize(&x);
+        bn_normalize(&y);
+
+        ready = TRUE;
+        status = state_init(&st, 1);
+    }
+
+    /* x, y signed with |x| >= |y|: reduce |x|, |y| tracking the cofactor u of |x| */
+    if (status == SUCCESS)
+    {
+        status = bn_copy(&st.a, &x);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_copy(&st.b, &y);
+    }
+    if (status == SUCCESS)
+    {
+        st.a.is_negative = FALSE;
+        st.b.is_negative = FALSE;
+        status = reduce_to_gcd(&st);
+    }
+
+    if (status == SUCCESS)
+    {
+        if (bn_is_zero(&y))
+        {
+            /* gcd(x, 0) = |x| = x * sign(x) */
+            status = bn_reserve(&u, 1);
+            if (status == SUCCESS && !bn_is_zero(&x))
+            {
+                u.limbs[0] = 1;
+                u.length = 1;
+                u.is_negative = x.is_negative;
+            }
+        }
+        else
+        {
+            /* u = cofactor of x, reduced to |u| <= |y| / 2g */
+            bn_swap(&u, &st.m[0][0]);
+            u.is_negative = (u.is_negative != x.is_negative);
+            bn_normalize(&u);
+            status = bn_divmod(&y, &st.a, &w, NULL);
+            if (status == SUCCESS)
+            {
+                w.is_negative = FALSE;
+                status = bn_mod(&u, &w, &u);
+            }
+            if (status == SUCCESS && u.is_negative)
+            {
+                status = bn_add(&u, &w, &u);
+            }
+            if (status == SUCCESS)
+            {
+                status = bn_add(&u, &u, &v);
+            }
+            if (status == SUCCESS && bn_compare(&v, &w) == FIRST_LARGER)
+            {
+                status = bn_subtract(&u, &w, &u);
+            }
+        }
+    }
+
+    /* v = (g - x * u) / y, the cofactor of y */
+    if (status == SUCCESS)
+    {
+        status = bn_multiply(&x, &u, &v);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_subtract(&st.a, &v, &v);
+    }
+    if (status == SUCCESS && !bn_is_zero(&y))
+    {
+        status = bn_divmod(&v, &y, &v, NULL);
+    }
+
+    if (status == SUCCESS)
+    {
+        bn_swap(g, &st.a);
+        if (swapped)
+        {
+            bn_swap(&u, &v);
+        }
+        if (s != NULL)
+        {
+            bn_swap(s, &u);
+        }
+        if (t != NULL)
+        {
+            bn_swap(t, &v);
+        }
+    }
+    else if (ready)
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    if (ready)
+    {
+        state_free(&st);
+    }
+    bn_free(&x);
+    bn_free(&y);
+    bn_free(&u);
+    bn_free(&v);
+    bn_free(&w);
+
+    STAT_OP_END(STAT_OP_GCD, op_start);
+    return status;
+}
+
+/**
+ * result = lcm(a, b)
+ */
+int bn_lcm(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    if (a == NULL || b == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    BigNumber g, q;
+    bn_init(&g);
+    bn_init(&q);
+
+    int status = bn_gcd(a, b, &g);
+    if (status == SUCCESS && bn_is_zero(&g))
+    {
+        /* lcm(0, 0) = 0 */
+        g.length = 0;
+        bn_swap(result, &g);
+    }
+    else if (status == SUCCESS)
+    {
+        /* |a| / g * |b|, with the decimal places of 2.0 style operands dropped */
+        status = bn_to_integer(a, &q);
+        if (status == SUCCESS)
+        {
+            status = bn_divmod(&q, &g, &q, NULL);
+        }
+        if (status == SUCCESS)
+        {
+            status = bn_to_integer(b, &g);
+        }
+        if (status == SUCCESS)
+        {
+            status = bn_multiply(&q, &g, &q);
+        }
+        if (status == SUCCESS)
+        {
+            q.is_negative = FALSE;
+            bn_swap(result, &q);
+        }
+        else
+        {
+            set_last_error("Memory allocation failed");
+        }
+    }
+
+    bn_free(&g);
+    bn_free(&q);
+
+    STAT_OP_END(STAT_OP_GCD, op_start);
+    return status;
+}
+
+/**
+ * result = a^-1 mod m
+ */
+int bn_invmod(const BigNumber *a, const BigNumber *m, BigNumber *result)
+{
+    if (a == NULL || m == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    if (m->is_negative || bn_is_zero(m))
+    {
+        set_last_error("Modulus must be positive");
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    BigNumber g, s;
+    bn_init(&g);
+    bn_init(&s);
+
+    int status = bn_gcdext(a, m, &g, &s, NULL);
+    if (status == FAILURE && strcmp(last_error(), "GCD needs integer operands") == 0)
+    {
+        set_last_error("Modular inverse needs integer operands");
+    }
+
+    /* gcd 1 (or a modulus of 1, where everything is 0): s in [0, m) */
+    if (status == SUCCESS)
+    {
+        if (g.length != 1 || g.limbs[0] != 1)
+        {
+            set_last_error("Number has no inverse modulo the modulus");
+            status = FAILURE;
+        }
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_mod(&s, m, &s);
+        if (status == SUCCESS && s.is_negative)
+        {
+            status = bn_add(&s, m, &s);
+        }
+        if (status == SUCCESS)
+        {
+            status = bn_to_integer(&s, &s);
+        }
+        if (status == SUCCESS)
+        {
+            bn_swap(result, &s);
+        }
+    }
+
+    bn_free(&g);
+    bn_free(&s);
+
+    STAT_OP_END(STAT_OP_GCD, op_start);
+    return status;
+}
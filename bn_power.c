@@ -0,0 +1,613 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_power.c
+ * Description   : Integer powers and modular powers of BigNumbers
+ * Functions     : bn_power, bn_power_mod
+ *
+ * Algorithm     : Left-to-right sliding-window powering over the bits of the exponent (taken
+ *                 as 32-bit words from bn_to_binary). The odd powers x, x^3, .., x^(2^w - 1)
+ *                 are computed first; the exponent is then scanned from the top, squaring once
+ *                 per bit and multiplying by one table entry per window of up to w bits that
+ *                 starts and ends with a one. For an e-bit exponent that is e squarings and
+ *                 about e / (w + 1) multiplications instead of the e / 2 of plain binary powering.
+ *                 The squarings go through the squaring kernels (limb_sqr).
+ *
+ *   bn_power    : |base| = M * 10^-d is raised as the integer M, then the decimal point is
+ *                 placed at d * e and the sign is negative for a negative base and odd e.
+ *                 A negative exponent computes 1 / base^|e| with bn_divide at the requested
+ *                 precision. Before any work, the digits of M^e are estimated as e * log10(M).
+ *                 A power above POWER_MAX_DIGITS fails at once, which keeps the last squaring
+ *                 within the NTT. Bases 0 and 1 (and -1) accept any exponent.
+ *
+ *   bn_power_mod: Residues are k-limb arrays for a k-limb modulus. Every product and square
+ *                 (2k limbs) is reduced with Barrett reduction (barrett.c), so the loop runs
+ *                 with no division at all; the context comes from the thread's cache, so
+ *                 repeated powers modulo the same m set it up once. The exponent may have
+ *                 any size.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Largest window: a table of 2^(POWER_WINDOW_MAX - 1) odd powers */
+#define POWER_WINDOW_MAX 6
+
+/* Largest power bn_power computes (~75M digits: its final squaring still fits the NTT) */
+#define POWER_MAX_DIGITS ((long double)NTT_MAX_LENGTH * LIMB_DIGITS)
+
+/* log10(2) */
+#define LOG10_2 0.30102999566398119521L
+
+/**
+ * @brief Window width for an exponent of 'bits' bits (larger windows pay off on longer exponents)
+ */
+static int window_width(size_t bits)
+{
+    if (bits > 671)
+    {
+        return 6;
+    }
+    if (bits > 239)
+    {
+        return 5;
+    }
+    if (bits > 79)
+    {
+        return 4;
+    }
+    if (bits > 23)
+    {
+        return 3;
+    }
+    return 1;
+}
+
+/**
+ * @brief Bit i of the exponent words
+ */
+static int exponent_bit(const uint32_t *words, size_t i)
+{
+    return (int)((words[i / 32] >> (i % 32)) & 1u);
+}
+
+/**
+ * @brief Number of significant bits in the exponent words (count has no leading zero word)
+ */
+static size_t exponent_bits(const uint32_t *words, size_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    size_t bits = 32 * (count - 1);
+    for (uint32_t top = words[count - 1]; top != 0; top >>= 1)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief Estimated decimal digits of M^e, e * log10(M), for an integer M >= 2 given as limbs.
+ *        log2 of the two leading limbs is taken without libm: the integer part by halving,
+ *        then 32 fraction bits by repeated squaring (relative error below 2^-32).
+ */
+static long double power_digits(const limb_t *m, size_t n, uint64_t e)
+{
+    /* M = x * B^(n - 1) with x in [1, B) */
+    long double x = m[n - 1];
+    if (n > 1)
+    {
+        x += m[n - 2] / (long double)LIMB_BASE;
+    }
+
+    long double log2_x = 0.0L;
+    while (x >= 2.0L)
+    {
+        x /= 2.0L;
+        log2_x += 1.0L;
+    }
+    long double bit = 0.5L;
+    for (int i = 0; i < 32; i++)
+    {
+        x *= x;
+        if (x >= 2.0L)
+        {
+            x /= 2.0L;
+            log2_x += bit;
+        }
+        bit /= 2.0L;
+    }
+
+    long double log10_m = (long double)(n - 1) * LIMB_DIGITS + log2_x * LOG10_2;
+    return log10_m * (long double)e;
+}
+
+/**
+ * @brief Window below a one bit at position top: its lowest bit (also a one, at most
+ *        width - 1 below top) and its value (odd, below 2^width)
+ */
+static size_t window_at(const uint32_t *words, size_t top, int width, uint32_t *value)
+{
+    size_t low = (top + 1 >= (size_t)width) ? top + 1 - (size_t)width : 0;
+    while (!exponent_bit(words, low))
+    {
+        low++;
+    }
+
+    *value = 0;
+    for (size_t i = top + 1; i-- > low; )
+    {
+        *value = (*value << 1) | (uint32_t)exponent_bit(words, i);
+    }
+    return low;
+}
+
+/**
+ * @brief Exponent of a power as 32-bit words
+ * @return SUCCESS, or FAILURE if it is not an integer or on memory error
+ */
+static int exponent_words(const BigNumber *exponent, uint32_t **words, size_t *count)
+{
+    if (bn_to_binary(exponent, words, count) == FAILURE)
+    {
+        if (strcmp(last_error(), "Value is not an integer") == 0)
+        {
+            set_last_error("Exponent must be an integer");
+        }
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief power = M ^ e for a non-negative integer M and e >= 1 (sliding window)
+ */
+static int integer_power(const BigNumber *m, const uint32_t *words, size_t count, BigNumber *power)
+{
+    size_t bits = exponent_bits(words, count);
+    int width = window_width(bits);
+    size_t table_size = (size_t)1 << (width - 1);
+
+    /* table[i] = M^(2i + 1) */
+    BigNumber table[1 << (POWER_WINDOW_MAX - 1)];
+    BigNumber square;
+    BigNumber acc;
+    bn_init(&square);
+    bn_init(&acc);
+    for (size_t i = 0; i < table_size; i++)
+    {
+        bn_init(&table[i]);
+    }
+
+    int status = bn_copy(&table[0], m);
+    if (status == SUCCESS && table_size > 1)
+    {
+        status = bn_square(m, &square);
+    }
+    for (size_t i = 1; i < table_size && status == SUCCESS; i++)
+    {
+        status = bn_multiply(&table[i - 1], &square, &table[i]);
+    }
+
+    /* Scan from the top bit; acc starts at the first window's power instead of squaring 1 */
+    int started = FALSE;
+    size_t i = bits;
+    while (i > 0 && status == SUCCESS)
+    {
+        size_t top = i - 1;
+        if (!exponent_bit(words, top))
+        {
+            status = bn_square(&acc, &acc);
+            i = top;
+            continue;
+        }
+
+        uint32_t value;
+        size_t low = window_at(words, top, width, &value);
+
+        if (!started)
+        {
+            status = bn_copy(&acc, &table[value / 2]);
+            started = TRUE;
+        }
+        else
+        {
+            for (size_t s = low; s <= top && status == SUCCESS; s++)
+            {
+                status = bn_square(&acc, &acc);
+            }
+            if (status == SUCCESS)
+            {
+                status = bn_multiply(&acc, &table[value / 2], &acc);
+            }
+        }
+        i = low;
+    }
+
+    if (status == SUCCESS)
+    {
+        bn_swap(power, &acc);
+    }
+    else
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    for (size_t t = 0; t < table_size; t++)
+    {
+        bn_free(&table[t]);
+    }
+    bn_free(&square);
+    bn_free(&acc);
+    return status;
+}
+
+/**
+ * @brief result = base ^ exponent (bn_power without the statistics hooks)
+ */
+static int power(const BigNumber *base, const BigNumber *exponent, BigNumber *result,
+                 int precision, RoundingMode mode)
+{
+    if (base == NULL || exponent == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    uint32_t *words = NULL;
+    size_t count = 0;
+    if (exponent_words(exponent, &words, &count) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    int inverse = exponent->is_negative;
+    int odd = (count > 0 && (words[0] & 1u));
+
+    BigNumber one;
+    bn_init(&one);
+    int status = bn_set_small(&one, 1);
+
+    /* x^0 = 1 (0^0 included), 0^e = 0, (+-1)^e = +-1 */
+    if (status == SUCCESS && count == 0)
+    {
+        free(words);
+        bn_swap(result, &one);
+        bn_free(&one);
+        return SUCCESS;
+    }
+    if (status == SUCCESS && bn_is_zero(base))
+    {
+        free(words);
+        bn_free(&one);
+        if (inverse)
+        {
+            set_last_error("Division by zero is undefined");
+            return FAILURE;
+        }
+        return bn_set_small(result, 0);
+    }
+    if (status == SUCCESS && bn_compare_abs(base, &one) == NUMBERS_EQUAL)
+    {
+        free(words);
+        one.is_negative = base->is_negative && odd;
+        bn_swap(result, &one);
+        bn_free(&one);
+        return SUCCESS;
+    }
+
+    /* Any other base: reject an oversized power before the window loop (M >= 2, so a
+       power within POWER_MAX_DIGITS has an exponent that fits 64 bits) */
+    uint64_t e = 0;
+    if (status == SUCCESS)
+    {
+        e = (count > 1) ? ((uint64_t)words[1] << 32) | words[0] : words[0];
+        if (count > 2 || power_digits(base->limbs, base->length, e) > POWER_MAX_DIGITS
+            || (base->decimal_places > 0 && e > (uint64_t)(INT_MAX / base->decimal_places)))
+        {
+            set_last_error("Result too large");
+            status = FAILURE;
+        }
+    }
+
+    /* M = |base| as an integer */
+    BigNumber power;
+    bn_init(&power);
+    if (status == SUCCESS)
+    {
+        status = bn_copy(&power, base);
+        if (status == FAILURE)
+        {
+            set_last_error("Memory allocation failed");
+        }
+    }
+    if (status == SUCCESS)
+    {
+        power.is_negative = FALSE;
+        power.decimal_places = 0;
+        status = integer_power(&power, words, count, &power);
+    }
+
+    if (status == SUCCESS)
+    {
+        power.decimal_places = (int)(base->decimal_places * e);
+        power.is_negative = base->is_negative && odd;
+        bn_normalize(&power);
+
+        if (inverse)
+        {
+            status = bn_divide(&one, &power, result, precision, mode);
+        }
+        else
+        {
+            bn_swap(result, &power);
+        }
+    }
+
+    free(words);
+    bn_free(&one);
+    bn_free(&power);
+    return status;
+}
+
+/**
+ * @brief Residue state of one modular power: k-limb values modulo m
+ */
+typedef struct {
+    const BarrettContext *barrett;
+    size_t k;
+    limb_t *product;        /* 2k limbs */
+} ModRing;
+
+/**
+ * @brief x = x * y mod m (x == y squares)
+ */
+static int mod_multiply(ModRing *ring, limb_t *x, const limb_t *y)
+{
+    int status = (x == y) ? limb_sqr(ring->product, x, ring->k)
+                          : limb_mul(ring->product, x, ring->k, y, ring->k);
+    if (status == SUCCESS)
+    {
+        status = barrett_reduce(ring->barrett, x, ring->product, 2 * ring->k);
+    }
+    return status;
+}
+
+/**
+ * @brief acc = b ^ e mod m for a residue b and e >= 1 (sliding window)
+ */
+static int modular_power(ModRing *ring, limb_t *acc, const limb_t *b, const uint32_t *words, size_t count)
+{
+    size_t k = ring->k;
+    size_t bits = exponent_bits(words, count);
+    int width = window_width(bits);
+    size_t table_size = (size_t)1 << (width - 1);
+
+    /* table[i] = b^(2i + 1) mod m, then b^2 mod m in the last slot */
+    limb_t *table = malloc((table_size + 1) * k * sizeof(limb_t));
+    if (table == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *square = table + table_size * k;
+
+    int status = SUCCESS;
+    memcpy(table, b, k * sizeof(limb_t));
+    if (table_size > 1)
+    {
+        memcpy(square, b, k * sizeof(limb_t));
+        status = mod_multiply(ring, square, square);
+    }
+    for (size_t i = 1; i < table_size && status == SUCCESS; i++)
+    {
+        memcpy(table + i * k, table + (i - 1) * k, k * sizeof(limb_t));
+        status = mod_multiply(ring, table + i * k, square);
+    }
+
+    int started = FALSE;
+    size_t i = bits;
+    while (i > 0 && status == SUCCESS)
+    {
+        size_t top = i - 1;
+        if (!exponent_bit(words, top))
+        {
+            status = mod_multiply(ring, acc, acc);
+            i = top;
+            continue;
+        }
+
+        uint32_t value;
+        size_t low = window_at(words, top, width, &value);
+        const limb_t *entry = table + (value / 2) * k;
+
+        if (!started)
+        {
+            memcpy(acc, entry, k * sizeof(limb_t));
+            started = TRUE;
+        }
+        else
+        {
+            for (size_t s = low; s <= top && status == SUCCESS; s++)
+            {
+                status = mod_multiply(ring, acc, acc);
+            }
+            if (status == SUCCESS)
+            {
+                status = mod_multiply(ring, acc, entry);
+            }
+        }
+        i = low;
+    }
+
+    if (status == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+    }
+    free(table);
+    return status;
+}
+
+/**
+ * Statistics builds time the whole power around the window loop
+ */
+int bn_power(const BigNumber *base, const BigNumber *exponent, BigNumber *result,
+             int precision, RoundingMode mode)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = power(base, exponent, result, precision, mode);
+    STAT_OP_END(STAT_OP_POW, op_start);
+    return status;
+}
+
+/**
+ * @brief result = base ^ exponent mod modulus (bn_power_mod without the statistics hooks)
+ */
+static int power_mod(const BigNumber *base, const BigNumber *exponent, const BigNumber *modulus,
+                     BigNumber *result)
+{
+    if (base == NULL || exponent == NULL || modulus == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    if (exponent->is_negative)
+    {
+        set_last_error("Exponent of a modular power must not be negative");
+        return FAILURE;
+    }
+    if (modulus->is_negative || bn_is_zero(modulus))
+    {
+        set_last_error("Modulus must be positive");
+        return FAILURE;
+    }
+
+    BigNumber b, m;
+    bn_init(&b);
+    bn_init(&m);
+    uint32_t *words = NULL;
+    size_t count = 0;
+
+    int status = bn_to_integer(base, &b);
+    if (status == SUCCESS)
+    {
+        status = bn_to_integer(modulus, &m);
+    }
+    if (status == FAILURE && strcmp(last_error(), "Value is not an integer") == 0)
+    {
+        set_last_error("Modular power needs integer operands");
+    }
+    if (status == SUCCESS)
+    {
+        status = exponent_words(exponent, &words, &count);
+    }
+
+    size_t k = m.length;
+    ModRing ring;
+    ring.k = k;
+    ring.product = NULL;
+    limb_t *residue = NULL;
+    limb_t *acc = NULL;
+
+    if (status == SUCCESS)
+    {
+        ring.product = malloc(2 * k * sizeof(limb_t));
+        residue = calloc(k, sizeof(limb_t));
+        acc = calloc(k + 1, sizeof(limb_t));
+        if (ring.product == NULL || residue == NULL || acc == NULL)
+        {
+            set_last_error("Memory allocation failed");
+            status = FAILURE;
+        }
+    }
+
+    /* residue = base mod m, in [0, m) also for a negative base */
+    if (status == SUCCESS)
+    {
+        if (b.length >= k)
+        {
+            if (limb_div(NULL, residue, b.limbs, b.length, m.limbs, k) == FAILURE)
+            {
+                set_last_error("Memory allocation failed");
+                status = FAILURE;
+            }
+        }
+        else if (b.length > 0)
+        {
+            memcpy(residue, b.limbs, b.length * sizeof(limb_t));
+        }
+    }
+    if (status == SUCCESS && b.is_negative)
+    {
+        size_t i = 0;
+        while (i < k && residue[i] == 0)
+        {
+            i++;
+        }
+        if (i < k)
+        {
+            limb_sub(residue, m.limbs, k, residue, k);
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        /* m = 1 leaves everything 0; e = 0 gives 1 */
+        if (k == 1 && m.limbs[0] == 1)
+        {
+            acc[0] = 0;
+        }
+        else if (count == 0)
+        {
+            acc[0] = 1;
+        }
+        else
+        {
+            ring.barrett = barrett_cached(m.limbs, k);
+            if (ring.barrett == NULL)
+            {
+                status = FAILURE;
+            }
+            else
+            {
+                status = modular_power(&ring, acc, residue, words, count);
+            }
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        status = bn_reserve(result, k);
+        if (status == FAILURE)
+        {
+            set_last_error("Memory allocation failed");
+        }
+    }
+    if (status == SUCCESS)
+    {
+        memcpy(result->limbs, acc, k * sizeof(limb_t));
+        result->length = k;
+        result->is_negative = FALSE;
+        result->decimal_places = 0;
+        bn_normalize(result);
+    }
+
+    free(ring.product);
+    free(residue);
+    free(acc);
+    free(words);
+    bn_free(&b);
+    bn_free(&m);
+    return status;
+}
+
+/**
+ * Statistics builds time the whole modular power, Barrett setup included
+ */
+int bn_power_mod(const BigNumber *base, const BigNumber *exponent, const BigNumber *modulus,
+                 BigNumber *result)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = power_mod(base, exponent, modulus, result);
+    STAT_OP_END(STAT_OP_POW, op_start);
+    return status;
+}
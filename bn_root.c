@@ -0,0 +1,543 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_root.c
+ * Description   : Square roots and n-th roots of BigNumbers to a given number of decimals
+ * Functions     : bn_sqrt, bn_isqrt, bn_root
+ *
+ * Algorithm     : With a = A * 10^-d, k the degree and P the requested fractional digits, the
+ *                 root is taken one guard digit deeper, at Q = max(P, ceil(d / k)) + 1 digits:
+ *
+ *                     floor(a^(1/k) * 10^Q) = floor((A * 10^(kQ - d))^(1/k))
+ *
+ *                 The integer root s of N = A * 10^(kQ - d) is exact, and so is the test
+ *                 s^k == N, so the rounding to P digits sees the truncated digits t plus a flag
+ *                 for the infinite tail: with D = 10^(Q - P), s = q * D + t and
+ *
+ *                     truncate / floor : q
+ *                     ceil             : q + 1 if t != 0 or s^k != N
+ *                     half-up          : q + 1 if t >= D/2
+ *                     half-even        : q + 1 if t > D/2, or t == D/2 and (s^k != N or q odd)
+ *
+ *                 (mirrored for the negative odd roots of negative numbers).
+ *
+ *   Square root : limb_sqrt() (reciprocal square root Newton iteration, remainder included).
+ *
+ *   n-th root   : Newton from above, y = ((k - 1) * y + N / y^(k - 1)) / k, stopping when y
+ *                 no longer decreases. The start is the root of N with the low k * j digits
+ *                 dropped (computed the same way, recursively), plus one, times 10^j, for j
+ *                 half the root's digits; every level therefore starts with half the digits
+ *                 correct and needs about two steps. Roots of up to 15 digits start from a
+ *                 long double estimate.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Largest root degree accepted */
+#define ROOT_DEGREE_MAX 1000000
+
+/* Roots of at most this many digits start from a long double estimate */
+#define ROOT_ESTIMATE_DIGITS 15
+
+/* mantissa * 2^exponent: a long double with an exponent that cannot overflow */
+typedef struct {
+    long double mantissa;
+    long exponent;
+} ScaledValue;
+
+/**
+ * @brief Decimal digits of a non-negative integer (0 for zero)
+ */
+static size_t digit_count(const BigNumber *num)
+{
+    if (num->length == 0)
+    {
+        return 0;
+    }
+
+    size_t digits = (num->length - 1) * LIMB_DIGITS;
+    for (limb_t top = num->limbs[num->length - 1]; top != 0; top /= 10)
+    {
+        digits++;
+    }
+    return digits;
+}
+
+/**
+ * @brief num = floor(num / 10^digits) for a non-negative integer
+ */
+static void drop_digits(BigNumber *num, size_t digits)
+{
+    size_t limbs = digits / LIMB_DIGITS;
+    if (limbs >= num->length)
+    {
+        num->length = 0;
+        return;
+    }
+
+    if (limbs > 0)
+    {
+        memmove(num->limbs, num->limbs + limbs, (num->length - limbs) * sizeof(limb_t));
+        num->length -= limbs;
+    }
+
+    limb_t divisor = 1;
+    for (size_t i = 0; i < digits % LIMB_DIGITS; i++)
+    {
+        divisor *= 10;
+    }
+    if (divisor > 1)
+    {
+        limb_div_small(num->limbs, num->limbs, num->length, divisor);
+    }
+    bn_normalize(num);
+}
+
+/**
+ * @brief num = num + 1 for a non-negative integer
+ */
+static int increment(BigNumber *num)
+{
+    if (bn_reserve(num, num->length + 1) == FAILURE)
+    {
+        return FAILURE;
+    }
+    num->limbs[num->length++] = 0;
+    limb_increment(num->limbs, num->length);
+    bn_normalize(num);
+    return SUCCESS;
+}
+
+/**
+ * @brief Product of a non-negative integer by a small factor (factor < LIMB_BASE)
+ */
+static int multiply_small(BigNumber *num, limb_t factor)
+{
+    if (bn_reserve(num, num->length + 1) == FAILURE)
+    {
+        return FAILURE;
+    }
+    limb_t carry = limb_mul_small(num->limbs, num->limbs, num->length, factor);
+    if (carry != 0)
+    {
+        num->limbs[num->length++] = carry;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Normalize a scaled value mantissa * 2^exponent to a mantissa in [1, 2)
+ */
+static void scaled_normalize(ScaledValue *value)
+{
+    while (value->mantissa >= 2.0L)
+    {
+        value->mantissa /= 2.0L;
+        value->exponent++;
+    }
+    while (value->mantissa < 1.0L)
+    {
+        value->mantissa *= 2.0L;
+        value->exponent--;
+    }
+}
+
+/**
+ * @brief base^k as a scaled value (square and multiply, normalized at every step)
+ */
+static ScaledValue scaled_power(long double base, uint32_t k)
+{
+    ScaledValue result = { 1.0L, 0 };
+    ScaledValue square = { base, 0 };
+    scaled_normalize(&square);
+
+    while (k > 0)
+    {
+        if (k & 1u)
+        {
+            result.mantissa *= square.mantissa;
+            result.exponent += square.exponent;
+            scaled_normalize(&result);
+        }
+        square.mantissa *= square.mantissa;
+        square.exponent *= 2;
+        scaled_normalize(&square);
+        k >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Compare two normalized scaled values
+ */
+static int scaled_less(const ScaledValue *a, const ScaledValue *b)
+{
+    if (a->exponent != b->exponent)
+    {
+        return a->exponent < b->exponent;
+    }
+    return a->mantissa < b->mantissa;
+}
+
+/**
+ * @brief Start of the Newton iteration for a root of few digits, from a long double estimate
+ */
+static int estimate_root(const BigNumber *n, uint32_t k, BigNumber *start)
+{
+    /* N ~ top * (10^9)^skipped from its top two limbs; kept scaled, as N^(1/k) fits but N may not */
+    size_t skipped = (n->length > 2) ? n->length - 2 : 0;
+    long double top = 0.0L;
+    for (size_t i = n->length; i-- > skipped; )
+    {
+        top = top * LIMB_BASE + n->limbs[i];
+    }
+    ScaledValue target = scaled_power((long double)LIMB_BASE, (uint32_t)skipped);
+    target.mantissa *= top;
+    scaled_normalize(&target);
+
+    /* Bisect y^k = N over [1, 10^15] (no libm) */
+    long double low = 1.0L;
+    long double high = 1e16L;
+    for (int i = 0; i < 128; i++)
+    {
+        long double mid = (low + high) / 2.0L;
+        ScaledValue power = scaled_power(mid, k);
+        if (scaled_less(&target, &power))
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid;
+        }
+    }
+
+    /* A little above the root; the first Newton step corrects any error either way */
+    return bn_set_small(start, (uint64_t)(high * (1.0L + 1e-15L)) + 1);
+}
+
+/**
+ * @brief root = floor(N^(1/k)) for a non-negative integer N and k >= 3
+ */
+static int integer_root(const BigNumber *n, uint32_t k, BigNumber *root)
+{
+    BigNumber y, next, power, quotient, degree;
+    bn_init(&y);
+    bn_init(&next);
+    bn_init(&power);
+    bn_init(&quotient);
+    bn_init(&degree);
+
+    size_t root_digits = digit_count(n) / k + 1;
+    int status;
+
+    if (root_digits <= ROOT_ESTIMATE_DIGITS)
+    {
+        status = estimate_root(n, k, &y);
+    }
+    else
+    {
+        /* y0 = (root(floor(N / 10^(kj))) + 1) * 10^j >= root(N) */
+        size_t j = root_digits / 2;
+        status = bn_copy(&next, n);
+        if (status == SUCCESS)
+        {
+            drop_digits(&next, (size_t)k * j);
+            status = integer_root(&next, k, &y);
+        }
+        if (status == SUCCESS)
+        {
+            status = increment(&y);
+            if (status == SUCCESS)
+            {
+                status = bn_scale_up(&y, (int)j);
+                y.decimal_places = 0;
+            }
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        status = bn_set_small(&degree, k - 1);
+    }
+
+    /* Newton: after the first step y >= floor(N^(1/k)) and decreases monotonically to it */
+    int first = TRUE;
+    while (status == SUCCESS)
+    {
+        status = bn_power(&y, &degree, &power, 0, ROUND_TRUNCATE);
+        if (status == SUCCESS)
+        {
+            status = bn_divmod(n, &power, &quotient, NULL);
+        }
+        if (status == SUCCESS)
+        {
+            status = bn_copy(&next, &y);
+        }
+        if (status == SUCCESS)
+        {
+            status = multiply_small(&next, k - 1);
+        }
+        if (status == SUCCESS)
+        {
+            status = bn_add(&next, &quotient, &next);
+        }
+        if (status == SUCCESS)
+        {
+            limb_div_small(next.limbs, next.limbs, next.length, k);
+            bn_normalize(&next);
+            if (!first && bn_compare(&next, &y) != SECOND_LARGER)
+            {
+                break;
+            }
+            bn_swap(&y, &next);
+            first = FALSE;
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        bn_swap(root, &y);
+    }
+
+    bn_free(&y);
+    bn_free(&next);
+    bn_free(&power);
+    bn_free(&quotient);
+    bn_free(&degree);
+    return status;
+}
+
+/**
+ * @brief result = a^(1/k) rounded to 'precision' fractional digits
+ */
+static int compute_root(const BigNumber *a, uint32_t k, BigNumber *result, int precision, RoundingMode mode)
+{
+    if (precision < 0)
+    {
+        set_last_error("Root precision must not be negative");
+        return FAILURE;
+    }
+    if (a->is_negative && !bn_is_zero(a) && k % 2 == 0)
+    {
+        set_last_error("Even root of a negative number is undefined");
+        return FAILURE;
+    }
+
+    /* Q = max(P, ceil(d / k)) + 1 digits, and N = |A| * 10^(kQ - d) */
+    long long q_digits = (a->decimal_places + (long long)k - 1) / k;
+    if (q_digits < precision)
+    {
+        q_digits = precision;
+    }
+    q_digits++;
+    if (q_digits * k > INT_MAX)
+    {
+        set_last_error("Result too large");
+        return FAILURE;
+    }
+
+    if (bn_is_zero(a))
+    {
+        result->length = 0;
+        result->is_negative = FALSE;
+        result->decimal_places = 0;
+        return SUCCESS;
+    }
+
+    int negative = a->is_negative;
+    if (negative)
+    {
+        /* The root of |a| is rounded the other way for floor and ceil */
+        mode = (mode == ROUND_FLOOR) ? ROUND_CEIL : (mode == ROUND_CEIL) ? ROUND_FLOOR : mode;
+    }
+
+    BigNumber n, s, check, q, t, unit, half;
+    bn_init(&n);
+    bn_init(&s);
+    bn_init(&check);
+    bn_init(&q);
+    bn_init(&t);
+    bn_init(&unit);
+    bn_init(&half);
+
+    int status = bn_copy(&n, a);
+    if (status == SUCCESS)
+    {
+        n.is_negative = FALSE;
+        n.decimal_places = 0;
+        status = bn_scale_up(&n, (int)(q_digits * k) - a->decimal_places);
+        n.decimal_places = 0;
+    }
+
+    /* s = floor(N^(1/k)); exact when the remainder N - s^k is zero */
+    int exact = FALSE;
+    if (status == SUCCESS && k == 2)
+    {
+        size_t m = (n.length + 1) / 2;
+        status = bn_reserve(&s, m + 1);
+        if (status == SUCCESS)
+        {
+            status = bn_reserve(&check, m + 1);
+        }
+        if (status == SUCCESS)
+        {
+            status = limb_sqrt(s.limbs, check.limbs, n.limbs, n.length);
+            s.length = m;
+            check.length = m + 1;
+            bn_normalize(&s);
+            bn_normalize(&check);
+            exact = bn_is_zero(&check);
+        }
+    }
+    else if (status == SUCCESS)
+    {
+        status = integer_root(&n, k, &s);
+        if (status == SUCCESS)
+        {
+            BigNumber degree;
+            bn_init(&degree);
+            status = bn_set_small(&degree, k);
+            if (status == SUCCESS)
+            {
+                status = bn_power(&s, &degree, &check, 0, ROUND_TRUNCATE);
+            }
+            bn_free(&degree);
+            exact = (status == SUCCESS && bn_compare(&check, &n) == NUMBERS_EQUAL);
+        }
+    }
+
+    /* s = q * 10^(Q - P) + t: round q by t and the exactness of s */
+    if (status == SUCCESS)
+    {
+        status = bn_set_small(&unit, 1);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_scale_up(&unit, (int)q_digits - precision);
+        unit.decimal_places = 0;
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_divmod(&s, &unit, &q, &t);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_set_small(&half, 5);
+    }
+    if (status == SUCCESS)
+    {
+        status = bn_scale_up(&half, (int)q_digits - precision - 1);
+        half.decimal_places = 0;
+    }
+
+    if (status == SUCCESS)
+    {
+        ComparisonResult tail = bn_compare(&t, &half);
+        int round_up = FALSE;
+        switch (mode)
+        {
+            case ROUND_CEIL:
+                round_up = !exact || !bn_is_zero(&t);
+                break;
+
+            case ROUND_HALF_UP:
+                round_up = (tail != SECOND_LARGER);
+                break;
+
+            case ROUND_HALF_EVEN:
+                round_up = (tail == FIRST_LARGER)
+                           || (tail == NUMBERS_EQUAL && (!exact || (q.length > 0 && (q.limbs[0] & 1u))));
+                break;
+
+            default:
+                break;
+        }
+
+        if (round_up)
+        {
+            status = increment(&q);
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        q.decimal_places = precision;
+        q.is_negative = negative;
+        bn_normalize(&q);
+        bn_swap(result, &q);
+    }
+    else if (strcmp(last_error(), "Result too large") != 0)
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    bn_free(&n);
+    bn_free(&s);
+    bn_free(&check);
+    bn_free(&q);
+    bn_free(&t);
+    bn_free(&unit);
+    bn_free(&half);
+    return status;
+}
+
+/**
+ * @brief compute_root timed as one root operation in statistics builds
+ */
+static int root_digits(const BigNumber *a, uint32_t k, BigNumber *result, int precision, RoundingMode mode)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = compute_root(a, k, result, precision, mode);
+    STAT_OP_END(STAT_OP_ROOT, op_start);
+    return status;
+}
+
+/**
+ * result = sqrt(a) to 'precision' fractional digits
+ */
+int bn_sqrt(const BigNumber *a, BigNumber *result, int precision, RoundingMode mode)
+{
+    if (a == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    return root_digits(a, 2, result, precision, mode);
+}
+
+/**
+ * result = floor(sqrt(a))
+ */
+int bn_isqrt(const BigNumber *a, BigNumber *result)
+{
+    if (a == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    return root_digits(a, 2, result, 0, ROUND_FLOOR);
+}
+
+/**
+ * result = a^(1/degree) to 'precision' fractional digits
+ */
+int bn_root(const BigNumber *a, const BigNumber *degree, BigNumber *result, int precision, RoundingMode mode)
+{
+    if (a == NULL || degree == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    uint32_t *words = NULL;
+    size_t count = 0;
+    if (bn_to_binary(degree, &words, &count) == FAILURE || degree->is_negative || count > 1
+        || count == 0 || words[0] < 2 || words[0] > ROOT_DEGREE_MAX)
+    {
+        free(words);
+        set_last_error("Root degree must be an integer from 2 to 1000000");
+        return FAILURE;
+    }
+
+    uint32_t k = words[0];
+    free(words);
+    return root_digits(a, k, result, precision, mode);
+}
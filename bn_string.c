@@ -0,0 +1,695 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_string.c
+ * Description   : Conversion between decimal strings and the BigNumber representation
+ * Functions     : bn_from_string, limb_to_digits, bn_format, bn_format_with, bn_to_string, bn_print
+ *
+ * Parsing       : Digits are validated and packed nine at a time from the right end of the string
+ *                 directly into limbs, eight digits per 64-bit word operation (SWAR) on
+ *                 little-endian hosts; the decimal point only sets decimal_places.
+ * Formatting    : Limbs are expanded into one output buffer (most significant first) two
+ *                 digits at a time from a 200-byte pair table, the decimal point is placed
+ *                 decimal_places digits from the right and trailing fractional zeros are
+ *                 dropped (123.4500 -> 123.45, 1.000 -> 1). The integer part can be grouped
+ *                 (1,234,567.5) or the whole number written as d.ddd...e+N. Printing is a
+ *                 single fwrite of that buffer.
+ * Hexadecimal   : "0x" integers are parsed into and formatted from 32-bit words, converted to
+ *                 and from limbs by the divide-and-conquer routines in radix.c.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Eight ASCII digits are converted at once in a 64-bit word on little-endian hosts */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PARSE_SWAR 1
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Room for "e", the exponent sign and its digits */
+#define SCIENTIFIC_EXPONENT_SIZE 24
+
+/* "00" "01" ... "99": two output digits per table lookup */
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * @brief Value of n ASCII digits (n <= 9), most significant first
+ * @return TRUE if every character is a digit, FALSE otherwise
+ */
+static int parse_digits(const char *p, size_t n, limb_t *value)
+{
+    limb_t result = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned digit = (unsigned char)p[i] - (unsigned)'0';
+        if (digit > 9)
+        {
+            return FALSE;
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = result;
+    return TRUE;
+}
+
+/**
+ * @brief Convert 'count' full limbs whose digits end just before 'end', least significant first
+ * @return TRUE if every character is a digit, FALSE otherwise
+ */
+static int parse_limb_run(limb_t *out, const char *end, size_t count)
+{
+#ifdef PARSE_SWAR
+    /* Validation is OR-ed into one flag so the loop has no data-dependent branches */
+    uint64_t invalid = 0;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    /* Two limbs (18 digits) per step: the low 16 digits in one vector, reduced by pairs */
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mul_10 = _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10);
+    const __m128i mul_100 = _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100);
+    const __m128i mul_10000 = _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000);
+    __m128i bad = zero;
+
+    for (; i + 2 <= count; i += 2)
+    {
+        end -= 2 * LIMB_DIGITS;
+
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)(const void *)(end + 2)), zero_char);
+        bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmplt_epi8(v, zero), _mm_cmpgt_epi8(v, nine)));
+
+        __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), mul_10),
+                                        _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), mul_10));
+        __m128i quads = _mm_madd_epi16(pairs, mul_100);
+        __m128i octs = _mm_madd_epi16(_mm_packs_epi32(quads, quads), mul_10000);
+
+        uint32_t high8 = (uint32_t)_mm_cvtsi128_si32(octs);                      /* digits 2..9   */
+        uint32_t low8 = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(octs, 4));     /* digits 10..17 */
+        uint64_t d0 = (uint64_t)(unsigned char)end[0] - '0';
+        uint64_t d1 = (uint64_t)(unsigned char)end[1] - '0';
+        invalid |= (d0 > 9) | (d1 > 9);
+
+        out[i] = (limb_t)((high8 % 10) * 100000000u + low8);
+        out[i + 1] = (limb_t)((d0 * 10 + d1) * 10000000u + high8 / 10);
+    }
+    invalid |= (uint64_t)_mm_movemask_epi8(bad);
+#endif
+
+    for (; i < count; i++)
+    {
+        end -= LIMB_DIGITS;
+
+        uint64_t lead = (uint64_t)(unsigned char)end[0] - '0';
+        uint64_t chunk;
+        memcpy(&chunk, end + 1, sizeof(chunk));
+
+        /* Every byte must be 0x30..0x39: high nibble 3, and still 3 after adding 6 */
+        invalid |= (lead > 9)
+                   | ((chunk & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull)
+                   | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull);
+
+        /* Combine neighbouring digits, then pairs, then quads (byte 0 is the most significant) */
+        chunk -= 0x3030303030303030ull;
+        chunk = chunk * 10 + (chunk >> 8);
+        chunk = ((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))
+                 + ((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))) >> 32;
+
+        out[i] = (limb_t)(lead * 100000000u + (uint32_t)chunk);
+    }
+
+    return (invalid == 0) ? TRUE : FALSE;
+#else
+    for (size_t i = 0; i < count; i++)
+    {
+        end -= LIMB_DIGITS;
+        if (!parse_digits(end, LIMB_DIGITS, &out[i]))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+#endif
+}
+
+/**
+ * @brief Value of a hexadecimal digit, or -1 for any other character
+ */
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse the digits of a hexadecimal integer (after "0x") through 32-bit words
+ */
+static int parse_hex(BigNumber *num, const char *digits, int negative)
+{
+    size_t n = strlen(digits);
+    size_t count = (n + 7) / 8;
+
+    uint32_t *words = malloc((count + 1) * sizeof(uint32_t));
+    if (words == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    /* Eight digits per word, counted from the right */
+    int valid = (n > 0);
+    for (size_t w = 0; w < count && valid; w++)
+    {
+        size_t end = n - 8 * w;
+        size_t start = (end > 8) ? end - 8 : 0;
+        uint32_t value = 0;
+
+        for (size_t i = start; i < end; i++)
+        {
+            int digit = hex_value(digits[i]);
+            if (digit < 0)
+            {
+                valid = FALSE;
+                break;
+            }
+            value = (value << 4) | (uint32_t)digit;
+        }
+        words[w] = value;
+    }
+
+    int status = FAILURE;
+    if (valid)
+    {
+        status = bn_from_binary(num, words, count, negative);
+    }
+    else
+    {
+        num->length = 0;
+        num->is_negative = FALSE;
+        num->decimal_places = 0;
+        set_last_error("Invalid number format");
+    }
+
+    free(words);
+    return status;
+}
+
+/**
+ * Parse a decimal string (or a "0x" hexadecimal integer) into a BigNumber
+ *
+ * One pass over the digits validates and packs them: limbs are nine digits counted from the
+ * right and are converted straight from the string, the fractional run first, then the integer
+ * run. Only the limb that straddles the decimal point is gathered into a small buffer.
+ */
+int bn_from_string(BigNumber *num, const char *str)
+{
+    if (num == NULL || str == NULL)
+    {
+        set_last_error("Invalid number format");
+        return FAILURE;
+    }
+
+    int negative = FALSE;
+    if (*str == '-')
+    {
+        negative = TRUE;
+        str++;
+    }
+
+    /* Hexadecimal integer: converted through binary words */
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+    {
+        STAT_OP_BEGIN(hex_start);
+        int status = parse_hex(num, str + 2, negative);
+        STAT_OP_END(STAT_OP_PARSE, hex_start);
+        return status;
+    }
+
+    /* Locate the end and the decimal point (library scans, bandwidth bound) */
+    size_t total_len = strlen(str);
+    const char *dot = memchr(str, '.', total_len);
+    size_t int_digits = (dot != NULL) ? (size_t)(dot - str) : total_len;
+    size_t frac_digits = (dot != NULL) ? total_len - int_digits - 1 : 0;
+
+    if (int_digits + frac_digits == 0 || frac_digits > (size_t)INT_MAX)
+    {
+        set_last_error("Invalid number format");
+        return FAILURE;
+    }
+
+    STAT_OP_BEGIN(op_start);
+
+    size_t limb_count = (int_digits + frac_digits + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    if (bn_reserve(num, limb_count) == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+        STAT_OP_END(STAT_OP_PARSE, op_start);
+        return FAILURE;
+    }
+
+    limb_t *out = num->limbs;
+    size_t int_left = int_digits;
+    int valid = TRUE;
+
+    if (dot != NULL)
+    {
+        /* Whole limbs of fractional digits */
+        size_t full = frac_digits / LIMB_DIGITS;
+        valid = parse_limb_run(out, str + total_len, full);
+        out += full;
+
+        /* The rest of the fraction shares a limb with the lowest integer digits */
+        size_t rest = frac_digits % LIMB_DIGITS;
+        if (rest > 0 && valid)
+        {
+            size_t borrowed = LIMB_DIGITS - rest;
+            if (borrowed > int_left)
+            {
+                borrowed = int_left;
+            }
+
+            char gathered[LIMB_DIGITS];
+            memcpy(gathered, dot - borrowed, borrowed);
+            memcpy(gathered + borrowed, dot + 1, rest);
+            valid = parse_digits(gathered, borrowed + rest, out++);
+            int_left -= borrowed;
+        }
+    }
+
+    /* Integer digits: whole limbs from the right, then the short top limb */
+    if (valid)
+    {
+        size_t full = int_left / LIMB_DIGITS;
+        valid = parse_limb_run(out, str + int_left, full);
+        out += full;
+    }
+    if (valid && int_left % LIMB_DIGITS > 0)
+    {
+        valid = parse_digits(str, int_left % LIMB_DIGITS, out++);
+    }
+
+    if (!valid)
+    {
+        num->length = 0;
+        num->is_negative = FALSE;
+        num->decimal_places = 0;
+        set_last_error("Invalid number format");
+        STAT_OP_END(STAT_OP_PARSE, op_start);
+        return FAILURE;
+    }
+
+    num->length = (size_t)(out - num->limbs);
+    num->is_negative = negative;
+    num->decimal_places = (int)frac_digits;
+    bn_normalize(num);
+
+    STAT_OP_END(STAT_OP_PARSE, op_start);
+    return SUCCESS;
+}
+
+/**
+ * Write the nine digits of one limb (leading zeros included) using the pair table
+ *
+ * The limb is split into a 5-digit and a 4-digit half so the two chains of divisions are
+ * independent; each pair of digits is then a single two-byte copy.
+ */
+void limb_to_digits(char *slot, limb_t limb)
+{
+    uint32_t high = limb / 10000;
+    uint32_t low = limb % 10000;
+
+    slot[0] = (char)('0' + high / 10000);
+    memcpy(slot + 1, digit_pairs + 2 * ((high / 100) % 100), 2);
+    memcpy(slot + 3, digit_pairs + 2 * (high % 100), 2);
+    memcpy(slot + 5, digit_pairs + 2 * (low / 100), 2);
+    memcpy(slot + 7, digit_pairs + 2 * (low % 100), 2);
+}
+
+/**
+ * @brief Copy the integer digits, inserting a separator every 'group' digits from the right
+ * @return Position after the last character written
+ *
+ * The destination may overlap the source as long as it starts before it (bn_format_with keeps
+ * the raw digits at the end of the same buffer), so the copy runs strictly forward.
+ */
+static char *copy_grouped(char *out, const char *digits, size_t count, int group, char separator)
+{
+    if (group <= 0)
+    {
+        memmove(out, digits, count);
+        return out + count;
+    }
+
+    size_t lead = count % (size_t)group;
+    if (lead == 0)
+    {
+        lead = (size_t)group;
+    }
+
+    for (size_t i = 0; i < count; )
+    {
+        size_t run = (i == 0) ? lead : (size_t)group;
+        if (i > 0)
+        {
+            *out++ = separator;
+        }
+        memmove(out, digits + i, run);
+        out += run;
+        i += run;
+    }
+
+    return out;
+}
+
+/**
+ * @brief Write d.ddd...e+N from the significant digits (no leading zeros, at least one digit)
+ * @param exponent Decimal exponent of the first digit
+ * @param significant Mantissa digits to show, padded with zeros (0 = all, trailing zeros dropped)
+ * @return Position after the last character written
+ */
+static char *write_scientific(char *out, char *digits, size_t count, long exponent, int significant)
+{
+    /* Round half up to the requested number of digits */
+    if (significant > 0 && count > (size_t)significant)
+    {
+        size_t keep = (size_t)significant;
+        int round_up = (digits[keep] >= '5');
+        count = keep;
+
+        while (round_up && keep > 0)
+        {
+            if (digits[keep - 1] == '9')
+            {
+                digits[--keep] = '0';
+            }
+            else
+            {
+                digits[keep - 1]++;
+                round_up = FALSE;
+            }
+        }
+        if (round_up)
+        {
+            /* 99.9 -> 100: the mantissa becomes 1 and the exponent grows */
+            digits[0] = '1';
+            exponent++;
+        }
+    }
+
+    /* A requested digit count is shown in full (--sci=3: 1.00e+1); otherwise trailing zeros
+       of the mantissa carry no information */
+    size_t shown = (size_t)significant;
+    if (significant == 0)
+    {
+        while (count > 1 && digits[count - 1] == '0')
+        {
+            count--;
+        }
+        shown = count;
+    }
+
+    *out++ = digits[0];
+    if (shown > 1)
+    {
+        *out++ = '.';
+        memmove(out, digits + 1, count - 1);
+        out += count - 1;
+        memset(out, '0', shown - count);
+        out += shown - count;
+    }
+
+    return out + sprintf(out, "e%+ld", exponent);
+}
+
+/**
+ * @brief Grow a caller-owned text buffer to at least 'capacity' bytes
+ */
+static int reserve_text(char **text, size_t *text_capacity, size_t capacity)
+{
+    if (*text == NULL || *text_capacity < capacity)
+    {
+        char *grown = realloc(*text, capacity);
+        if (grown == NULL)
+        {
+            set_last_error("Memory allocation failed");
+            return FAILURE;
+        }
+        *text = grown;
+        *text_capacity = capacity;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Format an integer as "0x" followed by lowercase hexadecimal digits
+ *
+ * The value is converted to 32-bit words first (bn_to_binary, subquadratic); each word then
+ * gives exactly eight digits.
+ */
+static int format_hex(const BigNumber *num, const FormatOptions *format, char **text,
+                      size_t *text_capacity, size_t *text_length)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    uint32_t *words;
+    size_t count;
+
+    if (bn_to_binary(num, &words, &count) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    /* Digits of the top word without its leading zeros, eight for every other word */
+    size_t digit_count = 1;
+    if (count > 0)
+    {
+        digit_count = 8 * (count - 1);
+        for (uint32_t top = words[count - 1]; top != 0; top >>= 4)
+        {
+            digit_count++;
+        }
+    }
+
+    /* Room for sign, "0x", separators, digits and terminator */
+    size_t capacity = digit_count + 4;
+    if (format->group_size > 0)
+    {
+        capacity += (digit_count - 1) / (size_t)format->group_size;
+    }
+    if (reserve_text(text, text_capacity, capacity) == FAILURE)
+    {
+        free(words);
+        return FAILURE;
+    }
+    char *buffer = *text;
+
+    /* Raw digits at the end of the buffer, least significant word last */
+    char *digits = buffer + capacity - digit_count - 1;
+    char *slot = digits + digit_count;
+    if (count == 0)
+    {
+        digits[0] = '0';
+    }
+    for (size_t w = 0; w < count; w++)
+    {
+        uint32_t word = words[w];
+        for (int k = 0; k < 8 && slot > digits; k++)
+        {
+            *--slot = hex_digits[word & 0xF];
+            word >>= 4;
+        }
+    }
+    free(words);
+
+    char *out = buffer;
+    if (num->is_negative && count > 0)
+    {
+        *out++ = '-';
+    }
+    *out++ = '0';
+    *out++ = 'x';
+    out = copy_grouped(out, digits, digit_count, format->group_size, format->group_separator);
+    *out = '\0';
+
+    if (text_length != NULL)
+    {
+        *text_length = (size_t)(out - buffer);
+    }
+    return SUCCESS;
+}
+
+/**
+ * Format a BigNumber into a caller-owned buffer that grows as needed
+ */
+int bn_format(const BigNumber *num, char **text, size_t *text_capacity, size_t *text_length)
+{
+    return bn_format_with(num, NULL, text, text_capacity, text_length);
+}
+
+/**
+ * Format a BigNumber with digit grouping or in scientific notation
+ */
+int bn_format_with(const BigNumber *num, const FormatOptions *format, char **text,
+                   size_t *text_capacity, size_t *text_length)
+{
+    STAT_OP_BEGIN(op_start);
+
+    static const FormatOptions plain = { 0, ',', FALSE, 0, 10 };
+    if (format == NULL)
+    {
+        format = &plain;
+    }
+
+    if (format->radix == 16)
+    {
+        int status = format_hex(num, format, text, text_capacity, text_length);
+        STAT_OP_END(STAT_OP_FORMAT, op_start);
+        return status;
+    }
+
+    size_t digit_count = num->length * LIMB_DIGITS;
+    size_t frac = (size_t)num->decimal_places;
+
+    /* Room for sign, "0." prefix, padding zeros, separators, exponent, digits and terminator */
+    size_t capacity = digit_count + frac + 4;
+    if (format->group_size > 0)
+    {
+        capacity += digit_count / (size_t)format->group_size;
+    }
+    if (format->scientific)
+    {
+        capacity += SCIENTIFIC_EXPONENT_SIZE + (size_t)format->significant;
+    }
+    if (reserve_text(text, text_capacity, capacity) == FAILURE)
+    {
+        STAT_OP_END(STAT_OP_FORMAT, op_start);
+        return FAILURE;
+    }
+    char *buffer = *text;
+
+    /* Expand limbs into raw digits, most significant first */
+    char *digits = buffer + capacity - digit_count - 1;
+    for (size_t i = 0; i < num->length; i++)
+    {
+        limb_to_digits(digits + (num->length - 1 - i) * LIMB_DIGITS, num->limbs[i]);
+    }
+    digits[digit_count] = '\0';
+
+    /* Skip leading zeros of the top limb */
+    while (digit_count > 0 && *digits == '0')
+    {
+        digits++;
+        digit_count--;
+    }
+
+    /* Drop trailing fractional zeros */
+    while (frac > 0 && digit_count > 0 && digits[digit_count - 1] == '0')
+    {
+        digit_count--;
+        frac--;
+    }
+    if (digit_count == 0)
+    {
+        frac = 0;
+    }
+
+    char *out = buffer;
+    if (num->is_negative && digit_count > 0)
+    {
+        *out++ = '-';
+    }
+
+    if (digit_count == 0)
+    {
+        *out++ = '0';
+    }
+    else if (format->scientific)
+    {
+        long exponent = (long)digit_count - (long)frac - 1;
+        out = write_scientific(out, digits, digit_count, exponent, format->significant);
+    }
+    else if (digit_count <= frac)
+    {
+        /* Pure fraction: "0." followed by (frac - digit_count) zeros */
+        *out++ = '0';
+        *out++ = '.';
+        for (size_t i = digit_count; i < frac; i++)
+        {
+            *out++ = '0';
+        }
+        memmove(out, digits, digit_count);
+        out += digit_count;
+    }
+    else
+    {
+        size_t int_len = digit_count - frac;
+        out = copy_grouped(out, digits, int_len, format->group_size, format->group_separator);
+        if (frac > 0)
+        {
+            *out++ = '.';
+            memmove(out, digits + int_len, frac);
+            out += frac;
+        }
+    }
+    *out = '\0';
+
+    if (text_length != NULL)
+    {
+        *text_length = (size_t)(out - buffer);
+    }
+
+    STAT_OP_END(STAT_OP_FORMAT, op_start);
+    return SUCCESS;
+}
+
+/**
+ * Format a BigNumber as a newly allocated decimal string
+ */
+char *bn_to_string(const BigNumber *num)
+{
+    char *text = NULL;
+    size_t capacity = 0;
+
+    if (bn_format(num, &text, &capacity, NULL) == FAILURE)
+    {
+        free(text);
+        return NULL;
+    }
+
+    return text;
+}
+
+/**
+ * Print a BigNumber to stdout (one fwrite of the whole formatted text)
+ */
+void bn_print(const BigNumber *num, const FormatOptions *format)
+{
+    char *text = NULL;
+    size_t capacity = 0;
+    size_t length = 0;
+
+    if (bn_format_with(num, format, &text, &capacity, &length) == SUCCESS)
+    {
+        fwrite(text, 1, length, stdout);
+    }
+
+    free(text);
+}
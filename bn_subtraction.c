@@ -0,0 +1,103 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : bn_subtraction.c
+ * Description   : Subtraction of two BigNumbers with decimal support
+ * Functions     : bn_sub_abs, bn_subtract
+ * Input Params  : a, b   - Operands (never modified)
+ *                 result - Output number (may alias a or b)
+ * Return Value  : SUCCESS on successful operation, FAILURE otherwise
+ *
+ * Algorithm     : 1. Align decimal places by rescaling the operand with fewer fractional digits
+ *                 2. Subtract limb arrays from least to most significant limb with borrow
+ *                 3. Signed subtraction reduces to |a| - |b|, |b| - |a| or |a| + |b|
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/**
+ * |result| = |a| - |b|, requires |a| >= |b|
+ */
+int bn_sub_abs(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    BigNumber scratch, diff;
+    const BigNumber *x, *y;
+
+    bn_init(&scratch);
+    bn_init(&diff);
+
+    /* Step 1: Align decimal places */
+    STAT_PHASE_BEGIN(align_start);
+    if (bn_align_decimals(a, b, &scratch, &x, &y) == FAILURE)
+    {
+        bn_free(&scratch);
+        return FAILURE;
+    }
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
+    if (bn_reserve(&diff, x->length) == FAILURE)
+    {
+        bn_free(&scratch);
+        return FAILURE;
+    }
+
+    /* Step 2: Subtract with borrow (|x| >= |y| so no borrow escapes) */
+    STAT_PHASE_BEGIN(kernel_start);
+    limb_sub(diff.limbs, x->limbs, x->length, y->limbs, y->length);
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
+    STAT_PHASE_BEGIN(normalize_start);
+    diff.length = x->length;
+    diff.decimal_places = x->decimal_places;
+    bn_normalize(&diff);
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
+    bn_swap(result, &diff);
+    bn_free(&diff);
+    bn_free(&scratch);
+
+    return SUCCESS;
+}
+
+/**
+ * Signed subtraction: result = a - b
+ */
+int bn_subtract(const BigNumber *a, const BigNumber *b, BigNumber *result)
+{
+    if (a == NULL || b == NULL || result == NULL)
+    {
+        return FAILURE;
+    }
+
+    int a_negative = a->is_negative;
+    int b_negative = b->is_negative;
+    int negative;
+    int status;
+
+    STAT_OP_BEGIN(op_start);
+
+    /* Different signs: magnitudes add, result takes the sign of a */
+    if (a_negative != b_negative)
+    {
+        negative = a_negative;
+        status = bn_add_abs(a, b, result);
+    }
+    /* Same signs, |b| > |a|: result flips to the opposite sign of a */
+    else if (bn_compare_abs(a, b) == SECOND_LARGER)
+    {
+        negative = !a_negative;
+        status = bn_sub_abs(b, a, result);
+    }
+    else
+    {
+        negative = a_negative;
+        status = bn_sub_abs(a, b, result);
+    }
+
+    if (status == SUCCESS)
+    {
+        result->is_negative = negative;
+        bn_normalize(result);
+    }
+
+    STAT_OP_END(STAT_OP_SUB, op_start);
+    return status;
+}
@@ -27,6 +27,7 @@ ComparisonResult compare(int len1, int len2, Dlist *head1, Dlist *head2)
     }
 
     /* If lengths are equal, compare digit by digit from left to right */
+    STAT_ADD(list_traversals, 1);
     while (head1 != NULL && head2 != NULL)
     {
         if (head1->data > head2->data)
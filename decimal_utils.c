@@ -17,6 +17,7 @@ Dlist* find_decimal_point(Dlist *head)
         return NULL;
     }
 
+    STAT_ADD(list_traversals, 1);
     Dlist *temp = head;
     while (temp != NULL)
     {
@@ -106,7 +107,7 @@ void remove_leading_zeros(Dlist **head)
             (*head)->prev = NULL;
         }
         
-        free(temp);
+        node_free(temp);
     }
 }
 
@@ -132,7 +133,7 @@ void remove_trailing_zeros(Dlist **tail, Dlist *decimal_pos)
             (*tail)->next = NULL;
         }
         
-        free(temp);
+        node_free(temp);
     }
     
     /* If tail is now the decimal point, remove it too */
@@ -145,6 +146,6 @@ void remove_trailing_zeros(Dlist **tail, Dlist *decimal_pos)
             (*tail)->next = NULL;
         }
         
-        free(decimal_pos);
+        node_free(decimal_pos);
     }
 }
\ No newline at end of file
@@ -67,9 +67,6 @@
 
 #include "apc.h"
 
-/* Number of decimal places to compute after the decimal point */
-#define DIVISION_PRECISION 10
-
 /* ============================================================
  * PRIVATE HELPER FUNCTIONS (static = not visible outside file)
  * ============================================================ */
@@ -87,6 +84,7 @@ static int is_zero_list(Dlist *head)
         return TRUE;
     }
 
+    STAT_ADD(list_traversals, 1);
     Dlist *temp = head;
     while (temp != NULL)
     {
@@ -114,6 +112,7 @@ static int copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail)
     *dest_head = NULL;
     *dest_tail = NULL;
 
+    STAT_ADD(list_traversals, 1);
     Dlist *temp = src_head;
     while (temp != NULL)
     {
@@ -191,6 +190,7 @@ static int count_quotient_digit(Dlist **rem_head, Dlist **rem_tail,
     {
         /* Get current list lengths so compare() can work */
         int rem_len = 0, div_len = 0;
+        STAT_ADD(list_traversals, 2);
         Dlist *t = *rem_head;
         while (t != NULL) { rem_len++; t = t->next; }
         t = div_head;
@@ -248,8 +248,8 @@ static int count_quotient_digit(Dlist **rem_head, Dlist **rem_tail,
  * MAIN DIVISION FUNCTION
  * ============================================================ */
 
-int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
-             Dlist **headR, Dlist **tailR)
+static int divide_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                        Dlist **headR, Dlist **tailR)
 {
     /* ── Validate inputs ───────────────────────────────────────────── */
     if (head1 == NULL || tail1 == NULL || head2 == NULL || tail2 == NULL
@@ -270,6 +270,7 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
      *       pad op2 by 0: 2.75   -> remove dot ->  275
      *       now compute: 1350 / 275
      */
+    STAT_PHASE_BEGIN(align_start);
     int decimal1 = count_decimal_places(*head1);
     int decimal2 = count_decimal_places(*head2);
     int max_decimal = (decimal1 > decimal2) ? decimal1 : decimal2;
@@ -289,10 +290,14 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
+    STAT_PHASE_BEGIN(remove_dot_start);
     remove_dot(head1);
     remove_dot(head2);
 
     /* Re-sync tail pointers — list lengths changed after removing dots */
+    STAT_ADD(list_traversals, 2);
     Dlist *sync = *head1;
     while (sync != NULL && sync->next != NULL) { sync = sync->next; }
     *tail1 = sync;
@@ -309,6 +314,7 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     remove_leading_zeros(head2);
 
     /* Re-sync tails again after leading-zero removal */
+    STAT_ADD(list_traversals, 2);
     sync = *head1;
     while (sync != NULL && sync->next != NULL) { sync = sync->next; }
     *tail1 = sync;
@@ -317,14 +323,17 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     while (sync != NULL && sync->next != NULL) { sync = sync->next; }
     *tail2 = sync;
 
+    STAT_PHASE_END(STAT_PHASE_REMOVE_DOT, remove_dot_start);
+
     /* ── Step 2: Division by zero check ───────────────────────────── */
     if (is_zero_list(*head2))
     {
-        fprintf(stderr, "[ERROR]: Division by zero is undefined\n");
+        set_last_error("Division by zero is undefined");
         return FAILURE;
     }
 
     /* ── Steps 3 & 4: Long division ───────────────────────────────── */
+    STAT_PHASE_BEGIN(kernel_start);
 
     Dlist *rem_head = NULL;       /* Running remainder, starts empty   */
     Dlist *rem_tail = NULL;
@@ -412,7 +421,10 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     /* Free the final remainder */
     free_list(&rem_head);
 
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
     /* ── Step 5: Cleanup ───────────────────────────────────────────── */
+    STAT_PHASE_BEGIN(normalize_start);
     remove_leading_zeros(headR);
 
     if (decimal_inserted)
@@ -433,5 +445,19 @@ int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * Statistics builds time the whole operation around the long division
+ */
+int division(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+             Dlist **headR, Dlist **tailR)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = divide_lists(head1, tail1, head2, tail2, headR, tailR);
+    STAT_OP_END(STAT_OP_DIV, op_start);
+    return status;
+}
@@ -0,0 +1,37 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : error.c
+ * Description   : Thread-local "last error" message for the arithmetic operations
+ * Functions     : set_last_error, clear_last_error, last_error
+ *
+ * Operations report why they failed here instead of printing, so the caller decides where
+ * (and in which order) the message goes. This keeps perform_operation() silent and safe to
+ * call from several threads at once; each thread sees only its own message.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+static _Thread_local const char *error_message = NULL;
+
+/**
+ * Record why the current operation failed (message must be a string literal)
+ */
+void set_last_error(const char *message)
+{
+    error_message = message;
+}
+
+/**
+ * Forget the previous failure reason
+ */
+void clear_last_error(void)
+{
+    error_message = NULL;
+}
+
+/**
+ * Reason for the calling thread's last failure, or a generic message
+ */
+const char *last_error(void)
+{
+    return (error_message != NULL) ? error_message : "Operation failed";
+}
@@ -17,10 +17,11 @@ void free_list(Dlist **head)
     }
     
     /* Traverse the list and free each node */
+    STAT_ADD(list_traversals, 1);
     while (*head != NULL)
     {
         Dlist *temp = *head;
         *head = (*head)->next;
-        free(temp);
+        node_free(temp);
     }
 }
\ No newline at end of file
@@ -17,11 +17,11 @@ int insert_at_first(Dlist **head, int data)
         return FAILURE;
     }
 
-    /* Allocate memory for new node */
-    Dlist *new = malloc(sizeof(Dlist));
+    /* Take a node from the pool */
+    Dlist *new = node_alloc();
     if (new == NULL)
     {
-        fprintf(stderr, "[ERROR]: Memory allocation failed in insert_at_first\n");
+        set_last_error("Memory allocation failed");
         return FAILURE;
     }
 
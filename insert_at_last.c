@@ -18,11 +18,11 @@ int insert_at_last(Dlist **head, Dlist **tail, data_t data)
         return FAILURE;
     }
 
-    /* Allocate memory for new node */
-    Dlist *new = malloc(sizeof(Dlist));
+    /* Take a node from the pool */
+    Dlist *new = node_alloc();
     if (new == NULL)
     {
-        fprintf(stderr, "[ERROR]: Memory allocation failed in insert_at_last\n");
+        set_last_error("Memory allocation failed");
         return FAILURE;
     }
 
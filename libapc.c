@@ -0,0 +1,549 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : libapc.c
+ * Description   : Public library API over the internal BigNumber operations
+ * Functions     : apc_new, apc_from_string, apc_copy, apc_set_string, apc_free, apc_to_string,
+ *                 apc_string_free, apc_add, apc_sub, apc_mul, apc_square, apc_div, apc_mod,
+ *                 apc_divmod, apc_pow, apc_powmod, apc_sqrt, apc_isqrt, apc_root, apc_gcd, apc_lcm,
+ *                 apc_gcdext, apc_invmod, apc_save_file, apc_load_file, apc_map_file, apc_compare,
+ *                 apc_sign, apc_set_threads, apc_last_error, apc_stats_enabled, apc_stats_get,
+ *                 apc_stats_reset
+ *
+ * Design        : An apc_number is a heap-allocated wrapper around one BigNumber, so callers
+ *                 only ever see an opaque pointer and the representation can change without
+ *                 breaking them. Every entry point validates its handles, clears the thread's
+ *                 last error, and reports failures through it instead of printing.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+#include "libapc.h"
+
+struct apc_number {
+    BigNumber value;
+    BinaryMapping mapping;   /* base != NULL: value is a read-only view of a mapped file */
+};
+
+/* The public rounding constants mirror RoundingMode one to one */
+_Static_assert((int)APC_ROUND_TRUNCATE == (int)ROUND_TRUNCATE
+               && (int)APC_ROUND_HALF_EVEN == (int)ROUND_HALF_EVEN
+               && (int)APC_ROUND_HALF_UP == (int)ROUND_HALF_UP
+               && (int)APC_ROUND_FLOOR == (int)ROUND_FLOOR
+               && (int)APC_ROUND_CEIL == (int)ROUND_CEIL,
+               "apc_rounding must match RoundingMode");
+
+/* The public statistics indices mirror StatOp and StatPhase */
+_Static_assert((int)APC_STAT_OPS == (int)STAT_OP_COUNT && (int)APC_STAT_PHASES == (int)STAT_PHASE_COUNT
+               && (int)APC_STAT_DIV == (int)STAT_OP_DIV && (int)APC_STAT_GCD == (int)STAT_OP_GCD
+               && (int)APC_PHASE_NORMALIZE == (int)STAT_PHASE_NORMALIZE,
+               "apc_stats indices must match StatOp / StatPhase");
+
+/**
+ * @brief Check that every handle of an operation is present
+ */
+static int check_handles(const apc_number *result, const apc_number *a, const apc_number *b)
+{
+    clear_last_error();
+
+    if (result == NULL || a == NULL || b == NULL)
+    {
+        set_last_error("NULL number handle");
+        return FAILURE;
+    }
+
+    if (result->mapping.base != NULL)
+    {
+        set_last_error("Result is a read-only mapped number");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+apc_number *apc_new(void)
+{
+    clear_last_error();
+
+    apc_number *num = malloc(sizeof(apc_number));
+    if (num == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return NULL;
+    }
+
+    bn_init(&num->value);
+    num->mapping.base = NULL;
+    num->mapping.size = 0;
+    num->mapping.copy = NULL;
+    return num;
+}
+
+apc_number *apc_from_string(const char *text)
+{
+    apc_number *num = apc_new();
+    if (num == NULL)
+    {
+        return NULL;
+    }
+
+    if (apc_set_string(num, text) == APC_FAILURE)
+    {
+        apc_free(num);
+        return NULL;
+    }
+
+    return num;
+}
+
+apc_number *apc_copy(const apc_number *num)
+{
+    if (num == NULL)
+    {
+        set_last_error("NULL number handle");
+        return NULL;
+    }
+
+    apc_number *copy = apc_new();
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+
+    if (bn_copy(&copy->value, &num->value) == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+        apc_free(copy);
+        return NULL;
+    }
+
+    return copy;
+}
+
+int apc_set_string(apc_number *num, const char *text)
+{
+    clear_last_error();
+
+    if (num == NULL || text == NULL)
+    {
+        set_last_error("NULL argument");
+        return APC_FAILURE;
+    }
+
+    if (num->mapping.base != NULL)
+    {
+        set_last_error("Number is a read-only mapped number");
+        return APC_FAILURE;
+    }
+
+    /* Parse (and validate) into a temporary so a failure leaves the old value intact */
+    BigNumber parsed;
+    bn_init(&parsed);
+    if (bn_from_string(&parsed, text) == FAILURE)
+    {
+        bn_free(&parsed);
+        return APC_FAILURE;
+    }
+
+    bn_swap(&num->value, &parsed);
+    bn_free(&parsed);
+    return APC_SUCCESS;
+}
+
+void apc_free(apc_number *num)
+{
+    if (num == NULL)
+    {
+        return;
+    }
+
+    if (num->mapping.base != NULL)
+    {
+        bn_unmap_binary(&num->value, &num->mapping);
+    }
+    else
+    {
+        bn_free(&num->value);
+    }
+    free(num);
+}
+
+char *apc_to_string(const apc_number *num)
+{
+    clear_last_error();
+
+    if (num == NULL)
+    {
+        set_last_error("NULL number handle");
+        return NULL;
+    }
+
+    char *text = bn_to_string(&num->value);
+    if (text == NULL)
+    {
+        set_last_error("Memory allocation failed");
+    }
+
+    return text;
+}
+
+void apc_string_free(char *text)
+{
+    free(text);
+}
+
+int apc_add(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_add(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_sub(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_subtract(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_mul(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_multiply(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_square(apc_number *result, const apc_number *a)
+{
+    if (check_handles(result, a, a) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_square(&a->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_div(apc_number *result, const apc_number *a, const apc_number *b,
+            int precision, apc_rounding rounding)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (rounding < APC_ROUND_TRUNCATE || rounding > APC_ROUND_CEIL)
+    {
+        set_last_error("Invalid rounding mode");
+        return APC_FAILURE;
+    }
+
+    return (bn_divide(&a->value, &b->value, &result->value, precision, (RoundingMode)rounding) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_mod(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_mod(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_divmod(apc_number *quotient, apc_number *remainder, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(quotient, a, b) == FAILURE || check_handles(remainder, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (quotient == remainder)
+    {
+        set_last_error("Quotient and remainder must be different numbers");
+        return APC_FAILURE;
+    }
+
+    return (bn_divmod(&a->value, &b->value, &quotient->value, &remainder->value) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_pow(apc_number *result, const apc_number *base, const apc_number *exponent,
+            int precision, apc_rounding rounding)
+{
+    if (check_handles(result, base, exponent) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (rounding < APC_ROUND_TRUNCATE || rounding > APC_ROUND_CEIL)
+    {
+        set_last_error("Invalid rounding mode");
+        return APC_FAILURE;
+    }
+
+    return (bn_power(&base->value, &exponent->value, &result->value, precision, (RoundingMode)rounding) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_powmod(apc_number *result, const apc_number *base, const apc_number *exponent,
+               const apc_number *modulus)
+{
+    if (check_handles(result, base, exponent) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (modulus == NULL)
+    {
+        set_last_error("NULL number handle");
+        return APC_FAILURE;
+    }
+
+    return (bn_power_mod(&base->value, &exponent->value, &modulus->value, &result->value) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_sqrt(apc_number *result, const apc_number *a, int precision, apc_rounding rounding)
+{
+    if (check_handles(result, a, a) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (rounding < APC_ROUND_TRUNCATE || rounding > APC_ROUND_CEIL)
+    {
+        set_last_error("Invalid rounding mode");
+        return APC_FAILURE;
+    }
+
+    return (bn_sqrt(&a->value, &result->value, precision, (RoundingMode)rounding) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_isqrt(apc_number *result, const apc_number *a)
+{
+    if (check_handles(result, a, a) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_isqrt(&a->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_root(apc_number *result, const apc_number *a, const apc_number *degree,
+             int precision, apc_rounding rounding)
+{
+    if (check_handles(result, a, degree) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if (rounding < APC_ROUND_TRUNCATE || rounding > APC_ROUND_CEIL)
+    {
+        set_last_error("Invalid rounding mode");
+        return APC_FAILURE;
+    }
+
+    return (bn_root(&a->value, &degree->value, &result->value, precision, (RoundingMode)rounding) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_gcd(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_gcd(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_lcm(apc_number *result, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(result, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_lcm(&a->value, &b->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_gcdext(apc_number *g, apc_number *s, apc_number *t, const apc_number *a, const apc_number *b)
+{
+    if (check_handles(g, a, b) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    if ((s != NULL && s->mapping.base != NULL) || (t != NULL && t->mapping.base != NULL))
+    {
+        set_last_error("Result is a read-only mapped number");
+        return APC_FAILURE;
+    }
+
+    if (g == s || g == t || (s == t && s != NULL))
+    {
+        set_last_error("GCD and cofactors must be different numbers");
+        return APC_FAILURE;
+    }
+
+    return (bn_gcdext(&a->value, &b->value, &g->value, (s != NULL) ? &s->value : NULL,
+                      (t != NULL) ? &t->value : NULL) == SUCCESS)
+           ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_invmod(apc_number *result, const apc_number *a, const apc_number *m)
+{
+    if (check_handles(result, a, m) == FAILURE)
+    {
+        return APC_FAILURE;
+    }
+
+    return (bn_invmod(&a->value, &m->value, &result->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+int apc_save_file(const apc_number *num, const char *path)
+{
+    clear_last_error();
+
+    if (num == NULL || path == NULL)
+    {
+        set_last_error("NULL argument");
+        return APC_FAILURE;
+    }
+
+    return (bn_save_binary(path, &num->value) == SUCCESS) ? APC_SUCCESS : APC_FAILURE;
+}
+
+apc_number *apc_load_file(const char *path)
+{
+    if (path == NULL)
+    {
+        set_last_error("NULL argument");
+        return NULL;
+    }
+
+    apc_number *num = apc_new();
+    if (num == NULL)
+    {
+        return NULL;
+    }
+
+    if (bn_load_binary(path, &num->value) == FAILURE)
+    {
+        apc_free(num);
+        return NULL;
+    }
+
+    return num;
+}
+
+apc_number *apc_map_file(const char *path)
+{
+    if (path == NULL)
+    {
+        set_last_error("NULL argument");
+        return NULL;
+    }
+
+    apc_number *num = apc_new();
+    if (num == NULL)
+    {
+        return NULL;
+    }
+
+    if (bn_map_binary(path, &num->value, &num->mapping) == FAILURE)
+    {
+        free(num);
+        return NULL;
+    }
+
+    return num;
+}
+
+int apc_compare(const apc_number *a, const apc_number *b)
+{
+    if (a == NULL || b == NULL)
+    {
+        set_last_error("NULL number handle");
+        return 0;
+    }
+
+    switch (bn_compare(&a->value, &b->value))
+    {
+        case FIRST_LARGER:
+            return 1;
+
+        case SECOND_LARGER:
+            return -1;
+
+        default:
+            return 0;
+    }
+}
+
+int apc_sign(const apc_number *num)
+{
+    if (num == NULL || bn_is_zero(&num->value))
+    {
+        return 0;
+    }
+
+    return num->value.is_negative ? -1 : 1;
+}
+
+void apc_set_threads(int threads)
+{
+    set_parallel_threads(threads);
+}
+
+const char *apc_last_error(void)
+{
+    return last_error();
+}
+
+int apc_stats_enabled(void)
+{
+    return stats_enabled() ? 1 : 0;
+}
+
+void apc_stats_get(apc_stats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    OpStats current;
+    stats_get(&current);
+
+    stats->node_allocs = current.node_allocs;
+    stats->node_frees = current.node_frees;
+    stats->node_recycled = current.node_recycled;
+    stats->node_slabs = current.node_slabs;
+    stats->node_peak_live = current.node_peak_live;
+    stats->list_traversals = current.list_traversals;
+    stats->digit_ops = current.digit_ops;
+    stats->limb_ops = current.limb_ops;
+    for (int i = 0; i < APC_STAT_OPS; i++)
+    {
+        stats->op_calls[i] = current.op_calls[i];
+        stats->op_ns[i] = current.op_ns[i];
+    }
+    for (int i = 0; i < APC_STAT_PHASES; i++)
+    {
+        stats->phase_ns[i] = current.phase_ns[i];
+    }
+}
+
+void apc_stats_reset(void)
+{
+    stats_reset();
+}
@@ -0,0 +1,318 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : libapc.h
+ * Description   : Public API of the arbitrary precision arithmetic library (libapc.a / libapc.so)
+ *
+ * Ownership     : Every apc_number comes from apc_new / apc_from_string / apc_copy /
+ *                 apc_load_file / apc_map_file and must be released with apc_free. Strings
+ *                 returned by apc_to_string are owned by the caller and must be released with
+ *                 apc_string_free. Operations never take ownership of their arguments and
+ *                 never print; on failure they return APC_FAILURE and apc_last_error() (per
+ *                 thread) tells why.
+ *
+ * Aliasing      : The result of an operation may be one of its operands (apc_add(x, x, y)).
+ *
+ * Mapped files  : apc_map_file returns a read-only number whose digits stay in the mapped file.
+ *                 It can be an operand of any operation, copied, compared and formatted, but
+ *                 using it as a result or with apc_set_string fails.
+ *
+ * Threads       : Distinct numbers may be used from different threads concurrently. A number
+ *                 must not be written by one thread while another thread reads or writes it.
+ *                 Operations on very large numbers also spread their own work over a shared
+ *                 pool of threads (see apc_set_threads).
+ *******************************************************************************************************************************************************************/
+
+#ifndef LIBAPC_H
+#define LIBAPC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported symbols of the shared library (everything else stays hidden) */
+#if defined(__GNUC__)
+#define APC_API __attribute__((visibility("default")))
+#else
+#define APC_API
+#endif
+
+/* Return codes */
+#define APC_SUCCESS 0
+#define APC_FAILURE -1
+
+/* Default number of fractional digits for apc_div */
+#define APC_DEFAULT_PRECISION 10
+
+/* Opaque number handle: value = sign * digits * 10^-decimal_places */
+typedef struct apc_number apc_number;
+
+/* Rounding of the last digit produced by apc_div */
+typedef enum {
+    APC_ROUND_TRUNCATE = 0,   /* Toward zero */
+    APC_ROUND_HALF_EVEN,      /* To nearest, ties to even digit */
+    APC_ROUND_HALF_UP,        /* To nearest, ties away from zero */
+    APC_ROUND_FLOOR,          /* Toward negative infinity */
+    APC_ROUND_CEIL            /* Toward positive infinity */
+} apc_rounding;
+
+/* Operations and phases reported by apc_stats_get */
+enum {
+    APC_STAT_PARSE = 0,
+    APC_STAT_FORMAT,
+    APC_STAT_ADD,
+    APC_STAT_SUB,
+    APC_STAT_MUL,
+    APC_STAT_DIV,
+    APC_STAT_POW,             /* apc_pow, apc_powmod */
+    APC_STAT_MOD,             /* apc_mod, apc_divmod */
+    APC_STAT_ROOT,            /* apc_sqrt, apc_isqrt, apc_root */
+    APC_STAT_GCD,             /* apc_gcd, apc_gcdext, apc_lcm, apc_invmod */
+    APC_STAT_OPS
+};
+
+enum {
+    APC_PHASE_ALIGN = 0,
+    APC_PHASE_REMOVE_DOT,
+    APC_PHASE_KERNEL,
+    APC_PHASE_NORMALIZE,
+    APC_STAT_PHASES
+};
+
+/* Instrumentation counters of one thread (all zero unless the library was built with
+ * "make stats"); times are wall-clock nanoseconds of outermost operations */
+typedef struct {
+    unsigned long long node_allocs;
+    unsigned long long node_frees;
+    unsigned long long node_recycled;
+    unsigned long long node_slabs;
+    unsigned long long node_peak_live;
+    unsigned long long list_traversals;
+    unsigned long long digit_ops;
+    unsigned long long limb_ops;
+    unsigned long long op_calls[APC_STAT_OPS];
+    unsigned long long op_ns[APC_STAT_OPS];
+    unsigned long long phase_ns[APC_STAT_PHASES];
+} apc_stats;
+
+/**
+ * @brief Create a number with the value zero
+ * @return New handle, or NULL on memory error
+ */
+APC_API apc_number *apc_new(void);
+
+/**
+ * @brief Create a number from a decimal string such as "-123.45"
+ * @param text Optional '-', digits, optional '.' and fractional digits, or an optional '-' and
+ *             a "0x" hexadecimal integer
+ * @return New handle, or NULL if the text is invalid or memory runs out
+ */
+APC_API apc_number *apc_from_string(const char *text);
+
+/**
+ * @brief Create an independent copy of a number
+ * @return New handle, or NULL on memory error
+ */
+APC_API apc_number *apc_copy(const apc_number *num);
+
+/**
+ * @brief Replace the value of an existing number from a decimal string
+ * @return APC_SUCCESS, or APC_FAILURE if the text is invalid (value unchanged)
+ */
+APC_API int apc_set_string(apc_number *num, const char *text);
+
+/**
+ * @brief Release a number (NULL is ignored)
+ */
+APC_API void apc_free(apc_number *num);
+
+/**
+ * @brief Format a number in plain decimal notation (trailing fractional zeros removed)
+ * @return Newly allocated string to release with apc_string_free, or NULL on memory error
+ */
+APC_API char *apc_to_string(const apc_number *num);
+
+/**
+ * @brief Release a string returned by apc_to_string (NULL is ignored)
+ */
+APC_API void apc_string_free(char *text);
+
+/**
+ * @brief result = a + b
+ * @return APC_SUCCESS or APC_FAILURE
+ */
+APC_API int apc_add(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief result = a - b
+ * @return APC_SUCCESS or APC_FAILURE
+ */
+APC_API int apc_sub(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief result = a * b (exact)
+ * @return APC_SUCCESS or APC_FAILURE
+ */
+APC_API int apc_mul(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief result = a * a (exact), with the squaring kernels; apc_mul of equal values uses them too
+ * @return APC_SUCCESS or APC_FAILURE
+ */
+APC_API int apc_square(apc_number *result, const apc_number *a);
+
+/**
+ * @brief result = a / b with 'precision' fractional digits
+ * @param precision Fractional digits to compute (>= 0)
+ * @param rounding Rounding applied to the last digit
+ * @return APC_SUCCESS, or APC_FAILURE on division by zero, bad precision or memory error
+ */
+APC_API int apc_div(apc_number *result, const apc_number *a, const apc_number *b,
+                    int precision, apc_rounding rounding);
+
+/**
+ * @brief result = a % b: the remainder of the truncated division, a - trunc(a / b) * b, with
+ *        the sign of a. Repeated remainders by one long modulus reuse a cached reciprocal.
+ * @return APC_SUCCESS, or APC_FAILURE on division by zero or memory error
+ */
+APC_API int apc_mod(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief quotient = trunc(a / b) and remainder = a % b from one division
+ * @param quotient Output integer quotient (must not be the same handle as remainder)
+ * @return APC_SUCCESS, or APC_FAILURE on division by zero or memory error
+ */
+APC_API int apc_divmod(apc_number *quotient, apc_number *remainder, const apc_number *a,
+                       const apc_number *b);
+
+/**
+ * @brief result = base ^ exponent for an integer exponent; exact for exponent >= 0, otherwise
+ *        1 / base^|exponent| with 'precision' fractional digits
+ * @param precision Fractional digits of a negative power (>= 0)
+ * @param rounding Rounding applied to the last digit of a negative power
+ * @return APC_SUCCESS, or APC_FAILURE on a fractional exponent, 0 ^ negative, an oversized
+ *         result or memory error
+ */
+APC_API int apc_pow(apc_number *result, const apc_number *base, const apc_number *exponent,
+                    int precision, apc_rounding rounding);
+
+/**
+ * @brief result = base ^ exponent mod modulus, in [0, modulus), for integers with
+ *        exponent >= 0 and modulus > 0
+ * @return APC_SUCCESS, or APC_FAILURE on a bad operand or memory error
+ */
+APC_API int apc_powmod(apc_number *result, const apc_number *base, const apc_number *exponent,
+                       const apc_number *modulus);
+
+/**
+ * @brief result = sqrt(a) with 'precision' fractional digits, rounded exactly as 'rounding'
+ * @return APC_SUCCESS, or APC_FAILURE on a negative a or memory error
+ */
+APC_API int apc_sqrt(apc_number *result, const apc_number *a, int precision, apc_rounding rounding);
+
+/**
+ * @brief result = floor(sqrt(a))
+ * @return APC_SUCCESS, or APC_FAILURE on a negative a or memory error
+ */
+APC_API int apc_isqrt(apc_number *result, const apc_number *a);
+
+/**
+ * @brief result = a^(1/degree) with 'precision' fractional digits, rounded exactly as
+ *        'rounding'; a negative a has the real root of an odd degree
+ * @param degree Integer from 2 to 1000000
+ * @return APC_SUCCESS, or APC_FAILURE on a bad degree, an even root of a negative number or
+ *         memory error
+ */
+APC_API int apc_root(apc_number *result, const apc_number *a, const apc_number *degree,
+                     int precision, apc_rounding rounding);
+
+/**
+ * @brief result = gcd(a, b) >= 0 of two integers
+ * @return APC_SUCCESS, or APC_FAILURE on a fractional operand or memory error
+ */
+APC_API int apc_gcd(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief result = lcm(a, b) >= 0 of two integers (0 if either is 0)
+ * @return APC_SUCCESS, or APC_FAILURE on a fractional operand or memory error
+ */
+APC_API int apc_lcm(apc_number *result, const apc_number *a, const apc_number *b);
+
+/**
+ * @brief g = gcd(a, b) = a * s + b * t for two integers, with |s| <= |b| / 2g when b != 0
+ * @param s Output cofactor of a, or NULL
+ * @param t Output cofactor of b, or NULL (g, s and t must be different handles)
+ * @return APC_SUCCESS, or APC_FAILURE on a fractional operand or memory error
+ */
+APC_API int apc_gcdext(apc_number *g, apc_number *s, apc_number *t, const apc_number *a,
+                       const apc_number *b);
+
+/**
+ * @brief result = a^-1 mod m, in [0, m), for integers with m > 0 and gcd(a, m) = 1
+ * @return APC_SUCCESS, or APC_FAILURE on a bad operand, no inverse or memory error
+ */
+APC_API int apc_invmod(apc_number *result, const apc_number *a, const apc_number *m);
+
+/**
+ * @brief Write a number to a binary number file (header with sign, scale, limb count, byte
+ *        order and checksum, then the raw digits)
+ * @return APC_SUCCESS, or APC_FAILURE on an I/O error
+ */
+APC_API int apc_save_file(const apc_number *num, const char *path);
+
+/**
+ * @brief Read a binary number file into a new, writable number
+ * @return New handle, or NULL on an I/O, format or checksum error
+ */
+APC_API apc_number *apc_load_file(const char *path);
+
+/**
+ * @brief Memory-map a binary number file as a new read-only number (no copy, no parse)
+ * @return New handle, or NULL on an I/O, format or checksum error
+ */
+APC_API apc_number *apc_map_file(const char *path);
+
+/**
+ * @brief Signed comparison
+ * @return -1 if a < b, 0 if a == b, 1 if a > b
+ */
+APC_API int apc_compare(const apc_number *a, const apc_number *b);
+
+/**
+ * @brief Sign of a number
+ * @return -1, 0 or 1
+ */
+APC_API int apc_sign(const apc_number *num);
+
+/**
+ * @brief Threads one operation may use on very large numbers (products of a few thousand
+ *        digits and up, additions and subtractions of hundreds of thousands); call before the
+ *        first such operation
+ * @param threads Thread count, the calling thread included (0 = every online processor)
+ */
+APC_API void apc_set_threads(int threads);
+
+/**
+ * @brief Reason for the calling thread's last failed apc_* call
+ */
+APC_API const char *apc_last_error(void);
+
+/**
+ * @brief Whether the library was built with instrumentation ("make stats")
+ * @return 1 if the counters are live, 0 if they always read zero
+ */
+APC_API int apc_stats_enabled(void);
+
+/**
+ * @brief Counters accumulated by the calling thread since its last apc_stats_reset
+ */
+APC_API void apc_stats_get(apc_stats *stats);
+
+/**
+ * @brief Zero the calling thread's counters
+ */
+APC_API void apc_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBAPC_H */
@@ -0,0 +1,264 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : limb_div.c
+ * Description   : Size-dispatched division of base-10^9 limb arrays
+ * Function      : limb_div
+ *
+ * Algorithm     : Small divisors or short quotients use Knuth Algorithm D (limb_divmod),
+ *                 whose cost is O(quotient length * divisor length). When both the divisor and
+ *                 the quotient have at least thresholds()->newton_div limbs the quotient is taken
+ *                 from a Newton-Raphson reciprocal instead, so the whole division costs a small
+ *                 constant number of multiplications (and inherits Toom-3 / NTT speed).
+ *
+ *   Reciprocal  : For an n-limb divisor D with top limb >= B/2, reciprocal() returns
+ *                 X ~ B^(2n) / D. It recurses on the top h = n/2 + 1 limbs of D and refines
+ *                 with one Newton step at full precision:
+ *
+ *                     X0 = Xh * B^(n - h)
+ *                     X1 = X0 + X0 * (B^(2n) - D * X0) / B^(2n)
+ *
+ *                 Each step doubles the number of correct limbs; the extra limb in h keeps the
+ *                 error of every level within a few units.
+ *
+ *   Quotient    : q0 = (top limbs of a) * X / B^k is within a few units of the true quotient.
+ *                 The exact quotient and remainder follow from r = a - q0 * b and a handful of
+ *                 +/- b correction steps.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Reciprocals of at most this many limbs are computed directly with Knuth D */
+#define RECIPROCAL_BASECASE 32
+
+/**
+ * @brief X ~ B^(2n) / D for an n-limb divisor whose top limb is at least B/2.
+ * @param x Output with room for n + 2 limbs (zero filled above the value)
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+static int reciprocal(limb_t *x, const limb_t *d, size_t n)
+{
+    /* Base case: exact floor(B^(2n) / D) by long division */
+    if (n <= RECIPROCAL_BASECASE)
+    {
+        limb_t *power = calloc(2 * n + 1, sizeof(limb_t));
+        if (power == NULL)
+        {
+            set_last_error("Memory allocation failed");
+            return FAILURE;
+        }
+        power[2 * n] = 1;
+        int status = limb_divmod(x, NULL, power, 2 * n + 1, d, n);
+        free(power);
+        return status;
+    }
+
+    /* Recurse on the top h limbs of D (one limb of slack over n/2) */
+    size_t h = n / 2 + 1;
+    size_t xh_len = h + 2;
+    size_t dx_len = n + xh_len;
+
+    /* Scratch: Xh (h + 2), D * Xh (n + h + 2), E (n + h + 2), Xh * E (2n + 2h + 4) */
+    limb_t *scratch = calloc(xh_len + 2 * dx_len + xh_len + dx_len, sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *xh = scratch;
+    limb_t *dx = xh + xh_len;
+    limb_t *err = dx + dx_len;
+    limb_t *corr = err + dx_len;
+
+    if (reciprocal(xh, d + (n - h), h) == FAILURE
+        || limb_mul(dx, d, n, xh, xh_len) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+
+    /* E' = B^(n + h) - D * Xh, kept as magnitude plus sign */
+    size_t dx_used = limb_trimmed_length(dx, dx_len);
+    int err_negative;
+    memset(err, 0, dx_len * sizeof(limb_t));
+    err[n + h] = 1;
+    if (limb_compare(dx, dx_used, err, n + h + 1) == FIRST_LARGER)
+    {
+        err_negative = TRUE;
+        limb_sub(err, dx, dx_used, err, n + h + 1);
+    }
+    else
+    {
+        err_negative = FALSE;
+        limb_sub(err, err, n + h + 1, dx, dx_used);
+    }
+    size_t err_len = limb_trimmed_length(err, dx_len);
+
+    /* X1 = Xh * B^(n - h) +/- Xh * E' / B^(2h) */
+    memset(x, 0, (n + 2) * sizeof(limb_t));
+    memcpy(x + (n - h), xh, (h + 2) * sizeof(limb_t));
+
+    if (err_len > 0)
+    {
+        if (limb_mul(corr, xh, xh_len, err, err_len) == FAILURE)
+        {
+            free(scratch);
+            return FAILURE;
+        }
+
+        size_t corr_len = xh_len + err_len;
+        if (corr_len > 2 * h)
+        {
+            const limb_t *shifted = corr + 2 * h;
+            size_t shifted_len = limb_trimmed_length(shifted, corr_len - 2 * h);
+            if (shifted_len > 0)
+            {
+                if (err_negative)
+                {
+                    limb_sub(x, x, n + 2, shifted, shifted_len);
+                }
+                else
+                {
+                    limb_add(x, x, n + 2, shifted, shifted_len);
+                }
+            }
+        }
+    }
+
+    free(scratch);
+    return SUCCESS;
+}
+
+/**
+ * @brief Quotient and remainder via Newton reciprocal, na >= nb >= 2
+ */
+static int newton_divmod(limb_t *q, limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    size_t qn = na - nb + 1;
+    size_t p = qn + 1;
+
+    /* Normalize so the divisor's top limb is at least B/2 (quotient unchanged) */
+    limb_t scale = (limb_t)(LIMB_BASE / ((uint64_t)b[nb - 1] + 1));
+
+    size_t an_len = na + 1;
+    size_t x_len = p + 2;
+    size_t q0_cap = (p + 1) + x_len;
+    size_t work_len = (na > qn + 2 + nb ? na : qn + 2 + nb) + 1;
+
+    /* Scratch: a' (na + 1), b' (nb), Dp (p), X (p + 2), a'_top * X, q0 * b, remainder */
+    limb_t *scratch = calloc(an_len + nb + p + x_len + q0_cap + 2 * work_len, sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *an = scratch;
+    limb_t *bn = an + an_len;
+    limb_t *dp = bn + nb;
+    limb_t *x = dp + p;
+    limb_t *prod = x + x_len;
+    limb_t *qb = prod + q0_cap;
+    limb_t *rem = qb + work_len;
+
+    an[na] = limb_mul_small(an, a, na, scale);
+    limb_mul_small(bn, b, nb, scale);
+
+    /* Dp = top p limbs of b' (or b' padded with zero limbs when shorter) */
+    if (nb >= p)
+    {
+        memcpy(dp, bn + (nb - p), p * sizeof(limb_t));
+    }
+    else
+    {
+        memcpy(dp + (p - nb), bn, nb * sizeof(limb_t));
+    }
+
+    if (reciprocal(x, dp, p) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+
+    /* q0 = (top p + 1 limbs of a') * X / B^(p + 2) */
+    if (limb_mul(prod, an + (nb - 2), p + 1, x, x_len) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+    limb_t *q0 = prod + (p + 2);
+    size_t q0_len = limb_trimmed_length(q0, q0_cap - (p + 2));
+
+    /* r = a - q0 * b, then step q0 until 0 <= r < b */
+    size_t qb_len = 0;
+    if (q0_len > 0)
+    {
+        if (limb_mul(qb, q0, q0_len, b, nb) == FAILURE)
+        {
+            free(scratch);
+            return FAILURE;
+        }
+        qb_len = limb_trimmed_length(qb, q0_len + nb);
+    }
+
+    size_t a_len = limb_trimmed_length(a, na);
+    memset(rem, 0, work_len * sizeof(limb_t));
+
+    if (limb_compare(qb, qb_len, a, a_len) == FIRST_LARGER)
+    {
+        /* Estimate too large: deficit = q0 * b - a, remove one b per step */
+        limb_sub(rem, qb, qb_len, a, a_len);
+        size_t def_len = limb_trimmed_length(rem, qb_len);
+        while (def_len > 0)
+        {
+            limb_decrement(q0, q0_len);
+            if (limb_compare(rem, def_len, b, nb) == SECOND_LARGER)
+            {
+                /* Final remainder is b - deficit */
+                limb_sub(rem, b, nb, rem, def_len);
+                break;
+            }
+            limb_sub(rem, rem, def_len, b, nb);
+            def_len = limb_trimmed_length(rem, def_len);
+        }
+    }
+    else
+    {
+        /* Estimate too small (or exact): add one to q0 per extra b in r */
+        memcpy(rem, a, a_len * sizeof(limb_t));
+        limb_sub(rem, rem, a_len, qb, qb_len);
+        size_t rem_len = limb_trimmed_length(rem, a_len);
+        while (limb_compare(rem, rem_len, b, nb) != SECOND_LARGER)
+        {
+            limb_sub(rem, rem, rem_len, b, nb);
+            rem_len = limb_trimmed_length(rem, rem_len);
+            limb_increment(q0, q0_cap - (p + 2));
+        }
+    }
+
+    if (q != NULL)
+    {
+        memcpy(q, q0, qn * sizeof(limb_t));
+    }
+    if (r != NULL)
+    {
+        memcpy(r, rem, nb * sizeof(limb_t));
+    }
+
+    free(scratch);
+    return SUCCESS;
+}
+
+/**
+ * Quotient and remainder with the fastest algorithm for the operand sizes
+ */
+int limb_div(limb_t *q, limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    size_t qn = na - nb + 1;
+
+    size_t newton_div = thresholds()->newton_div;
+
+    if (nb >= newton_div && qn >= newton_div)
+    {
+        return newton_divmod(q, r, a, na, b, nb);
+    }
+
+    return limb_divmod(q, r, a, na, b, nb);
+}
@@ -0,0 +1,569 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : limb_mul.c
+ * Description   : Size-dispatched multiplication of base-10^9 limb arrays
+ * Functions     : limb_mul, limb_sqr
+ *
+ * Algorithm     : Operands are routed by the length of the shorter one (in limbs), compared
+ *                 with the runtime thresholds (thresholds.c, tuned by calculator --tune):
+ *
+ *                   nb <  karatsuba   -> schoolbook (limb_mul_schoolbook)
+ *                   nb >= ntt         -> three-prime NTT (limb_mul_ntt, ntt.c)
+ *                   nb >= toom3       -> Toom-3      (5 products of 1/3 size)
+ *                   otherwise         -> Karatsuba   (3 products of 1/2 size)
+ *
+ *                 Very unbalanced operands (na much larger than nb) are cut into nb-sized
+ *                 slices of a, each multiplied as a balanced product and accumulated.
+ *
+ *   Karatsuba   : a = a1*B^m + a0, b = b1*B^m + b0
+ *                 a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0
+ *                 with z0 = a0*b0, z2 = a1*b1, z1 = (a0 + a1)(b0 + b1)
+ *
+ *   Toom-3      : a = a2*x^2 + a1*x + a0 with x = B^k (same for b). The product polynomial is
+ *                 evaluated at 0, 1, -1, -2 and infinity and interpolated with Bodrato's
+ *                 sequence; evaluation at -1 and -2 needs signed temporaries (SignedLimbs).
+ *
+ *   Squaring    : limb_mul(r, a, n, a, n) - the same array twice - goes to limb_sqr, which uses
+ *                 the same dispatch with every kernel's square variant: schoolbook computes each
+ *                 cross product once, Karatsuba and Toom-3 evaluate only one operand so their
+ *                 sub-products are squares again, and the NTT transforms once per prime.
+ *
+ *   Threads     : From thresholds()->parallel_mul limbs on, the independent sub-products (3 for
+ *                 Karatsuba, 5 for Toom-3, one per slice of an unbalanced product) run through
+ *                 parallel_for; the recursion below them then stays on its thread. Where the
+ *                 sub-products reach the NTT and are fewer than the threads, they run one after
+ *                 the other so each NTT can use every thread instead (ntt.c).
+ *
+ *   Cross-check : Compiling with -DAPC_MUL_CROSSCHECK (make crosscheck) recomputes every NTT
+ *                 product with schoolbook multiplication and fails loudly on any mismatch.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Signed magnitude over a caller-provided limb buffer (Toom-3 temporaries) */
+typedef struct {
+    limb_t *d;
+    size_t n;
+    int neg;
+} SignedLimbs;
+
+/* One sub-product r = a * b, run by run_products */
+typedef struct {
+    limb_t *r;
+    const limb_t *a;
+    size_t na;
+    const limb_t *b;
+    size_t nb;
+    int status;
+    const char *error;          /* last_error of the thread that ran a failed product */
+} MulTask;
+
+/**
+ * @brief r[offset ..] += x, propagating the carry up to rlen limbs
+ */
+static void add_into(limb_t *r, size_t rlen, size_t offset, const limb_t *x, size_t xn)
+{
+    xn = limb_trimmed_length(x, xn);
+    if (xn == 0)
+    {
+        return;
+    }
+
+    limb_t carry = limb_add(r + offset, r + offset, xn, x, xn);
+    for (size_t i = offset + xn; carry != 0 && i < rlen; i++)
+    {
+        r[i] += 1;
+        carry = (r[i] == LIMB_BASE);
+        if (carry)
+        {
+            r[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief z = x + y for signed values (z may alias x or y; z needs max(n) + 1 limbs)
+ */
+static void signed_add(SignedLimbs *z, const SignedLimbs *x, const SignedLimbs *y)
+{
+    const SignedLimbs *big = x, *small = y;
+
+    if (x->neg == y->neg)
+    {
+        if (big->n < small->n)
+        {
+            big = y;
+            small = x;
+        }
+        size_t n = big->n;
+        int neg = x->neg;
+        limb_t carry = limb_add(z->d, big->d, n, small->d, small->n);
+        z->d[n] = carry;
+        z->n = limb_trimmed_length(z->d, n + 1);
+        z->neg = (z->n > 0) ? neg : FALSE;
+        return;
+    }
+
+    /* Opposite signs: subtract the smaller magnitude from the larger */
+    if (limb_compare(x->d, x->n, y->d, y->n) == SECOND_LARGER)
+    {
+        big = y;
+        small = x;
+    }
+    int neg = big->neg;
+    limb_sub(z->d, big->d, big->n, small->d, small->n);
+    z->n = limb_trimmed_length(z->d, big->n);
+    z->neg = (z->n > 0) ? neg : FALSE;
+}
+
+/**
+ * @brief z = x - y for signed values
+ */
+static void signed_sub(SignedLimbs *z, const SignedLimbs *x, const SignedLimbs *y)
+{
+    SignedLimbs negated = *y;
+    negated.neg = (y->n > 0) ? !y->neg : FALSE;
+    signed_add(z, x, &negated);
+}
+
+/**
+ * @brief x = x / divisor, exact division by a small constant (2 or 3)
+ */
+static void signed_div_exact(SignedLimbs *x, limb_t divisor)
+{
+    limb_div_small(x->d, x->d, x->n, divisor);
+    x->n = limb_trimmed_length(x->d, x->n);
+    if (x->n == 0)
+    {
+        x->neg = FALSE;
+    }
+}
+
+/**
+ * @brief x = x * factor for a small constant factor
+ */
+static void signed_mul_small(SignedLimbs *x, limb_t factor)
+{
+    limb_t carry = limb_mul_small(x->d, x->d, x->n, factor);
+    if (carry != 0)
+    {
+        x->d[x->n++] = carry;
+    }
+}
+
+/**
+ * @brief parallel_for body: compute one sub-product (an empty operand leaves r untouched)
+ */
+static void mul_task(void *raw, size_t index)
+{
+    MulTask *task = (MulTask *)raw + index;
+
+    task->status = SUCCESS;
+    if (task->na > 0 && task->nb > 0)
+    {
+        task->status = limb_mul(task->r, task->a, task->na, task->b, task->nb);
+    }
+    if (task->status == FAILURE)
+    {
+        task->error = last_error();
+    }
+}
+
+/**
+ * @brief Compute independent sub-products of a product whose shorter operand has nb limbs,
+ *        in parallel when that pays off
+ * @return SUCCESS if every sub-product succeeded, FAILURE otherwise
+ */
+static int run_products(MulTask *tasks, size_t count, size_t nb)
+{
+    const Thresholds *limits = thresholds();
+    size_t threads = (size_t)parallel_threads();
+
+    if (threads > 1 && nb >= limits->parallel_mul && (nb < limits->ntt || count >= threads))
+    {
+        parallel_for(count, mul_task, tasks);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            mul_task(tasks, i);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tasks[i].status == FAILURE)
+        {
+            /* The reason was recorded on the thread that ran the product */
+            set_last_error(tasks[i].error);
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Karatsuba step, requires na >= nb > (na + 1) / 2
+ */
+static int karatsuba(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    size_t m = (na + 1) / 2;
+    size_t a1_len = na - m;
+    size_t b1_len = nb - m;
+
+    /* Scratch: sa, sb (m + 1 each) and z1 (2m + 2) */
+    limb_t *scratch = malloc((4 * m + 4) * sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *sa = scratch;
+    limb_t *sb = sa + m + 1;
+    limb_t *z1 = sb + m + 1;
+
+    /* sa = a0 + a1, sb = b0 + b1 (a square evaluates once: every sub-product is a square) */
+    sa[m] = limb_add(sa, a, m, a + m, a1_len);
+    if (a == b && na == nb)
+    {
+        sb = sa;
+    }
+    else
+    {
+        sb[m] = limb_add(sb, b, m, b + m, b1_len);
+    }
+
+    /* z0 and z2 land directly in their final position in r */
+    MulTask products[3] = {
+        { r, a, m, b, m, SUCCESS, NULL },
+        { r + 2 * m, a + m, a1_len, b + m, b1_len, SUCCESS, NULL },
+        { z1, sa, m + 1, sb, m + 1, SUCCESS, NULL }
+    };
+    if (run_products(products, 3, nb) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+
+    /* z1 = z1 - z0 - z2 (never negative) */
+    limb_sub(z1, z1, 2 * m + 2, r, 2 * m);
+    limb_sub(z1, z1, 2 * m + 2, r + 2 * m, a1_len + b1_len);
+
+    add_into(r, na + nb, m, z1, 2 * m + 2);
+
+    free(scratch);
+    return SUCCESS;
+}
+
+/**
+ * @brief Toom-3 step, requires na >= nb > 2 * ceil(na / 3)
+ */
+static int toom3(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    size_t k = (na + 2) / 3;
+    size_t a2_len = na - 2 * k;
+    size_t b2_len = nb - 2 * k;
+
+    /* Every temporary fits in 2k + 4 limbs (evaluations use k + 2, products 2k + 4) */
+    size_t slot = 2 * k + 4;
+    limb_t *scratch = calloc(13 * slot, sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    SignedLimbs a0 = { (limb_t *)a, limb_trimmed_length(a, k), FALSE };
+    SignedLimbs a1 = { (limb_t *)a + k, limb_trimmed_length(a + k, k), FALSE };
+    SignedLimbs a2 = { (limb_t *)a + 2 * k, limb_trimmed_length(a + 2 * k, a2_len), FALSE };
+    SignedLimbs b0 = { (limb_t *)b, limb_trimmed_length(b, k), FALSE };
+    SignedLimbs b1 = { (limb_t *)b + k, limb_trimmed_length(b + k, k), FALSE };
+    SignedLimbs b2 = { (limb_t *)b + 2 * k, limb_trimmed_length(b + 2 * k, b2_len), FALSE };
+
+    SignedLimbs ea1 = { scratch + 0 * slot, 0, FALSE };    /* a(1)  */
+    SignedLimbs eam1 = { scratch + 1 * slot, 0, FALSE };   /* a(-1) */
+    SignedLimbs eam2 = { scratch + 2 * slot, 0, FALSE };   /* a(-2) */
+    SignedLimbs eb1 = { scratch + 3 * slot, 0, FALSE };
+    SignedLimbs ebm1 = { scratch + 4 * slot, 0, FALSE };
+    SignedLimbs ebm2 = { scratch + 5 * slot, 0, FALSE };
+    SignedLimbs r0 = { scratch + 6 * slot, 0, FALSE };
+    SignedLimbs r1 = { scratch + 7 * slot, 0, FALSE };
+    SignedLimbs rm1 = { scratch + 8 * slot, 0, FALSE };
+    SignedLimbs rm2 = { scratch + 9 * slot, 0, FALSE };
+    SignedLimbs rinf = { scratch + 10 * slot, 0, FALSE };
+    SignedLimbs r2 = { scratch + 11 * slot, 0, FALSE };
+    SignedLimbs r3 = { scratch + 12 * slot, 0, FALSE };
+
+    /* Evaluation: p = x0 + x2, x(1) = p + x1, x(-1) = p - x1, x(-2) = 2(x(-1) + x2) - x0 */
+    signed_add(&ea1, &a0, &a2);
+    signed_sub(&eam1, &ea1, &a1);
+    signed_add(&ea1, &ea1, &a1);
+    signed_add(&eam2, &eam1, &a2);
+    signed_mul_small(&eam2, 2);
+    signed_sub(&eam2, &eam2, &a0);
+
+    /* A square evaluates once, so every pointwise product is a square again */
+    if (a == b && na == nb)
+    {
+        eb1 = ea1;
+        ebm1 = eam1;
+        ebm2 = eam2;
+    }
+    else
+    {
+        signed_add(&eb1, &b0, &b2);
+        signed_sub(&ebm1, &eb1, &b1);
+        signed_add(&eb1, &eb1, &b1);
+        signed_add(&ebm2, &ebm1, &b2);
+        signed_mul_small(&ebm2, 2);
+        signed_sub(&ebm2, &ebm2, &b0);
+    }
+
+    /* Pointwise products (zero-length operands give a zero product) */
+    struct { SignedLimbs *out; const SignedLimbs *x; const SignedLimbs *y; } products[5] = {
+        { &r0, &a0, &b0 }, { &r1, &ea1, &eb1 }, { &rm1, &eam1, &ebm1 },
+        { &rm2, &eam2, &ebm2 }, { &rinf, &a2, &b2 }
+    };
+    MulTask tasks[5];
+
+    for (int i = 0; i < 5; i++)
+    {
+        tasks[i] = (MulTask){ products[i].out->d, products[i].x->d, products[i].x->n,
+                              products[i].y->d, products[i].y->n, SUCCESS, NULL };
+    }
+    if (run_products(tasks, 5, nb) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        SignedLimbs *out = products[i].out;
+        const SignedLimbs *x = products[i].x;
+        const SignedLimbs *y = products[i].y;
+
+        out->n = (x->n > 0 && y->n > 0) ? limb_trimmed_length(out->d, x->n + y->n) : 0;
+        out->neg = (out->n > 0) ? (x->neg != y->neg) : FALSE;
+    }
+
+    /* Interpolation (Bodrato) */
+    signed_sub(&r3, &rm2, &r1);       /* r3 = (rm2 - r1) / 3          */
+    signed_div_exact(&r3, 3);
+    signed_sub(&r1, &r1, &rm1);       /* r1 = (r1 - rm1) / 2          */
+    signed_div_exact(&r1, 2);
+    signed_sub(&r2, &rm1, &r0);       /* r2 = rm1 - r0                */
+    signed_sub(&r3, &r2, &r3);        /* r3 = (r2 - r3) / 2 + 2 rinf  */
+    signed_div_exact(&r3, 2);
+    signed_add(&r3, &r3, &rinf);
+    signed_add(&r3, &r3, &rinf);
+    signed_add(&r2, &r2, &r1);        /* r2 = r2 + r1 - rinf          */
+    signed_sub(&r2, &r2, &rinf);
+    signed_sub(&r1, &r1, &r3);        /* r1 = r1 - r3                 */
+
+    /* Recomposition: all coefficients are now non-negative */
+    memset(r, 0, (na + nb) * sizeof(limb_t));
+    memcpy(r, r0.d, r0.n * sizeof(limb_t));
+    if (rinf.n > 0)
+    {
+        memcpy(r + 4 * k, rinf.d, rinf.n * sizeof(limb_t));
+    }
+    add_into(r, na + nb, k, r1.d, r1.n);
+    add_into(r, na + nb, 2 * k, r2.d, r2.n);
+    add_into(r, na + nb, 3 * k, r3.d, r3.n);
+
+    free(scratch);
+    return SUCCESS;
+}
+
+/**
+ * @brief mul_unbalanced with the slice products computed in parallel: the product of slice i
+ *        fills limbs [i nb, (i + 2) nb), so the even slices go straight into r and the odd
+ *        ones into a second buffer without overlapping, and one addition joins the two
+ */
+static int mul_unbalanced_parallel(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb,
+                                   size_t slices)
+{
+    limb_t *odd = calloc(na + nb, sizeof(limb_t));
+    MulTask *tasks = malloc(slices * sizeof(MulTask));
+    if (odd == NULL || tasks == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        free(odd);
+        free(tasks);
+        return FAILURE;
+    }
+
+    memset(r, 0, (na + nb) * sizeof(limb_t));
+
+    for (size_t i = 0; i < slices; i++)
+    {
+        size_t offset = i * nb;
+        size_t len = (na - offset < nb) ? na - offset : nb;
+        tasks[i] = (MulTask){ ((i % 2 == 0) ? r : odd) + offset, a + offset, len, b, nb, SUCCESS, NULL };
+    }
+
+    int status = run_products(tasks, slices, nb);
+    if (status == SUCCESS)
+    {
+        limb_add(r, r, na + nb, odd, na + nb);
+    }
+
+    free(odd);
+    free(tasks);
+    return status;
+}
+
+/**
+ * @brief Multiply a long operand by a much shorter one, slice by slice
+ */
+static int mul_unbalanced(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    const Thresholds *limits = thresholds();
+    size_t slices = (na + nb - 1) / nb;
+
+    if (parallel_threads() > 1 && nb >= limits->parallel_mul)
+    {
+        return mul_unbalanced_parallel(r, a, na, b, nb, slices);
+    }
+
+    limb_t *piece = malloc(2 * nb * sizeof(limb_t));
+    if (piece == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    memset(r, 0, (na + nb) * sizeof(limb_t));
+
+    for (size_t offset = 0; offset < na; offset += nb)
+    {
+        size_t len = (na - offset < nb) ? na - offset : nb;
+        if (limb_mul(piece, a + offset, len, b, nb) == FAILURE)
+        {
+            free(piece);
+            return FAILURE;
+        }
+        add_into(r, na + nb, offset, piece, len + nb);
+    }
+
+    free(piece);
+    return SUCCESS;
+}
+
+#ifdef APC_MUL_CROSSCHECK
+/**
+ * @brief Verify a fast product against schoolbook multiplication
+ * @return SUCCESS if both agree, FAILURE on mismatch or memory error
+ */
+static int crosscheck_product(const limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    limb_t *expected = malloc((na + nb) * sizeof(limb_t));
+    if (expected == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    limb_mul_schoolbook(expected, a, na, b, nb);
+    int match = (memcmp(expected, r, (na + nb) * sizeof(limb_t)) == 0);
+    free(expected);
+
+    if (!match)
+    {
+        set_last_error("NTT product mismatch");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+#endif
+
+/**
+ * r = a * b with the fastest kernel for the operand sizes
+ */
+int limb_mul(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    /* Keep the longer operand first */
+    if (na < nb)
+    {
+        const limb_t *temp = a;
+        a = b;
+        b = temp;
+        size_t temp_len = na;
+        na = nb;
+        nb = temp_len;
+    }
+
+    if (a == b && na == nb)
+    {
+        return limb_sqr(r, a, na);
+    }
+
+    const Thresholds *limits = thresholds();
+
+    if (nb < limits->karatsuba)
+    {
+        limb_mul_schoolbook(r, a, na, b, nb);
+        return SUCCESS;
+    }
+
+    if (nb >= limits->ntt && na + nb <= NTT_MAX_LENGTH)
+    {
+        if (limb_mul_ntt(r, a, na, b, nb) == FAILURE)
+        {
+            return FAILURE;
+        }
+#ifdef APC_MUL_CROSSCHECK
+        return crosscheck_product(r, a, na, b, nb);
+#else
+        return SUCCESS;
+#endif
+    }
+
+    if (nb >= limits->toom3 && nb > 2 * ((na + 2) / 3))
+    {
+        return toom3(r, a, na, b, nb);
+    }
+
+    if (nb > (na + 1) / 2)
+    {
+        return karatsuba(r, a, na, b, nb);
+    }
+
+    return mul_unbalanced(r, a, na, b, nb);
+}
+
+/**
+ * r = a^2 with the square variant of the kernel limb_mul would pick
+ */
+int limb_sqr(limb_t *r, const limb_t *a, size_t n)
+{
+    const Thresholds *limits = thresholds();
+
+    if (n < limits->karatsuba)
+    {
+        limb_sqr_schoolbook(r, a, n);
+        return SUCCESS;
+    }
+
+    if (n >= limits->ntt && 2 * n <= NTT_MAX_LENGTH)
+    {
+        if (limb_mul_ntt(r, a, n, a, n) == FAILURE)
+        {
+            return FAILURE;
+        }
+#ifdef APC_MUL_CROSSCHECK
+        return crosscheck_product(r, a, n, a, n);
+#else
+        return SUCCESS;
+#endif
+    }
+
+    if (n >= limits->toom3)
+    {
+        return toom3(r, a, n, a, n);
+    }
+
+    return karatsuba(r, a, n, a, n);
+}
@@ -0,0 +1,520 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : limb_ops.c
+ * Description   : Low-level kernels on contiguous base-10^9 limb arrays used by the BigNumber operations
+ * Functions     : limb_compare, limb_trimmed_length, limb_increment, limb_decrement, limb_add,
+ *                 limb_sub, limb_mul_small, limb_div_small, limb_mul_schoolbook,
+ *                 limb_sqr_schoolbook, limb_divmod
+ *
+ * Conventions   : Arrays are little-endian (limbs[0] is the least significant limb).
+ *                 Every limb is in the range [0, LIMB_BASE).
+ *                 Intermediate products fit in 64 bits because (10^9)^2 < 2^64.
+ *
+ * Parallelism   : From thresholds()->parallel_add limbs on, limb_add and limb_sub split the
+ *                 operands into one block per thread (at least PARALLEL_BLOCK_MIN limbs each)
+ *                 and resolve the carries between blocks by carry selection (carry_select).
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Smallest block and most blocks of a parallel addition or subtraction */
+#define PARALLEL_BLOCK_MIN 1024
+#define PARALLEL_BLOCKS_MAX 64
+
+/* Carry-select state of one parallel addition or subtraction */
+typedef struct {
+    limb_t *r;
+    const limb_t *a;
+    const limb_t *b;
+    size_t na;
+    size_t nb;
+    size_t blocks;
+    int subtract;
+    limb_t carry_out[PARALLEL_BLOCKS_MAX];  /* Carry (borrow) out of each block with none in */
+    int propagate[PARALLEL_BLOCKS_MAX];     /* Block passes an incoming carry straight through */
+    limb_t carry_in[PARALLEL_BLOCKS_MAX];   /* Resolved carry into each block */
+} CarrySelect;
+
+/**
+ * Compare two limb arrays by magnitude
+ */
+ComparisonResult limb_compare(const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    /* More limbs is always larger (inputs carry no leading zero limbs) */
+    if (na != nb)
+    {
+        return (na > nb) ? FIRST_LARGER : SECOND_LARGER;
+    }
+
+    /* Same length: compare from the most significant limb down */
+    while (na > 0)
+    {
+        na--;
+        if (a[na] != b[na])
+        {
+            return (a[na] > b[na]) ? FIRST_LARGER : SECOND_LARGER;
+        }
+    }
+
+    return NUMBERS_EQUAL;
+}
+
+/**
+ * Length of a limb array without its leading zero limbs
+ */
+size_t limb_trimmed_length(const limb_t *x, size_t n)
+{
+    while (n > 0 && x[n - 1] == 0)
+    {
+        n--;
+    }
+    return n;
+}
+
+/**
+ * x += 1 (x has room for the carry)
+ */
+void limb_increment(limb_t *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (++x[i] < LIMB_BASE)
+        {
+            return;
+        }
+        x[i] = 0;
+    }
+}
+
+/**
+ * x -= 1 (x must be nonzero)
+ */
+void limb_decrement(limb_t *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (x[i]-- > 0)
+        {
+            return;
+        }
+        x[i] = LIMB_BASE - 1;
+    }
+}
+
+/**
+ * @brief Serial ripple-carry r = a + b (na >= nb), returns the final carry
+ */
+static limb_t add_serial(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    limb_t carry = 0;
+    size_t i = 0;
+
+    for (; i < nb; i++)
+    {
+        limb_t sum = a[i] + b[i] + carry;
+        carry = (sum >= LIMB_BASE);
+        r[i] = carry ? sum - LIMB_BASE : sum;
+    }
+
+    for (; i < na; i++)
+    {
+        limb_t sum = a[i] + carry;
+        carry = (sum >= LIMB_BASE);
+        r[i] = carry ? sum - LIMB_BASE : sum;
+    }
+
+    return carry;
+}
+
+/**
+ * @brief Serial ripple-borrow r = a - b (na >= nb), returns the final borrow
+ */
+static limb_t sub_serial(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    limb_t borrow = 0;
+    size_t i = 0;
+
+    for (; i < nb; i++)
+    {
+        limb_t sub = b[i] + borrow;
+        borrow = (a[i] < sub);
+        r[i] = borrow ? a[i] + LIMB_BASE - sub : a[i] - sub;
+    }
+
+    for (; i < na; i++)
+    {
+        if (borrow && a[i] == 0)
+        {
+            r[i] = LIMB_BASE - 1;
+        }
+        else
+        {
+            r[i] = a[i] - borrow;
+            borrow = 0;
+        }
+    }
+
+    return borrow;
+}
+
+/**
+ * @brief Pass 1 of a block: add (subtract) with no carry in, and note whether an incoming
+ *        carry would run through the whole block (all limbs 10^9 - 1, or all 0 for a borrow)
+ */
+static void carry_select_block(void *raw, size_t j)
+{
+    CarrySelect *cs = raw;
+    size_t lo = j * cs->na / cs->blocks;
+    size_t hi = (j + 1) * cs->na / cs->blocks;
+    size_t nbj = (cs->nb > lo) ? ((cs->nb < hi) ? cs->nb : hi) - lo : 0;
+    const limb_t *b = (nbj > 0) ? cs->b + lo : cs->b;
+
+    cs->carry_out[j] = cs->subtract ? sub_serial(cs->r + lo, cs->a + lo, hi - lo, b, nbj)
+                                    : add_serial(cs->r + lo, cs->a + lo, hi - lo, b, nbj);
+
+    /* Usually decided by the first limb */
+    limb_t through = cs->subtract ? 0 : LIMB_BASE - 1;
+    size_t i = lo;
+    while (i < hi && cs->r[i] == through)
+    {
+        i++;
+    }
+    cs->propagate[j] = (i == hi);
+}
+
+/**
+ * @brief Pass 2 of a block: apply its resolved incoming carry (borrow)
+ */
+static void carry_select_fixup(void *raw, size_t j)
+{
+    CarrySelect *cs = raw;
+    size_t lo = j * cs->na / cs->blocks;
+    size_t hi = (j + 1) * cs->na / cs->blocks;
+
+    if (!cs->carry_in[j])
+    {
+        return;
+    }
+
+    for (size_t i = lo; i < hi; i++)
+    {
+        if (cs->subtract)
+        {
+            if (cs->r[i] != 0)
+            {
+                cs->r[i]--;
+                break;
+            }
+            cs->r[i] = LIMB_BASE - 1;
+        }
+        else
+        {
+            if (cs->r[i] != LIMB_BASE - 1)
+            {
+                cs->r[i]++;
+                break;
+            }
+            cs->r[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Blocks for a parallel addition or subtraction of na limbs (below 2: stay serial)
+ */
+static size_t carry_select_blocks(size_t na)
+{
+    if (na < 2 * PARALLEL_BLOCK_MIN || na < thresholds()->parallel_add)
+    {
+        return 0;
+    }
+
+    size_t blocks = (size_t)parallel_threads();
+    if (blocks > na / PARALLEL_BLOCK_MIN)
+    {
+        blocks = na / PARALLEL_BLOCK_MIN;
+    }
+    return (blocks > PARALLEL_BLOCKS_MAX) ? PARALLEL_BLOCKS_MAX : blocks;
+}
+
+/**
+ * @brief Carry-select r = a +/- b over 'blocks' blocks, returns the final carry (borrow)
+ *
+ * Every block is added on its own with no carry in, in parallel. The carries are then
+ * resolved left to right over the block results alone (a carry enters block j + 1 if block j
+ * made one, or passed an incoming one through), and the blocks that receive a carry add it
+ * in parallel; that touches only the run of 10^9 - 1 limbs (0 for a borrow) it ripples
+ * through, normally a single limb.
+ */
+static limb_t carry_select(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb,
+                           int subtract, size_t blocks)
+{
+    CarrySelect cs;
+    cs.r = r;
+    cs.a = a;
+    cs.b = b;
+    cs.na = na;
+    cs.nb = nb;
+    cs.blocks = blocks;
+    cs.subtract = subtract;
+
+    parallel_for(blocks, carry_select_block, &cs);
+
+    limb_t carry = 0;
+    for (size_t j = 0; j < blocks; j++)
+    {
+        cs.carry_in[j] = carry;
+        carry = cs.carry_out[j] | (carry & (limb_t)cs.propagate[j]);
+    }
+
+    parallel_for(blocks, carry_select_fixup, &cs);
+    return carry;
+}
+
+/**
+ * r = a + b (na >= nb), returns the final carry
+ */
+limb_t limb_add(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    STAT_ADD(limb_ops, na);
+
+    size_t blocks = carry_select_blocks(na);
+    if (blocks >= 2)
+    {
+        return carry_select(r, a, na, b, nb, FALSE, blocks);
+    }
+
+    return add_serial(r, a, na, b, nb);
+}
+
+/**
+ * r = a - b (na >= nb), returns the final borrow
+ */
+limb_t limb_sub(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    STAT_ADD(limb_ops, na);
+
+    size_t blocks = carry_select_blocks(na);
+    if (blocks >= 2)
+    {
+        return carry_select(r, a, na, b, nb, TRUE, blocks);
+    }
+
+    return sub_serial(r, a, na, b, nb);
+}
+
+/**
+ * r = a * m, returns the carry out of the top limb
+ */
+limb_t limb_mul_small(limb_t *r, const limb_t *a, size_t n, limb_t m)
+{
+    uint64_t carry = 0;
+
+    STAT_ADD(limb_ops, n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t product = (uint64_t)a[i] * m + carry;
+        carry = product / LIMB_BASE;
+        r[i] = (limb_t)(product % LIMB_BASE);
+    }
+
+    return (limb_t)carry;
+}
+
+/**
+ * q = a / d, returns the remainder
+ */
+limb_t limb_div_small(limb_t *q, const limb_t *a, size_t n, limb_t d)
+{
+    uint64_t rem = 0;
+
+    STAT_ADD(limb_ops, n);
+
+    /* Walk from the most significant limb, exactly like paper long division */
+    while (n > 0)
+    {
+        n--;
+        uint64_t cur = rem * LIMB_BASE + a[n];
+        q[n] = (limb_t)(cur / d);
+        rem = cur % d;
+    }
+
+    return (limb_t)rem;
+}
+
+/**
+ * r = a * b, schoolbook O(na * nb) with one carry pass per row
+ */
+void limb_mul_schoolbook(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    memset(r, 0, (na + nb) * sizeof(limb_t));
+    STAT_ADD(limb_ops, na * nb);
+
+    for (size_t j = 0; j < nb; j++)
+    {
+        uint64_t carry = 0;
+        uint64_t bj = b[j];
+
+        if (bj == 0)
+        {
+            continue;
+        }
+
+        /* Multiply-accumulate row j directly into the result at offset j */
+        for (size_t i = 0; i < na; i++)
+        {
+            uint64_t t = a[i] * bj + r[i + j] + carry;
+            carry = t / LIMB_BASE;
+            r[i + j] = (limb_t)(t % LIMB_BASE);
+        }
+        r[j + na] = (limb_t)carry;
+    }
+}
+
+/**
+ * r = a^2, schoolbook with every cross term a[i] * a[j] (i < j) computed once:
+ * r = 2 * sum(a[i] a[j] B^(i+j)) + sum(a[i]^2 B^(2i)), about half the products of a * a
+ */
+void limb_sqr_schoolbook(limb_t *r, const limb_t *a, size_t n)
+{
+    memset(r, 0, 2 * n * sizeof(limb_t));
+    STAT_ADD(limb_ops, n * (n + 1) / 2);
+
+    /* Cross terms, row i accumulated at offset 2i + 1 */
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+
+        if (ai == 0)
+        {
+            continue;
+        }
+
+        for (size_t j = i + 1; j < n; j++)
+        {
+            uint64_t t = ai * a[j] + r[i + j] + carry;
+            carry = t / LIMB_BASE;
+            r[i + j] = (limb_t)(t % LIMB_BASE);
+        }
+        r[i + n] = (limb_t)carry;
+    }
+
+    /* Double the cross terms and add the squares on the diagonal in one carry pass */
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t square = (uint64_t)a[i] * a[i];
+
+        uint64_t t = 2 * (uint64_t)r[2 * i] + square % LIMB_BASE + carry;
+        r[2 * i] = (limb_t)(t % LIMB_BASE);
+        carry = t / LIMB_BASE;
+
+        t = 2 * (uint64_t)r[2 * i + 1] + square / LIMB_BASE + carry;
+        r[2 * i + 1] = (limb_t)(t % LIMB_BASE);
+        carry = t / LIMB_BASE;
+    }
+}
+
+/**
+ * Knuth Algorithm D (TAOCP Vol. 2, 4.3.1) in base 10^9
+ */
+int limb_divmod(limb_t *q, limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    /* Single-limb divisor: plain short division */
+    if (nb == 1)
+    {
+        limb_t *quot = q;
+        if (quot == NULL)
+        {
+            quot = malloc(na * sizeof(limb_t));
+            if (quot == NULL)
+            {
+                return FAILURE;
+            }
+        }
+
+        limb_t rem = limb_div_small(quot, a, na, b[0]);
+        if (r != NULL)
+        {
+            r[0] = rem;
+        }
+        if (q == NULL)
+        {
+            free(quot);
+        }
+        return SUCCESS;
+    }
+
+    /* Work buffers: normalized dividend (na + 1 limbs) and divisor (nb limbs) */
+    limb_t *u = malloc((na + 1 + nb) * sizeof(limb_t));
+    if (u == NULL)
+    {
+        return FAILURE;
+    }
+    limb_t *v = u + na + 1;
+
+    /* D1: Normalize so the top divisor limb is at least LIMB_BASE / 2 */
+    limb_t scale = (limb_t)(LIMB_BASE / ((uint64_t)b[nb - 1] + 1));
+    u[na] = limb_mul_small(u, a, na, scale);
+    limb_mul_small(v, b, nb, scale);
+
+    uint64_t v_top = v[nb - 1];
+    uint64_t v_next = v[nb - 2];
+
+    STAT_ADD(limb_ops, (na - nb + 1) * nb);
+
+    /* D2-D7: One quotient limb per iteration, most significant first */
+    for (size_t j = na - nb + 1; j-- > 0;)
+    {
+        /* D3: Estimate the quotient limb from the top two dividend limbs */
+        uint64_t num = (uint64_t)u[j + nb] * LIMB_BASE + u[j + nb - 1];
+        uint64_t qhat = num / v_top;
+        uint64_t rhat = num % v_top;
+
+        while (qhat >= LIMB_BASE || qhat * v_next > rhat * LIMB_BASE + u[j + nb - 2])
+        {
+            qhat--;
+            rhat += v_top;
+            if (rhat >= LIMB_BASE)
+            {
+                break;
+            }
+        }
+
+        /* D4: Multiply and subtract qhat * v from u[j .. j + nb] */
+        uint64_t carry = 0;
+        int64_t borrow = 0;
+        for (size_t i = 0; i < nb; i++)
+        {
+            uint64_t p = qhat * v[i] + carry;
+            carry = p / LIMB_BASE;
+            int64_t t = (int64_t)u[i + j] - (int64_t)(p % LIMB_BASE) - borrow;
+            borrow = (t < 0);
+            u[i + j] = (limb_t)(t < 0 ? t + LIMB_BASE : t);
+        }
+        int64_t top = (int64_t)u[j + nb] - (int64_t)carry - borrow;
+
+        /* D5/D6: qhat was one too large - add the divisor back */
+        if (top < 0)
+        {
+            qhat--;
+            limb_add(u + j, u + j, nb, v, nb);
+        }
+        u[j + nb] = 0;
+
+        if (q != NULL)
+        {
+            q[j] = (limb_t)qhat;
+        }
+    }
+
+    /* D8: Unnormalize the remainder */
+    if (r != NULL)
+    {
+        limb_div_small(r, u, nb, scale);
+    }
+
+    free(u);
+    return SUCCESS;
+}
@@ -0,0 +1,334 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : limb_sqrt.c
+ * Description   : Integer square root with remainder of base-10^9 limb arrays
+ * Function      : limb_sqrt
+ *
+ * Algorithm     : The n-limb input is padded to N of 2m limbs (m = ceil(n / 2)). A Newton
+ *                 iteration on the reciprocal square root needs only multiplications:
+ *
+ *                     X ~ B^(2m) / sqrt(N),   X1 = X0 + X0 * (1 - N * X0^2 / B^(4m)) / 2
+ *
+ *                 rsqrt() recurses on the top 2h limbs of N (h = m/2 + 1), whose root holds
+ *                 about h correct limbs, and one step at the full size doubles that to m + 2.
+ *                 As in the division reciprocal, X0 = Xh * B^(m - h) is never formed: the
+ *                 error term is computed from Xh directly, and N is cut to the m + 3 limbs that
+ *                 still matter at the target precision. The recursion bottoms out in a long
+ *                 double estimate refined by one step.
+ *
+ *   Root        : s0 = N * X / B^(2m) is within a couple of units of floor(sqrt(N)). The exact
+ *                 root and remainder r = N - s^2 follow from one squaring and +/- (2s +/- 1)
+ *                 steps, so the result is exact whatever the rounding of the iteration.
+ *
+ *                 Every step costs a constant number of multiplications of the current size,
+ *                 so a root costs a few full-size products (NTT-fast for large inputs).
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Reciprocal roots of inputs of at most 2 * RSQRT_BASECASE limbs start from a long double */
+#define RSQRT_BASECASE 2
+
+/**
+ * @brief B^i as a long double
+ */
+static long double limb_power(size_t i)
+{
+    long double power = 1.0L;
+    while (i-- > 0)
+    {
+        power *= LIMB_BASE;
+    }
+    return power;
+}
+
+/**
+ * @brief X ~ B^(2m) / sqrt(N) for small m, from long double arithmetic (about 19 digits;
+ *        plain arithmetic only, so the library needs no libm)
+ * @param x Output with room for m + 2 limbs
+ */
+static void rsqrt_estimate(limb_t *x, const limb_t *a, size_t m)
+{
+    long double value = 0.0L;
+    for (size_t i = 2 * m; i-- > 0; )
+    {
+        value = value * LIMB_BASE + a[i];
+    }
+
+    /* value = v * 4^e with v in [1, 4), then y ~ 1 / sqrt(v) by Newton from below */
+    long double scale = 1.0L;
+    while (value >= 4.0L)
+    {
+        value /= 4.0L;
+        scale *= 2.0L;
+    }
+    long double y = 0.6L;
+    for (int i = 0; i < 8; i++)
+    {
+        y = y * (3.0L - value * y * y) / 2.0L;
+    }
+    long double estimate = limb_power(2 * m) * y / scale;
+
+    /* Split into limbs from the top; the low limbs are noise, as allowed for an estimate */
+    for (size_t i = m + 2; i-- > 0; )
+    {
+        long double unit = limb_power(i);
+        long double digit = (long double)(uint64_t)(estimate / unit);
+        if (digit > LIMB_BASE - 1)
+        {
+            digit = LIMB_BASE - 1;
+        }
+        x[i] = (limb_t)digit;
+        estimate -= digit * unit;
+        if (estimate < 0.0L)
+        {
+            estimate = 0.0L;
+        }
+    }
+}
+
+/**
+ * @brief One Newton step: X ~ B^(2m) / sqrt(N) from Xh ~ B^(m + h) / sqrt(N) (h + 2 limbs)
+ * @param x Output with room for m + 2 limbs
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+static int rsqrt_step(limb_t *x, const limb_t *xh, size_t h, const limb_t *a, size_t m)
+{
+    /* Only the top L limbs of N affect a root of m + 2 limbs */
+    size_t top = (m + 3 < 2 * m) ? m + 3 : 2 * m;
+    const limb_t *nt = a + (2 * m - top);
+
+    size_t xh_len = h + 2;
+    size_t sq_len = 2 * xh_len;
+    size_t t_len = top + sq_len;
+
+    /* Scratch: Xh^2, Nt * Xh^2, E, Xh * E */
+    limb_t *scratch = calloc(sq_len + 2 * t_len + xh_len + t_len, sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *sq = scratch;
+    limb_t *t = sq + sq_len;
+    limb_t *err = t + t_len;
+    limb_t *corr = err + t_len;
+
+    if (limb_sqr(sq, xh, xh_len) == FAILURE
+        || limb_mul(t, nt, top, sq, sq_len) == FAILURE)
+    {
+        free(scratch);
+        return FAILURE;
+    }
+
+    /* E = B^(L + 2h) - Nt * Xh^2, kept as magnitude plus sign */
+    size_t one = top + 2 * h;
+    size_t t_used = limb_trimmed_length(t, t_len);
+    int err_negative;
+    memset(err, 0, t_len * sizeof(limb_t));
+    err[one] = 1;
+    if (limb_compare(t, t_used, err, one + 1) == FIRST_LARGER)
+    {
+        err_negative = TRUE;
+        limb_sub(err, t, t_used, err, one + 1);
+    }
+    else
+    {
+        err_negative = FALSE;
+        limb_sub(err, err, one + 1, t, t_used);
+    }
+    size_t err_len = limb_trimmed_length(err, t_len);
+
+    /* X1 = Xh * B^(m - h) +/- Xh * E / (2 * B^(L + 3h - m)) */
+    memset(x, 0, (m + 2) * sizeof(limb_t));
+    memcpy(x + (m - h), xh, (h + 2) * sizeof(limb_t));
+
+    size_t shift = top + 3 * h - m;
+    if (err_len > 0)
+    {
+        if (limb_mul(corr, xh, xh_len, err, err_len) == FAILURE)
+        {
+            free(scratch);
+            return FAILURE;
+        }
+
+        size_t corr_len = limb_trimmed_length(corr, xh_len + err_len);
+        if (corr_len > shift)
+        {
+            limb_t *shifted = corr + shift;
+            size_t shifted_len = corr_len - shift;
+            limb_div_small(shifted, shifted, shifted_len, 2);
+            shifted_len = limb_trimmed_length(shifted, shifted_len);
+            if (shifted_len > 0)
+            {
+                if (err_negative)
+                {
+                    limb_sub(x, x, m + 2, shifted, shifted_len);
+                }
+                else
+                {
+                    limb_add(x, x, m + 2, shifted, shifted_len);
+                }
+            }
+        }
+    }
+
+    free(scratch);
+    return SUCCESS;
+}
+
+/**
+ * @brief X ~ B^(2m) / sqrt(N) for N of 2m limbs with N >= B^(2m - 2)
+ * @param x Output with room for m + 2 limbs
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+static int rsqrt(limb_t *x, const limb_t *a, size_t m)
+{
+    /* Base case: a long double estimate, refined once at the same size */
+    if (m <= RSQRT_BASECASE)
+    {
+        limb_t estimate[RSQRT_BASECASE + 2];
+        rsqrt_estimate(estimate, a, m);
+        return rsqrt_step(x, estimate, m, a, m);
+    }
+
+    /* Recurse on the top 2h limbs (one limb of slack over m/2) */
+    size_t h = m / 2 + 1;
+    limb_t *xh = malloc((h + 2) * sizeof(limb_t));
+    if (xh == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    int status = rsqrt(xh, a + 2 * (m - h), h);
+    if (status == SUCCESS)
+    {
+        status = rsqrt_step(x, xh, h, a, m);
+    }
+
+    free(xh);
+    return status;
+}
+
+/**
+ * s = floor(sqrt(a)), r = a - s^2
+ */
+int limb_sqrt(limb_t *s, limb_t *r, const limb_t *a, size_t n)
+{
+    n = limb_trimmed_length(a, n);
+    size_t m = (n + 1) / 2;
+
+    if (n == 0)
+    {
+        if (r != NULL)
+        {
+            r[0] = 0;
+        }
+        return SUCCESS;
+    }
+
+    size_t top = (m + 3 < 2 * m) ? m + 3 : 2 * m;
+    size_t x_len = m + 2;
+    size_t p_len = top + x_len;
+    size_t w_len = 2 * m + 3;
+
+    /* Scratch: N padded to 2m limbs, X, Nt * X, s (m + 2), s^2 and the remainder work space */
+    limb_t *scratch = calloc(2 * m + x_len + p_len + (m + 2) + 2 * w_len, sizeof(limb_t));
+    if (scratch == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    limb_t *np = scratch;
+    limb_t *x = np + 2 * m;
+    limb_t *prod = x + x_len;
+    limb_t *root = prod + p_len;
+    limb_t *sq = root + (m + 2);
+    limb_t *rem = sq + w_len;
+    memcpy(np, a, n * sizeof(limb_t));
+
+    int status = rsqrt(x, np, m);
+
+    /* s0 = Nt * X / B^L */
+    if (status == SUCCESS)
+    {
+        status = limb_mul(prod, np + (2 * m - top), top, x, x_len);
+    }
+    if (status == SUCCESS)
+    {
+        memcpy(root, prod + top, x_len * sizeof(limb_t));
+        size_t root_len = limb_trimmed_length(root, m + 2);
+
+        /* r = N - s0^2, then step s0 until 0 <= r <= 2s */
+        size_t sq_len = 0;
+        if (root_len > 0)
+        {
+            status = limb_sqr(sq, root, root_len);
+            sq_len = limb_trimmed_length(sq, 2 * root_len);
+        }
+
+        if (status == SUCCESS && limb_compare(sq, sq_len, np, n) == FIRST_LARGER)
+        {
+            /* Root too large: deficit = s^2 - N; s -> s - 1 removes 2s - 1 */
+            limb_t *step = sq;
+            limb_sub(rem, sq, sq_len, np, n);
+            size_t def_len = limb_trimmed_length(rem, sq_len);
+            while (def_len > 0)
+            {
+                memset(step, 0, w_len * sizeof(limb_t));
+                step[root_len] = limb_add(step, root, root_len, root, root_len);
+                size_t step_len = limb_trimmed_length(step, root_len + 1);
+                limb_decrement(step, step_len);
+                step_len = limb_trimmed_length(step, step_len);
+                limb_decrement(root, root_len);
+                root_len = limb_trimmed_length(root, root_len);
+
+                if (limb_compare(rem, def_len, step, step_len) != FIRST_LARGER)
+                {
+                    /* Final remainder is (2s - 1) - deficit */
+                    limb_sub(rem, step, step_len, rem, def_len);
+                    break;
+                }
+                limb_sub(rem, rem, def_len, step, step_len);
+                def_len = limb_trimmed_length(rem, def_len);
+            }
+        }
+        else if (status == SUCCESS)
+        {
+            /* Root too small (or exact): s -> s + 1 removes 2s + 1 while r > 2s */
+            limb_t *step = sq;
+            memset(rem, 0, w_len * sizeof(limb_t));
+            memcpy(rem, np, n * sizeof(limb_t));
+            limb_sub(rem, rem, n, sq, sq_len);
+            size_t rem_len = limb_trimmed_length(rem, n);
+            for (;;)
+            {
+                memset(step, 0, w_len * sizeof(limb_t));
+                step[root_len] = limb_add(step, root, root_len, root, root_len);
+                size_t step_len = limb_trimmed_length(step, root_len + 1);
+                if (limb_compare(rem, rem_len, step, step_len) != FIRST_LARGER)
+                {
+                    break;
+                }
+                limb_increment(step, step_len + 1);
+                step_len = limb_trimmed_length(step, step_len + 1);
+                limb_sub(rem, rem, rem_len, step, step_len);
+                rem_len = limb_trimmed_length(rem, rem_len);
+                limb_increment(root, m + 2);
+                root_len = limb_trimmed_length(root, m + 2);
+            }
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        memcpy(s, root, m * sizeof(limb_t));
+        if (r != NULL)
+        {
+            memcpy(r, rem, (m + 1) * sizeof(limb_t));
+        }
+    }
+
+    free(scratch);
+    return status;
+}
@@ -8,45 +8,6 @@
 
 #include "apc.h"
 
-/**
- * Print a linked list representing a number
- */
-void print_list(Dlist *head)
-{
-    if (head == NULL)
-    {
-        printf("0");
-        return;
-    }
-    
-    while (head != NULL)
-    {
-        if (head->data == '.')
-        {
-            printf(".");
-        }
-        else
-        {
-            printf("%d", head->data);
-        }
-        head = head->next;
-    }
-}
-
-/**
- * Swap two doubly linked lists
- */
-void swap(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2)
-{
-    Dlist *temp_head = *head1;
-    *head1 = *head2;
-    *head2 = temp_head;
-
-    Dlist *temp_tail = *tail1;
-    *tail1 = *tail2;
-    *tail2 = temp_tail;
-}
-
 /**
  * Main function
  */
@@ -54,129 +15,134 @@ int main(int argc, char *argv[])
 {
     char *operand1_str = NULL;
     char *operand2_str = NULL;
+    char *operand3_str = NULL;
     char operator = '\0';
     char retry_option;
+    CalcOptions options;
 
     /* Parse and validate arguments (only once, not in retry loop) */
-    if (parse_arguments(argc, argv, &operand1_str, &operand2_str, &operator) == FAILURE)
+    if (parse_arguments(argc, argv, &operand1_str, &operand2_str, &operand3_str, &operator, &options) == FAILURE)
     {
         return EXIT_FAILURE;
     }
 
-    do
+    /* --threads also bounds the threads of one large addition or subtraction */
+    if (options.threads > 0)
     {
-        /* Initialize list pointers */
-        Dlist *head1 = NULL, *tail1 = NULL; 
-        Dlist *head2 = NULL, *tail2 = NULL;
-        Dlist *headR = NULL, *tailR = NULL;
-
-        /* Flags for operand properties */
-        int is_op1_negative = FALSE;
-        int is_op2_negative = FALSE;
-        int op1_bigger = FALSE;
-        int op2_bigger = FALSE;
-        int is_both_equal = FALSE;
-
-        /* Parse first operand */
-        int start_index = 0;
-        
-        if (is_negative(argv, 1, 0))
+        set_parallel_threads(options.threads);
+    }
+
+    /* Tune mode: measure the kernel thresholds and save them for later runs */
+    if (options.tune)
+    {
+        return (run_tune(&options) == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Batch mode: evaluate every input line, no interactive prompt */
+    if (options.batch_path != NULL)
+    {
+        int status = run_batch(&options);
+
+        if (options.stats)
         {
-            start_index = 1;
-            is_op1_negative = TRUE;
+            OpStats stats;
+            fflush(stdout);
+            stats_total(&stats);
+            stats_print(stderr, &stats);
         }
-        
-        parse_operands(argv, 1, start_index, &head1, &tail1);
-        
-        /* Count decimal places and digits in first operand */
-        int decimal1 = count_decimal_places(head1);
-        int digit_count1 = 0;
-        Dlist *temp = head1;
-        while (temp != NULL)
+        return (status == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Stream mode: operands and result are files processed in bounded memory */
+    if (options.stream_path != NULL)
+    {
+        int status = run_stream(&options, operand1_str, operator, operand2_str);
+
+        if (options.stats)
         {
-            if (temp->data != '.')
-            {
-                digit_count1++;
-            }
-            temp = temp->next;
+            OpStats stats;
+            stats_get(&stats);
+            stats_print(stderr, &stats);
         }
-        digit_count1 -= decimal1;  /* Exclude decimal places from integer count */
+        return (status == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-        /* Parse second operand */
-        start_index = 0;
-        
-        if (is_negative(argv, 3, 0))
+    do
+    {
+        /* Operands and result in the contiguous limb representation */
+        BigNumber num1, num2, num3, result_num;
+        bn_init(&num1);
+        bn_init(&num2);
+        bn_init(&num3);
+        bn_init(&result_num);
+
+        /* Parse operands, or map them read-only from binary number files */
+        BinaryMapping map1 = { NULL, 0, NULL };
+        BinaryMapping map2 = { NULL, 0, NULL };
+        BinaryMapping map3 = { NULL, 0, NULL };
+        int result = load_operand(operand1_str, &options, &num1, &map1);
+        if (result == SUCCESS && operand2_str != NULL)
         {
-            start_index = 1;
-            is_op2_negative = TRUE;
+            result = load_operand(operand2_str, &options, &num2, &map2);
         }
-        
-        parse_operands(argv, 3, start_index, &head2, &tail2);
-        
-        /* Count decimal places and digits in second operand */
-        int decimal2 = count_decimal_places(head2);
-        int digit_count2 = 0;
-        temp = head2;
-        while (temp != NULL)
+        if (result == SUCCESS && operand3_str != NULL)
         {
-            if (temp->data != '.')
-            {
-                digit_count2++;
-            }
-            temp = temp->next;
+            result = load_operand(operand3_str, &options, &num3, &map3);
         }
-        digit_count2 -= decimal2;  /* Exclude decimal places from integer count */
 
-        /* Compare operands (ignoring signs and decimals for magnitude comparison) */
-        Dlist *head1_copy = head1;
-        Dlist *head2_copy = head2;
-        
-        /* Skip to first non-decimal digit for comparison */
-        while (head1_copy != NULL && head1_copy->data == '.')
+        /* Perform the operation */
+        if (result == SUCCESS)
         {
-            head1_copy = head1_copy->next;
+            result = perform_operation(&num1, &num2, &num3, &result_num, operator, &options);
         }
-        while (head2_copy != NULL && head2_copy->data == '.')
+
+        /* Format first: hexadecimal output of a fractional result is an error */
+        char *text = NULL;
+        size_t text_capacity = 0;
+        size_t text_length = 0;
+        if (result == SUCCESS && options.output_format == NUMBER_FORMAT_TEXT)
         {
-            head2_copy = head2_copy->next;
+            result = bn_format_with(&result_num, &options.format, &text, &text_capacity, &text_length);
         }
-        
-        ComparisonResult comparison = compare(digit_count1, digit_count2, head1_copy, head2_copy);
-        
-        if (comparison == FIRST_LARGER)
+
+        /* Display result (a binary result is the number alone on stdout) */
+        if (result == SUCCESS && options.output_format == NUMBER_FORMAT_BINARY)
         {
-            op1_bigger = TRUE;
+            result = bn_write_binary(stdout, &result_num);
         }
-        else if (comparison == SECOND_LARGER)
+        else if (result == SUCCESS)
         {
-            op2_bigger = TRUE;
+            printf("= ");
+            fwrite(text, 1, text_length, stdout);
+            printf("\n");
         }
-        else
+        if (result == FAILURE)
         {
-            is_both_equal = TRUE;
+            fprintf(stderr, "[ERROR]: %s\n", last_error());
         }
 
-        /* Perform the operation */
-        int result = perform_operation(&head1, &tail1, &head2, &tail2, &headR, &tailR,
-                                       operator, is_op1_negative, is_op2_negative,
-                                       op1_bigger, op2_bigger, is_both_equal,
-                                       decimal1, decimal2);
-
-        /* Display result */
-        if (result == SUCCESS)
-        {
-            print_list(headR);
-            printf("\n");
-        }
-        else
+        /* Statistics of this calculation (parse, operation and output) */
+        if (options.stats)
         {
-            fprintf(stderr, "[ERROR]: Operation failed\n");
+            OpStats stats;
+            fflush(stdout);
+            stats_get(&stats);
+            stats_print(stderr, &stats);
+            stats_reset();
         }
 
         /* Clean up memory */
-        free_list(&head1);
-        free_list(&head2);
-        free_list(&headR);
+        free(text);
+        release_operand(&num1, &map1);
+        release_operand(&num2, &map2);
+        release_operand(&num3, &map3);
+        bn_free(&result_num);
+
+        /* Binary output is not interactive: stdout carries only the number */
+        if (options.output_format == NUMBER_FORMAT_BINARY)
+        {
+            return (result == SUCCESS && fflush(stdout) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
 
         /* Ask user if they want to retry */
         printf("\nWant to perform another calculation? Press [yY]: ");
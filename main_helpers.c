@@ -1,184 +1,558 @@
 /*******************************************************************************************************************************************************************
  * File Name     : main_helpers.c
  * Description   : Helper functions for main program
- * Functions     : parse_arguments, perform_operation
+ * Functions     : validate_operator, unary_operator, binary_operator, parse_arguments,
+ *                 perform_operation, load_operand, release_operand
  *******************************************************************************************************************************************************************/
 
 #include "apc.h"
 
+/* Digits per group for a bare --group */
+#define DEFAULT_GROUP_SIZE 3
+
+/**
+ * Parse a non-negative decimal count (precision, thread count)
+ */
+static int parse_count(const char *text, int *count)
+{
+    long value = 0;
+
+    if (*text == '\0')
+    {
+        return FAILURE;
+    }
+
+    for (const char *p = text; *p != '\0'; p++)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            return FAILURE;
+        }
+        value = value * 10 + (*p - '0');
+        if (value > INT_MAX / 2)
+        {
+            return FAILURE;
+        }
+    }
+
+    *count = (int)value;
+    return SUCCESS;
+}
+
+/**
+ * Parse a number representation name (text, bin)
+ */
+static int parse_number_format(const char *name, NumberFormat *format)
+{
+    if (strcmp(name, "text") == 0)
+    {
+        *format = NUMBER_FORMAT_TEXT;
+        return SUCCESS;
+    }
+    if (strcmp(name, "bin") == 0)
+    {
+        *format = NUMBER_FORMAT_BINARY;
+        return SUCCESS;
+    }
+
+    return FAILURE;
+}
+
+/**
+ * Print command line usage
+ */
+static void print_usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--precision=N] [--rounding=MODE] [FORMAT] [--threads=N] [--stats] <number1> <operator> <number2>\n", program);
+    fprintf(stderr, "       %s [FORMAT] [--threads=N] [--stats] square <number>\n", program);
+    fprintf(stderr, "       %s [--precision=N] [--rounding=MODE] [FORMAT] [--threads=N] [--stats] sqrt|isqrt <number>\n", program);
+    fprintf(stderr, "       %s [FORMAT] [--threads=N] [--stats] <base> ^ <exponent> mod <modulus>\n", program);
+    fprintf(stderr, "       %s [--precision=N] [--rounding=MODE] [FORMAT] [--threads=N] [--stats] --batch [FILE|-]\n", program);
+    fprintf(stderr, "       %s --stream=OUTFILE [--output-format=text|bin] [--stats] <file1> <+|-> <file2>\n", program);
+    fprintf(stderr, "       %s --tune[=FILE]\n", program);
+    fprintf(stderr, "Example: %s 123.45 + 67.89\n", program);
+    fprintf(stderr, "Example: %s --precision=50 --rounding=half-even 2 / 3\n", program);
+    fprintf(stderr, "Example: %s 2 ^ 100\n", program);
+    fprintf(stderr, "Example: %s --precision=30 sqrt 2\n", program);
+    fprintf(stderr, "Supported operators: +, -, x, /, %% (remainder), ^ (integer exponent), root (integer degree),\n");
+    fprintf(stderr, "                     gcd, lcm, invmod (modular inverse), square <number>, sqrt <number>\n");
+    fprintf(stderr, "                     and isqrt <number>\n");
+    fprintf(stderr, "Rounding modes: truncate (default), half-even, half-up, floor, ceil\n");
+    fprintf(stderr, "FORMAT: --group[=N] [--group-separator=C] (1,234,567), --sci[=DIGITS] (1.234567e+6), --hex (0x12d687)\n");
+    fprintf(stderr, "Operands may also be hexadecimal integers (0x1f, -0xFF)\n");
+    fprintf(stderr, "--input-format=bin: operands are binary number files (mapped, not parsed)\n");
+    fprintf(stderr, "--output-format=bin: write the result to stdout as a binary number\n");
+    fprintf(stderr, "--stream=OUTFILE: add or subtract decimal or binary number files of any size in bounded memory\n");
+}
+
+/**
+ * Check for a supported single-character operator
+ */
+int validate_operator(const char *str)
+{
+    if (str == NULL || str[0] == '\0' || str[1] != '\0')
+    {
+        return FALSE;
+    }
+
+    return (str[0] == '+' || str[0] == '-' || str[0] == 'x' || str[0] == '/' || str[0] == '%'
+            || str[0] == '^') ? TRUE : FALSE;
+}
+
+/**
+ * Look up a named operator that precedes its single operand
+ */
+char unary_operator(const char *str)
+{
+    if (str == NULL)
+    {
+        return '\0';
+    }
+
+    if (strcmp(str, "square") == 0)
+    {
+        return OPERATOR_SQUARE;
+    }
+    if (strcmp(str, "sqrt") == 0)
+    {
+        return OPERATOR_SQRT;
+    }
+    if (strcmp(str, "isqrt") == 0)
+    {
+        return OPERATOR_ISQRT;
+    }
+
+    return '\0';
+}
+
+/**
+ * Look up an operator written between its two operands
+ */
+char binary_operator(const char *str)
+{
+    if (validate_operator(str))
+    {
+        return str[0];
+    }
+    if (str == NULL)
+    {
+        return '\0';
+    }
+
+    if (strcmp(str, "root") == 0)
+    {
+        return OPERATOR_ROOT;
+    }
+    if (strcmp(str, "gcd") == 0)
+    {
+        return OPERATOR_GCD;
+    }
+    if (strcmp(str, "lcm") == 0)
+    {
+        return OPERATOR_LCM;
+    }
+    if (strcmp(str, "invmod") == 0)
+    {
+        return OPERATOR_INVMOD;
+    }
+
+    return '\0';
+}
+
 /**
  * Parse and validate command line arguments
  */
-int parse_arguments(int argc, char *argv[], char **operand1, char **operand2, char *operator)
+int parse_arguments(int argc, char *argv[], char **operand1, char **operand2, char **operand3,
+                    char *operator, CalcOptions *options)
 {
+    options->precision = DIVISION_PRECISION;
+    options->rounding = ROUND_TRUNCATE;
+    options->batch_path = NULL;
+    options->threads = 0;
+    options->tune = FALSE;
+    options->tune_path = NULL;
+    options->stats = FALSE;
+    options->format.group_size = 0;
+    options->format.group_separator = ',';
+    options->format.scientific = FALSE;
+    options->format.significant = 0;
+    options->format.radix = 10;
+    options->input_format = NUMBER_FORMAT_TEXT;
+    options->output_format = NUMBER_FORMAT_TEXT;
+    options->stream_path = NULL;
+    *operand1 = NULL;
+    *operand2 = NULL;
+    *operand3 = NULL;
+    *operator = '\0';
+
+    /* Leading "--" options (a negative operand starts with a single '-') */
+    int first = 1;
+    while (first < argc && strncmp(argv[first], "--", 2) == 0)
+    {
+        const char *option = argv[first];
+
+        if (strncmp(option, "--precision=", 12) == 0)
+        {
+            if (parse_count(option + 12, &options->precision) == FAILURE)
+            {
+                fprintf(stderr, "[ERROR]: Invalid precision '%s'\n", option + 12);
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--rounding=", 11) == 0)
+        {
+            if (parse_rounding_mode(option + 11, &options->rounding) == FAILURE)
+            {
+                fprintf(stderr, "[ERROR]: Invalid rounding mode '%s'\n", option + 11);
+                fprintf(stderr, "Rounding modes: truncate, half-even, half-up, floor, ceil\n");
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--threads=", 10) == 0)
+        {
+            if (parse_count(option + 10, &options->threads) == FAILURE)
+            {
+                fprintf(stderr, "[ERROR]: Invalid thread count '%s'\n", option + 10);
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--batch=", 8) == 0)
+        {
+            options->batch_path = option + 8;
+        }
+        else if (strcmp(option, "--batch") == 0)
+        {
+            /* Optional file argument; stdin when absent or "-" */
+            options->batch_path = "-";
+            if (first + 1 < argc && strncmp(argv[first + 1], "--", 2) != 0)
+            {
+                options->batch_path = argv[++first];
+            }
+        }
+        else if (strcmp(option, "--stats") == 0)
+        {
+            if (!stats_enabled())
+            {
+                fprintf(stderr, "[ERROR]: Statistics are not compiled in (rebuild with 'make stats')\n");
+                return FAILURE;
+            }
+            options->stats = TRUE;
+        }
+        else if (strcmp(option, "--group") == 0)
+        {
+            options->format.group_size = DEFAULT_GROUP_SIZE;
+        }
+        else if (strncmp(option, "--group=", 8) == 0)
+        {
+            if (parse_count(option + 8, &options->format.group_size) == FAILURE
+                || options->format.group_size == 0)
+            {
+                fprintf(stderr, "[ERROR]: Invalid group size '%s'\n", option + 8);
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--group-separator=", 18) == 0)
+        {
+            if (option[18] == '\0' || option[19] != '\0')
+            {
+                fprintf(stderr, "[ERROR]: Group separator must be one character\n");
+                return FAILURE;
+            }
+            options->format.group_separator = option[18];
+            if (options->format.group_size == 0)
+            {
+                options->format.group_size = DEFAULT_GROUP_SIZE;
+            }
+        }
+        else if (strcmp(option, "--sci") == 0)
+        {
+            options->format.scientific = TRUE;
+        }
+        else if (strncmp(option, "--sci=", 6) == 0)
+        {
+            if (parse_count(option + 6, &options->format.significant) == FAILURE
+                || options->format.significant == 0)
+            {
+                fprintf(stderr, "[ERROR]: Invalid significant digit count '%s'\n", option + 6);
+                return FAILURE;
+            }
+            options->format.scientific = TRUE;
+        }
+        else if (strcmp(option, "--hex") == 0)
+        {
+            options->format.radix = 16;
+        }
+        else if (strncmp(option, "--input-format=", 15) == 0)
+        {
+            if (parse_number_format(option + 15, &options->input_format) == FAILURE)
+            {
+                fprintf(stderr, "[ERROR]: Invalid input format '%s' (text or bin)\n", option + 15);
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--output-format=", 16) == 0)
+        {
+            if (parse_number_format(option + 16, &options->output_format) == FAILURE)
+            {
+                fprintf(stderr, "[ERROR]: Invalid output format '%s' (text or bin)\n", option + 16);
+                return FAILURE;
+            }
+        }
+        else if (strncmp(option, "--stream=", 9) == 0 && option[9] != '\0')
+        {
+            options->stream_path = option + 9;
+        }
+        else if (strcmp(option, "--tune") == 0)
+        {
+            options->tune = TRUE;
+        }
+        else if (strncmp(option, "--tune=", 7) == 0)
+        {
+            options->tune = TRUE;
+            options->tune_path = option + 7;
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR]: Unknown option '%s'\n", option);
+            print_usage(argv[0]);
+            return FAILURE;
+        }
+        first++;
+    }
+
+    if (options->format.scientific && options->format.radix == 16)
+    {
+        fprintf(stderr, "[ERROR]: --sci and --hex cannot be combined\n");
+        return FAILURE;
+    }
+
+    if (options->output_format == NUMBER_FORMAT_BINARY && options->batch_path != NULL)
+    {
+        fprintf(stderr, "[ERROR]: --output-format=bin writes a single result (not with --batch)\n");
+        return FAILURE;
+    }
+
+    if (options->stream_path != NULL)
+    {
+        if (options->batch_path != NULL || options->tune)
+        {
+            fprintf(stderr, "[ERROR]: --stream evaluates one expression (not with --batch or --tune)\n");
+            return FAILURE;
+        }
+        if (options->format.group_size != 0 || options->format.scientific || options->format.radix != 10)
+        {
+            fprintf(stderr, "[ERROR]: --stream writes plain decimal or binary (no --group, --sci or --hex)\n");
+            return FAILURE;
+        }
+    }
+
+    /* Tuning and batch mode take no operands */
+    if (options->tune || options->batch_path != NULL)
+    {
+        if (first < argc)
+        {
+            fprintf(stderr, "[ERROR]: Unexpected argument '%s' in %s mode\n", argv[first],
+                    options->tune ? "tune" : "batch");
+            print_usage(argv[0]);
+            return FAILURE;
+        }
+        return SUCCESS;
+    }
+
+    /* Unary operator: "<operator> <number>" */
+    if (argc - first >= 1 && unary_operator(argv[first]) != '\0')
+    {
+        if (argc - first != 2)
+        {
+            fprintf(stderr, "[ERROR]: '%s' takes exactly one operand\n", argv[first]);
+            print_usage(argv[0]);
+            return FAILURE;
+        }
+        if (options->stream_path != NULL)
+        {
+            fprintf(stderr, "[ERROR]: --stream supports only + and -\n");
+            return FAILURE;
+        }
+        if (options->input_format == NUMBER_FORMAT_TEXT && !validate_number(argv[first + 1]))
+        {
+            fprintf(stderr, "[ERROR]: Invalid operand '%s'\n", argv[first + 1]);
+            return FAILURE;
+        }
+
+        *operand1 = argv[first + 1];
+        *operator = unary_operator(argv[first]);
+        return SUCCESS;
+    }
+
     /* Check if correct number of arguments provided */
-    if (argc < 4)
+    if (argc - first < 3)
     {
         fprintf(stderr, "[ERROR]: Insufficient arguments\n");
-        fprintf(stderr, "Usage: %s <number1> <operator> <number2>\n", argv[0]);
-        fprintf(stderr, "Example: %s 123.45 + 67.89\n", argv[0]);
-        fprintf(stderr, "Supported operators: +, -, x\n");
+        print_usage(argv[0]);
         return FAILURE;
     }
 
+    char **args = argv + first;
+
+    /* Binary and streamed operands are file paths, checked when they are opened */
+    int text_operands = (options->input_format == NUMBER_FORMAT_TEXT && options->stream_path == NULL);
+
     /* Validate operand 1 */
-    if (!validate_number(argv[1]))
+    if (text_operands && !validate_number(args[0]))
     {
-        fprintf(stderr, "[ERROR]: Invalid first operand '%s'\n", argv[1]);
+        fprintf(stderr, "[ERROR]: Invalid first operand '%s'\n", args[0]);
         return FAILURE;
     }
 
     /* Validate operator */
-    if (strlen(argv[2]) != 1 || (argv[2][0] != '+' && argv[2][0] != '-' && 
-                                  argv[2][0] != 'x' && argv[2][0] != '/'))
+    if (binary_operator(args[1]) == '\0')
+    {
+        fprintf(stderr, "[ERROR]: Invalid operator '%s'\n", args[1]);
+        fprintf(stderr, "Supported operators: +, -, x, /, %%, ^, root, gcd, lcm, invmod, square <number>, sqrt <number>\n");
+        fprintf(stderr, "                     and isqrt <number>\n");
+        return FAILURE;
+    }
+
+    /* Streaming only adds and subtracts */
+    if (options->stream_path != NULL && args[1][0] != '+' && args[1][0] != '-')
     {
-        fprintf(stderr, "[ERROR]: Invalid operator '%s'\n", argv[2]);
-        fprintf(stderr, "Supported operators: +, -, x, /\n");
+        fprintf(stderr, "[ERROR]: --stream supports only + and -\n");
         return FAILURE;
     }
 
     /* Validate operand 2 */
-    if (!validate_number(argv[3]))
+    if (text_operands && !validate_number(args[2]))
     {
-        fprintf(stderr, "[ERROR]: Invalid second operand '%s'\n", argv[3]);
+        fprintf(stderr, "[ERROR]: Invalid second operand '%s'\n", args[2]);
+        return FAILURE;
+    }
+
+    /* Modular power: "<number> ^ <number> mod <number>" */
+    if (argc - first > 3 && args[1][0] == '^' && strcmp(args[3], "mod") == 0)
+    {
+        if (argc - first != 5)
+        {
+            fprintf(stderr, "[ERROR]: 'mod' takes exactly one modulus\n");
+            print_usage(argv[0]);
+            return FAILURE;
+        }
+        if (text_operands && !validate_number(args[4]))
+        {
+            fprintf(stderr, "[ERROR]: Invalid modulus '%s'\n", args[4]);
+            return FAILURE;
+        }
+
+        *operand1 = args[0];
+        *operand2 = args[2];
+        *operand3 = args[4];
+        *operator = OPERATOR_POWER_MOD;
+        return SUCCESS;
+    }
+
+    /* Anything after "<number> <operator> <number>" is a mistake, not something to ignore */
+    if (argc - first != 3)
+    {
+        fprintf(stderr, "[ERROR]: Unexpected argument '%s'\n", args[3]);
+        print_usage(argv[0]);
         return FAILURE;
     }
 
     /* Assign outputs */
-    *operand1 = argv[1];
-    *operand2 = argv[3];
-    *operator = argv[2][0];
+    *operand1 = args[0];
+    *operand2 = args[2];
+    *operator = binary_operator(args[1]);
 
     return SUCCESS;
 }
 
 /**
  * Perform the requested arithmetic operation
+ * Sign handling lives in the signed bn_* operations, so the result carries its own sign.
+ * Nothing is printed: on failure the reason is available through last_error().
  */
-int perform_operation(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, 
-                      Dlist **headR, Dlist **tailR, char operator,
-                      int is_op1_negative, int is_op2_negative, 
-                      int op1_bigger, int op2_bigger, int is_both_equal,
-                      int decimal1, int decimal2)
+int perform_operation(const BigNumber *num1, const BigNumber *num2, const BigNumber *num3, BigNumber *result,
+                      char operator, const CalcOptions *options)
 {
-    int result = FAILURE;
-    int is_both_negative = (is_op1_negative && is_op2_negative);
+    clear_last_error();
 
     switch (operator)
     {
         case '+':
-            printf("= ");
-
-            /* Different signs: Subtract smaller from larger */
-            if (is_op1_negative != is_op2_negative) 
-            {
-                if (op2_bigger) 
-                {
-                    swap(head1, tail1, head2, tail2);
-                    result = subtraction(head1, tail1, head2, tail2, headR, tailR);
-                    
-                    /* Result takes sign of the larger number */
-                    if (is_op2_negative && !is_both_equal)
-                    {
-                        printf("-");
-                    }
-                }
-                else if (op1_bigger)
-                {
-                    result = subtraction(head1, tail1, head2, tail2, headR, tailR);
-                    
-                    /* Result takes sign of the larger number (op1) */
-                    if (is_op1_negative)
-                    {
-                        printf("-");
-                    }
-                }
-                else
-                {
-                    /* Equal magnitude, opposite signs: result is 0 */
-                    result = subtraction(head1, tail1, head2, tail2, headR, tailR);
-                }
-            }
-            /* Same signs: Add values, result has same sign */
-            else 
-            {   
-                result = addition(head1, tail1, head2, tail2, headR, tailR);
-                
-                if (is_both_negative && !is_both_equal)
-                {
-                    printf("-");
-                }
-            }
-            break;
+            return bn_add(num1, num2, result);
 
         case '-':
-            printf("= ");
+            return bn_subtract(num1, num2, result);
 
-            /* Different signs: Actually addition, result takes sign of first number */
-            if (is_op1_negative != is_op2_negative) 
-            {
-                result = addition(head1, tail1, head2, tail2, headR, tailR);
-                
-                if (is_op1_negative)
-                {
-                    printf("-");
-                }
-            }
-            /* Same signs: Subtraction */
-            else 
-            {
-                if (op2_bigger) 
-                {
-                    swap(head1, tail1, head2, tail2);
-                    result = subtraction(head1, tail1, head2, tail2, headR, tailR);
-                    
-                    /* Sign logic: (+)-(+) with op2>op1 = negative, (-)-(-)  with op2>op1 = positive */
-                    if (!is_both_negative)
-                    {
-                        printf("-");
-                    }
-                } 
-                else 
-                {
-                    result = subtraction(head1, tail1, head2, tail2, headR, tailR);
-                    
-                    /* Sign logic: (-)-(-)  with op1>op2 = negative */
-                    if (is_both_negative && !is_both_equal)
-                    {
-                        printf("-");
-                    }
-                }
-            }
-            break;
-
-        case 'x':   
-            printf("= ");
-            
-            /* Result is negative if signs differ */
-            if (is_op1_negative != is_op2_negative)
-            {
-                printf("-");
-            }
-            
-            result = multiplication(head1, tail1, head2, tail2, headR, tailR, decimal1, decimal2);
-            break;
+        case 'x':
+            return bn_multiply(num1, num2, result);
 
         case '/':
-            printf("= ");
+            return bn_divide(num1, num2, result, options->precision, options->rounding);
 
-            /* Result is negative if signs differ (positive / negative or vice versa) */
-            if (is_op1_negative != is_op2_negative)
-            {
-                printf("-");
-            }
+        case '%':
+            return bn_mod(num1, num2, result);
+
+        case '^':
+            return bn_power(num1, num2, result, options->precision, options->rounding);
+
+        case OPERATOR_SQUARE:
+            return bn_square(num1, result);
+
+        case OPERATOR_POWER_MOD:
+            return bn_power_mod(num1, num2, num3, result);
+
+        case OPERATOR_SQRT:
+            return bn_sqrt(num1, result, options->precision, options->rounding);
+
+        case OPERATOR_ISQRT:
+            return bn_isqrt(num1, result);
 
-            result = division(head1, tail1, head2, tail2, headR, tailR);
-            break;
+        case OPERATOR_ROOT:
+            return bn_root(num1, num2, result, options->precision, options->rounding);
+
+        case OPERATOR_GCD:
+            return bn_gcd(num1, num2, result);
+
+        case OPERATOR_LCM:
+            return bn_lcm(num1, num2, result);
+
+        case OPERATOR_INVMOD:
+            return bn_invmod(num1, num2, result);
 
         default:
-            fprintf(stderr, "[ERROR]: Invalid operator\n");
-            result = FAILURE;
+            set_last_error("Invalid operator");
+            return FAILURE;
+    }
+}
+
+/**
+ * Load an operand: parse it as text, or map it read-only from a binary number file
+ */
+int load_operand(const char *token, const CalcOptions *options, BigNumber *num, BinaryMapping *mapping)
+{
+    mapping->base = NULL;
+    mapping->size = 0;
+    mapping->copy = NULL;
+
+    if (options->input_format == NUMBER_FORMAT_BINARY)
+    {
+        return bn_map_binary(token, num, mapping);
     }
 
-    return result;
-}
\ No newline at end of file
+    return bn_from_string(num, token);
+}
+
+/**
+ * Release an operand filled by load_operand
+ */
+void release_operand(BigNumber *num, BinaryMapping *mapping)
+{
+    if (mapping->base != NULL)
+    {
+        bn_unmap_binary(num, mapping);
+    }
+    else
+    {
+        bn_free(num);
+    }
+}
@@ -10,15 +10,16 @@
  * Return Value  : SUCCESS on successful operation, FAILURE otherwise
  * 
  * Algorithm     : 1. Remove decimal points from both numbers
- *                 2. Perform standard multiplication (multiply each digit, add partial products)
+ *                 2. Perform standard multiplication, accumulating every shifted row in place
+ *                    into one len1 + len2 digit buffer (no partial-product lists)
  *                 3. Insert decimal point in result (total decimals = decimal1 + decimal2)
  *                 4. Clean up leading/trailing zeros
  *******************************************************************************************************************************************************************/
 
 #include "apc.h"
 
-int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, 
-                   Dlist **headR, Dlist **tailR, int decimal1, int decimal2)
+static int multiply_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                          Dlist **headR, Dlist **tailR, int decimal1, int decimal2)
 {
     /* Validate input parameters */
     if (head1 == NULL || tail1 == NULL || head2 == NULL || tail2 == NULL || headR == NULL)
@@ -27,10 +28,12 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     }
 
     /* Step 1: Remove decimal points from both operands */
+    STAT_PHASE_BEGIN(remove_dot_start);
     remove_dot(head1);
     remove_dot(head2);
     
     /* Update tail pointers */
+    STAT_ADD(list_traversals, 2);
     Dlist *temp = *head1;
     while (temp != NULL && temp->next != NULL)
     {
@@ -44,97 +47,75 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         temp = temp->next;
     }
     *tail2 = temp;
+    STAT_PHASE_END(STAT_PHASE_REMOVE_DOT, remove_dot_start);
 
-    /* Step 2: Perform multiplication using standard algorithm */
-    Dlist *temp2 = *tail2; 
-    Dlist *result_head = NULL;
-    Dlist *result_tail = NULL;
-    int position = 0;
+    /* Step 2: Multiply-accumulate every row into one digit buffer */
+    STAT_PHASE_BEGIN(kernel_start);
+    STAT_ADD(list_traversals, 2);
+    int len1 = 0, len2 = 0;
+    for (temp = *head1; temp != NULL; temp = temp->next)
+    {
+        len1++;
+    }
+    for (temp = *head2; temp != NULL; temp = temp->next)
+    {
+        len2++;
+    }
 
-    while (temp2 != NULL)
+    /* acc[k] holds the digit of weight 10^k (least significant first) */
+    int result_len = len1 + len2;
+    int *acc = calloc((size_t)result_len + 1, sizeof(int));
+    if (acc == NULL)
     {
-        Dlist *partial_head = NULL;
-        Dlist *partial_tail = NULL;
-        
-        /* Add positional zeros (for tens, hundreds, etc.) */
-        for (int i = 0; i < position; i++) 
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    STAT_ADD(list_traversals, 1);
+    int position = 0;
+    for (Dlist *temp2 = *tail2; temp2 != NULL; temp2 = temp2->prev, position++)
+    {
+        /* A zero digit contributes nothing to the row sum */
+        if (temp2->data == 0)
         {
-            if (insert_at_last(&partial_head, &partial_tail, 0) == FAILURE)
-            {
-                free_list(&result_head);
-                free_list(&partial_head);
-                return FAILURE;
-            }
+            continue;
         }
 
-        /* Multiply current digit of second number with all digits of first number */
+        /* Add digit * first number, shifted by 'position', directly into acc */
         int carry = 0;
-        Dlist *temp1 = *tail1;
-        
-        while (temp1 != NULL)
-        {
-            int product = (temp1->data * temp2->data) + carry;
-            
-            if (insert_at_first(&partial_head, product % 10) == FAILURE)
-            {
-                free_list(&result_head);
-                free_list(&partial_head);
-                return FAILURE;
-            }
-            
-            /* Update tail if first insertion */
-            if (partial_tail == NULL)
-            {
-                partial_tail = partial_head;
-            }
-
-            carry = product / 10;
-            temp1 = temp1->prev;
-        }
-        
-        /* Add remaining carry */
-        if (carry > 0) 
+        int k = position;
+        STAT_ADD(list_traversals, 1);
+        STAT_ADD(digit_ops, len1);
+        for (Dlist *temp1 = *tail1; temp1 != NULL; temp1 = temp1->prev, k++)
         {
-            if (insert_at_first(&partial_head, carry) == FAILURE)
-            {
-                free_list(&result_head);
-                free_list(&partial_head);
-                return FAILURE;
-            }
-            
-            if (partial_tail == NULL)
-            {
-                partial_tail = partial_head;
-            }
+            int sum = acc[k] + temp1->data * temp2->data + carry;
+            acc[k] = sum % 10;
+            carry = sum / 10;
         }
 
-        /* Add partial product to total result */
-        Dlist *new_result_head = NULL;
-        Dlist *new_result_tail = NULL;
-        
-        if (addition(&partial_head, &partial_tail, &result_head, &result_tail, 
-                    &new_result_head, &new_result_tail) == FAILURE)
+        /* acc[k] is still untouched by earlier rows, so the carry fits */
+        acc[k] += carry;
+    }
+
+    /* Build the result list once, most significant digit first */
+    Dlist *result_head = NULL;
+    Dlist *result_tail = NULL;
+    for (int k = result_len - 1; k >= 0; k--)
+    {
+        if (insert_at_last(&result_head, &result_tail, acc[k]) == FAILURE)
         {
+            free(acc);
             free_list(&result_head);
-            free_list(&partial_head);
             return FAILURE;
         }
-        
-        /* Free old result and partial product lists */
-        free_list(&result_head);
-        free_list(&partial_head);
-        
-        /* Update result pointers */
-        result_head = new_result_head;
-        result_tail = new_result_tail;
-
-        temp2 = temp2->prev;
-        position++;
     }
-    
+    free(acc);
+
     *headR = result_head;
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
     
     /* Step 3: Insert decimal point if needed */
+    STAT_PHASE_BEGIN(normalize_start);
     int total_decimals = decimal1 + decimal2;
     
     if (total_decimals > 0 && *headR != NULL)
@@ -143,6 +124,7 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         Dlist *temp_r = *headR;
         
         /* Move to the end */
+        STAT_ADD(list_traversals, 1);
         while (temp_r != NULL && temp_r->next != NULL)
         {
             temp_r = temp_r->next;
@@ -157,7 +139,7 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         /* Insert decimal point */
         if (temp_r != NULL)
         {
-            Dlist *decimal_node = malloc(sizeof(Dlist));
+            Dlist *decimal_node = node_alloc();
             if (decimal_node == NULL)
             {
                 free_list(headR);
@@ -180,6 +162,7 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
             /* Need to add leading zeros */
             int digits_count = 0;
             Dlist *counter = *headR;
+            STAT_ADD(list_traversals, 1);
             while (counter != NULL)
             {
                 digits_count++;
@@ -205,7 +188,7 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
             Dlist *decimal_node = (*headR)->next;
             for (int i = 0; i < zeros_needed; i++)
             {
-                Dlist *zero_node = malloc(sizeof(Dlist));
+                Dlist *zero_node = node_alloc();
                 if (zero_node == NULL)
                 {
                     free_list(headR);
@@ -227,6 +210,7 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     }
 
     /* Update tailR pointer */
+    STAT_ADD(list_traversals, 1);
     temp = *headR;
     while (temp != NULL && temp->next != NULL)
     {
@@ -249,5 +233,19 @@ int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * Statistics builds time the whole operation around the list arithmetic
+ */
+int multiplication(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                   Dlist **headR, Dlist **tailR, int decimal1, int decimal2)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = multiply_lists(head1, tail1, head2, tail2, headR, tailR, decimal1, decimal2);
+    STAT_OP_END(STAT_OP_MUL, op_start);
+    return status;
+}
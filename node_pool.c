@@ -0,0 +1,108 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : node_pool.c
+ * Description   : Slab/arena allocator for doubly linked list nodes
+ * Functions     : node_alloc, node_free
+ *
+ * Algorithm     : Nodes are carved out of slabs of NODE_POOL_SLAB_SIZE nodes with a bump
+ *                 pointer, so one malloc serves thousands of insert_at_first / insert_at_last
+ *                 calls. node_free() pushes a node onto a free list and node_alloc() pops from
+ *                 it first, so nodes released mid-operation (remainders, partial products) are
+ *                 recycled without touching the system allocator.
+ *
+ *   Stats       : Slab mallocs, recycled nodes and the peak number of live nodes are counted in
+ *                 the thread's OpStats (make stats) next to node allocations and frees.
+ *
+ *   Threads     : The pool is thread-local, so concurrent operations never share nodes or locks.
+ *                 Slabs are kept for the life of the thread: since the calculator moved to
+ *                 BigNumber only the list routines themselves allocate nodes.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Nodes carved from one malloc */
+#define NODE_POOL_SLAB_SIZE 4096
+
+/* One slab of nodes, chained in allocation order */
+typedef struct node_slab {
+    struct node_slab *next;
+    Dlist nodes[NODE_POOL_SLAB_SIZE];
+} NodeSlab;
+
+/* Per-thread pool state */
+typedef struct {
+    NodeSlab *first;        /* Oldest slab                           */
+    NodeSlab *current;      /* Slab the bump pointer is in           */
+    size_t used;            /* Nodes handed out from 'current'       */
+    Dlist *free_nodes;      /* Recycled nodes, linked through 'next' */
+    size_t live;            /* Nodes currently in use                */
+} NodePool;
+
+static _Thread_local NodePool pool;
+
+/**
+ * Allocate one node (free list first, then the bump pointer)
+ */
+Dlist *node_alloc(void)
+{
+    Dlist *node;
+
+    if (pool.free_nodes != NULL)
+    {
+        node = pool.free_nodes;
+        pool.free_nodes = node->next;
+        STAT_ADD(node_recycled, 1);
+    }
+    else
+    {
+        /* Current slab exhausted: move to the next kept slab or grow the chain */
+        if (pool.current == NULL || pool.used == NODE_POOL_SLAB_SIZE)
+        {
+            NodeSlab *next = (pool.current != NULL) ? pool.current->next : pool.first;
+            if (next == NULL)
+            {
+                next = malloc(sizeof(NodeSlab));
+                if (next == NULL)
+                {
+                    return NULL;
+                }
+                next->next = NULL;
+                if (pool.current != NULL)
+                {
+                    pool.current->next = next;
+                }
+                else
+                {
+                    pool.first = next;
+                }
+                STAT_ADD(node_slabs, 1);
+            }
+            pool.current = next;
+            pool.used = 0;
+        }
+        node = &pool.current->nodes[pool.used++];
+    }
+
+    pool.live++;
+    STAT_ADD(node_allocs, 1);
+    STAT_MAX(node_peak_live, pool.live);
+
+    return node;
+}
+
+/**
+ * Return one node to the free list
+ */
+void node_free(Dlist *node)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+
+    node->prev = NULL;
+    node->next = pool.free_nodes;
+    pool.free_nodes = node;
+
+    pool.live--;
+    STAT_ADD(node_frees, 1);
+}
@@ -0,0 +1,573 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : ntt.c
+ * Description   : Number-theoretic-transform multiplication of base-10^9 limb arrays
+ * Function      : limb_mul_ntt
+ *
+ * Algorithm     : The limbs are treated as polynomial coefficients and convolved exactly with
+ *                 three independent NTTs over 30-bit primes p = c * 2^k + 1:
+ *
+ *                     998244353 = 119 * 2^23 + 1
+ *                     167772161 =   5 * 2^25 + 1
+ *                     469762049 =   7 * 2^26 + 1
+ *
+ *                 Each convolution coefficient is at most min(na, nb) * (10^9 - 1)^2, which is
+ *                 below p1 * p2 * p3 (~7.9e25) for every supported length, so the three residues
+ *                 determine it exactly (Garner CRT). No floating point is involved.
+ *
+ *                 Forward transforms are decimation-in-frequency (output in bit-reversed order),
+ *                 the inverse is decimation-in-time (input in bit-reversed order), so no explicit
+ *                 bit-reversal permutation is needed. Arithmetic uses 32-bit Montgomery form.
+ *
+ * Squaring      : When a and b are the same array (a == b, na == nb) the operand is
+ *                 transformed once per prime and multiplied pointwise by itself: two transforms
+ *                 per prime instead of three.
+ *
+ * Threads       : From thresholds()->parallel_mul limbs on, every phase (load, twiddles,
+ *                 transforms, pointwise product, scaling, CRT) is cut into parallel_threads()
+ *                 pieces run by parallel_for; only the final carry pass is serial.
+ *
+ * Limits        : The transform length is limited to 2^23 by the first prime, so na + nb must
+ *                 not exceed NTT_MAX_LENGTH limbs (~75M decimal digits of product).
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+#define NTT_PRIME_COUNT 3
+
+/* Smallest independent block of a parallel transform (words) */
+#define NTT_BLOCK_MIN 1024
+
+/* Prime parameters and Montgomery constants */
+typedef struct {
+    uint32_t p;         /* Prime modulus */
+    uint32_t p_inv;     /* -p^-1 mod 2^32 */
+    uint32_t r2;        /* 2^64 mod p (converts into Montgomery form) */
+    uint32_t root;      /* Primitive root of p */
+} NttPrime;
+
+/* One product: operands, transform buffers and the state shared by the pieces of a phase */
+typedef struct {
+    uint32_t *fa;               /* Transform of a (then the product) */
+    uint32_t *fb;               /* Transform of b (NULL for a square) */
+    uint32_t *roots;            /* Twiddle table (n words)           */
+    size_t n;                   /* Transform length                  */
+    const limb_t *a;
+    size_t na;
+    const limb_t *b;
+    size_t nb;
+    int square;                 /* a == b: only fa is transformed    */
+    const NttPrime *prime;      /* Prime of the current convolution  */
+    uint32_t *out;              /* Its residues                      */
+    uint32_t n_inv;             /* n^-1 mod p                        */
+    int inverse;                /* Twiddles of the inverse transform */
+    size_t len;                 /* Span of the current stage         */
+    size_t pieces;              /* Pieces per phase (1 = serial)     */
+    size_t block;               /* Words per independent block       */
+    const uint32_t *moduli;
+    uint32_t *residue[NTT_PRIME_COUNT];
+    uint64_t inv_p1_mod_p2;     /* Garner constants                  */
+    uint64_t inv_p1p2_mod_p3;
+} NttJob;
+
+/**
+ * @brief Montgomery reduction: returns t * 2^-32 mod p for t < p * 2^32
+ */
+static inline uint32_t mont_reduce(uint64_t t, const NttPrime *prime)
+{
+    uint32_t m = (uint32_t)t * prime->p_inv;
+    uint32_t u = (uint32_t)((t + (uint64_t)m * prime->p) >> 32);
+    return (u >= prime->p) ? u - prime->p : u;
+}
+
+/**
+ * @brief Montgomery product a * b * 2^-32 mod p
+ */
+static inline uint32_t mont_mul(uint32_t a, uint32_t b, const NttPrime *prime)
+{
+    return mont_reduce((uint64_t)a * b, prime);
+}
+
+static inline uint32_t mod_add(uint32_t a, uint32_t b, uint32_t p)
+{
+    uint32_t s = a + b;
+    return (s >= p) ? s - p : s;
+}
+
+static inline uint32_t mod_sub(uint32_t a, uint32_t b, uint32_t p)
+{
+    return (a >= b) ? a - b : a + p - b;
+}
+
+/**
+ * @brief Plain modular exponentiation (used only for setup constants)
+ */
+static uint32_t pow_mod(uint64_t base, uint64_t exp, uint32_t p)
+{
+    uint64_t result = 1;
+    base %= p;
+
+    while (exp > 0)
+    {
+        if (exp & 1)
+        {
+            result = result * base % p;
+        }
+        base = base * base % p;
+        exp >>= 1;
+    }
+
+    return (uint32_t)result;
+}
+
+/**
+ * @brief Fill in the Montgomery constants for a prime
+ */
+static void prime_setup(NttPrime *prime, uint32_t p, uint32_t root)
+{
+    /* Newton iteration for p^-1 mod 2^32 (each step doubles the correct bits) */
+    uint32_t inv = p;
+    for (int i = 0; i < 4; i++)
+    {
+        inv *= 2 - p * inv;
+    }
+
+    prime->p = p;
+    prime->p_inv = (uint32_t)(0u - inv);
+    prime->r2 = (uint32_t)((((uint64_t)1 << 32) % p) * (((uint64_t)1 << 32) % p) % p);
+    prime->root = root;
+}
+
+/**
+ * @brief Twiddle factor w_(2 len) of a stage (plain form; inverse roots for the inverse transform)
+ */
+static uint32_t stage_root(size_t len, const NttPrime *prime, int inverse)
+{
+    uint32_t w = pow_mod(prime->root, (prime->p - 1) / (2 * len), prime->p);
+    return inverse ? pow_mod(w, prime->p - 2, prime->p) : w;
+}
+
+/**
+ * @brief In-place forward transform (decimation in frequency, bit-reversed output)
+ */
+static void ntt_forward(uint32_t *a, size_t n, const uint32_t *roots, const NttPrime *prime)
+{
+    uint32_t p = prime->p;
+
+    for (size_t len = n >> 1; len >= 1; len >>= 1)
+    {
+        STAT_ADD(limb_ops, n / 2);
+        for (size_t i = 0; i < n; i += 2 * len)
+        {
+            for (size_t j = 0; j < len; j++)
+            {
+                uint32_t u = a[i + j];
+                uint32_t v = a[i + j + len];
+                a[i + j] = mod_add(u, v, p);
+                a[i + j + len] = mont_mul(mod_sub(u, v, p), roots[len + j], prime);
+            }
+        }
+    }
+}
+
+/**
+ * @brief In-place inverse transform (decimation in time, bit-reversed input), unscaled
+ */
+static void ntt_inverse(uint32_t *a, size_t n, const uint32_t *roots, const NttPrime *prime)
+{
+    uint32_t p = prime->p;
+
+    for (size_t len = 1; len < n; len <<= 1)
+    {
+        STAT_ADD(limb_ops, n / 2);
+        for (size_t i = 0; i < n; i += 2 * len)
+        {
+            for (size_t j = 0; j < len; j++)
+            {
+                uint32_t u = a[i + j];
+                uint32_t v = mont_mul(a[i + j + len], roots[len + j], prime);
+                a[i + j] = mod_add(u, v, p);
+                a[i + j + len] = mod_sub(u, v, p);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Range [from, to) of piece 'piece' when 'total' items are cut into 'pieces' pieces
+ */
+static void piece_range(size_t total, size_t pieces, size_t piece, size_t *from, size_t *to)
+{
+    *from = piece * total / pieces;
+    *to = (piece + 1) * total / pieces;
+}
+
+/**
+ * @brief Run one phase of the convolution: in parallel pieces, or as a single piece
+ */
+static void run_phase(NttJob *job, parallel_fn phase)
+{
+    if (job->pieces > 1)
+    {
+        parallel_for(job->pieces, phase, job);
+    }
+    else
+    {
+        phase(job, 0);
+    }
+}
+
+/**
+ * @brief Phase: load both operands in Montgomery form, zero padded to n
+ */
+static void load_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    const NttPrime *prime = job->prime;
+    size_t from, to;
+    piece_range(job->n, job->pieces, piece, &from, &to);
+
+    for (size_t i = from; i < to; i++)
+    {
+        job->fa[i] = (i < job->na) ? mont_mul(job->a[i] % prime->p, prime->r2, prime) : 0;
+        if (!job->square)
+        {
+            job->fb[i] = (i < job->nb) ? mont_mul(job->b[i] % prime->p, prime->r2, prime) : 0;
+        }
+    }
+}
+
+/**
+ * @brief Phase: twiddle table roots[len + j] = w_(2 len)^j (Montgomery form) for every power
+ *        of two len < n, n entries in total. A piece starts each level at w^j directly.
+ */
+static void roots_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    const NttPrime *prime = job->prime;
+    size_t from, to;
+    piece_range(job->n, job->pieces, piece, &from, &to);
+    if (from == 0)
+    {
+        from = 1;
+    }
+
+    size_t t = from;
+    while (t < to)
+    {
+        size_t len = 1;
+        while (2 * len <= t)
+        {
+            len <<= 1;
+        }
+        size_t level_end = (2 * len < to) ? 2 * len : to;
+
+        uint32_t w_plain = stage_root(len, prime, job->inverse);
+        uint32_t w = mont_mul(w_plain, prime->r2, prime);
+        uint32_t cur = mont_mul(pow_mod(w_plain, t - len, prime->p), prime->r2, prime);
+
+        for (; t < level_end; t++)
+        {
+            job->roots[t] = cur;
+            cur = mont_mul(cur, w, prime);
+        }
+    }
+}
+
+/**
+ * @brief Butterflies [from, to) of the forward stage of span len, numbered 0 .. n/2 - 1
+ */
+static void forward_stage(uint32_t *a, size_t len, size_t from, size_t to,
+                          const uint32_t *roots, const NttPrime *prime)
+{
+    uint32_t p = prime->p;
+
+    STAT_ADD(limb_ops, to - from);
+    for (size_t t = from; t < to; t++)
+    {
+        size_t j = t % len;
+        size_t i = (t - j) * 2 + j;
+        uint32_t u = a[i];
+        uint32_t v = a[i + len];
+        a[i] = mod_add(u, v, p);
+        a[i + len] = mont_mul(mod_sub(u, v, p), roots[len + j], prime);
+    }
+}
+
+/**
+ * @brief Phase: one forward stage (span job->len) over both operands
+ */
+static void forward_stage_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    size_t from, to;
+    piece_range(job->n / 2, job->pieces, piece, &from, &to);
+
+    forward_stage(job->fa, job->len, from, to, job->roots, job->prime);
+    if (!job->square)
+    {
+        forward_stage(job->fb, job->len, from, to, job->roots, job->prime);
+    }
+}
+
+/**
+ * @brief Phase: the remaining forward stages, each block of job->block words on its own
+ */
+static void forward_blocks_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    size_t from, to;
+    piece_range(job->n / job->block, job->pieces, piece, &from, &to);
+
+    for (size_t k = from; k < to; k++)
+    {
+        ntt_forward(job->fa + k * job->block, job->block, job->roots, job->prime);
+        if (!job->square)
+        {
+            ntt_forward(job->fb + k * job->block, job->block, job->roots, job->prime);
+        }
+    }
+}
+
+/**
+ * @brief Phase: pointwise product fa = fa * fb (fa * fa for a square)
+ */
+static void pointwise_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    const uint32_t *fb = job->square ? job->fa : job->fb;
+    size_t from, to;
+    piece_range(job->n, job->pieces, piece, &from, &to);
+
+    for (size_t i = from; i < to; i++)
+    {
+        job->fa[i] = mont_mul(job->fa[i], fb[i], job->prime);
+    }
+}
+
+/**
+ * @brief Phase: the first inverse stages, each block of job->block words on its own
+ */
+static void inverse_blocks_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    size_t from, to;
+    piece_range(job->n / job->block, job->pieces, piece, &from, &to);
+
+    for (size_t k = from; k < to; k++)
+    {
+        ntt_inverse(job->fa + k * job->block, job->block, job->roots, job->prime);
+    }
+}
+
+/**
+ * @brief Phase: one inverse stage (span job->len), butterflies numbered as in forward_stage
+ */
+static void inverse_stage_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    const NttPrime *prime = job->prime;
+    uint32_t p = prime->p;
+    uint32_t *a = job->fa;
+    size_t len = job->len;
+    size_t from, to;
+    piece_range(job->n / 2, job->pieces, piece, &from, &to);
+
+    STAT_ADD(limb_ops, to - from);
+    for (size_t t = from; t < to; t++)
+    {
+        size_t j = t % len;
+        size_t i = (t - j) * 2 + j;
+        uint32_t u = a[i];
+        uint32_t v = mont_mul(a[i + len], job->roots[len + j], prime);
+        a[i] = mod_add(u, v, p);
+        a[i + len] = mod_sub(u, v, p);
+    }
+}
+
+/**
+ * @brief Phase: scale by n^-1 and leave Montgomery form in one multiply
+ *        (mont_mul(x*R, n^-1) = x * n^-1, plain)
+ */
+static void scale_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    size_t from, to;
+    piece_range(job->na + job->nb - 1, job->pieces, piece, &from, &to);
+
+    for (size_t i = from; i < to; i++)
+    {
+        job->out[i] = mont_mul(job->fa[i], job->n_inv, job->prime);
+    }
+}
+
+/**
+ * @brief Cyclic convolution of a and b modulo one prime.
+ *        out[i] receives the plain (non-Montgomery) residue of coefficient i.
+ *
+ * With more than one piece the transforms are split in two: the top stages, whose butterflies
+ * span more than one block, run one stage at a time with the butterflies shared out; below
+ * that every block of n / blocks words is an independent transform of its own (the twiddle
+ * table serves every size), so those stages need a single parallel step.
+ */
+static void convolve_mod(NttJob *job, uint32_t *out, const NttPrime *prime)
+{
+    job->prime = prime;
+    job->out = out;
+
+    run_phase(job, load_phase);
+
+    job->inverse = FALSE;
+    run_phase(job, roots_phase);
+    for (job->len = job->n >> 1; job->len >= job->block; job->len >>= 1)
+    {
+        run_phase(job, forward_stage_phase);
+    }
+    run_phase(job, forward_blocks_phase);
+
+    run_phase(job, pointwise_phase);
+
+    job->inverse = TRUE;
+    run_phase(job, roots_phase);
+    run_phase(job, inverse_blocks_phase);
+    for (job->len = job->block; job->len < job->n; job->len <<= 1)
+    {
+        run_phase(job, inverse_stage_phase);
+    }
+
+    job->n_inv = pow_mod(job->n % prime->p, prime->p - 2, prime->p);
+    run_phase(job, scale_phase);
+}
+
+/**
+ * @brief Phase: Garner CRT of every coefficient to x = v1 + p1 * (v2 + p2 * v3), split into
+ *        three base-10^9 digits d0 + d1 * B + d2 * B^2 stored over the residues
+ *        (x < 7.9e25, so d2 < 7.9e7 fits a word as well)
+ */
+static void crt_phase(void *raw, size_t piece)
+{
+    NttJob *job = raw;
+    uint64_t p1 = job->moduli[0], p2 = job->moduli[1], p3 = job->moduli[2];
+    size_t from, to;
+    piece_range(job->na + job->nb - 1, job->pieces, piece, &from, &to);
+
+    for (size_t i = from; i < to; i++)
+    {
+        uint64_t v1 = job->residue[0][i];
+        uint64_t v2 = (job->residue[1][i] + p2 - v1 % p2) % p2 * job->inv_p1_mod_p2 % p2;
+        uint64_t partial = (v1 + p1 * v2) % p3;
+        uint64_t v3 = (job->residue[2][i] + p3 - partial) % p3 * job->inv_p1p2_mod_p3 % p3;
+
+        uint64_t t = v2 + p2 * v3;                  /* < p2 * p3 < 2^64 */
+        uint64_t lo = v1 + p1 * (t % LIMB_BASE);    /* < 2^64           */
+        uint64_t mid = lo / LIMB_BASE + p1 * (t / LIMB_BASE);
+        job->residue[0][i] = (uint32_t)(lo % LIMB_BASE);
+        job->residue[1][i] = (uint32_t)(mid % LIMB_BASE);
+        job->residue[2][i] = (uint32_t)(mid / LIMB_BASE);
+    }
+}
+
+/**
+ * r = a * b via three-prime NTT and CRT
+ */
+int limb_mul_ntt(limb_t *r, const limb_t *a, size_t na, const limb_t *b, size_t nb)
+{
+    static const uint32_t moduli[NTT_PRIME_COUNT] = { 998244353u, 167772161u, 469762049u };
+    NttPrime primes[NTT_PRIME_COUNT];
+
+    if (na == 0 || nb == 0)
+    {
+        memset(r, 0, (na + nb) * sizeof(limb_t));
+        return SUCCESS;
+    }
+
+    size_t conv_len = na + nb - 1;
+    size_t n = 1;
+    while (n < conv_len)
+    {
+        n <<= 1;
+    }
+    if (na + nb > NTT_MAX_LENGTH)
+    {
+        set_last_error("Operands too large for the NTT");
+        return FAILURE;
+    }
+
+    for (int k = 0; k < NTT_PRIME_COUNT; k++)
+    {
+        prime_setup(&primes[k], moduli[k], 3);
+    }
+
+    /* Work space: 3 transforms of n words (2 for a square) plus residues for all primes */
+    int square = (a == b && na == nb);
+    size_t transforms = square ? 2 : 3;
+    uint32_t *work = malloc((transforms * n + NTT_PRIME_COUNT * conv_len) * sizeof(uint32_t));
+    if (work == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    NttJob job;
+    job.fa = work;
+    job.fb = square ? NULL : job.fa + n;
+    job.roots = job.fa + (transforms - 1) * n;
+    job.square = square;
+    job.n = n;
+    job.a = a;
+    job.na = na;
+    job.b = b;
+    job.nb = nb;
+    job.moduli = moduli;
+
+    /* Parallel: blocks are the smallest power of two >= the thread count, each >= NTT_BLOCK_MIN */
+    job.pieces = 1;
+    job.block = n;
+    if (nb >= thresholds()->parallel_mul && parallel_threads() > 1)
+    {
+        job.pieces = (size_t)parallel_threads();
+        while (job.block > NTT_BLOCK_MIN && n / job.block < job.pieces)
+        {
+            job.block >>= 1;
+        }
+    }
+
+    for (int k = 0; k < NTT_PRIME_COUNT; k++)
+    {
+        job.residue[k] = job.roots + n + k * conv_len;
+        convolve_mod(&job, job.residue[k], &primes[k]);
+    }
+
+    /* Garner constants */
+    uint64_t p1 = moduli[0], p2 = moduli[1], p3 = moduli[2];
+    job.inv_p1_mod_p2 = pow_mod(p1, p2 - 2, (uint32_t)p2);
+    job.inv_p1p2_mod_p3 = pow_mod(p1 * p2 % p3, p3 - 2, (uint32_t)p3);
+    run_phase(&job, crt_phase);
+
+    /* Carry the digits d0, d1, d2 of every coefficient into base 10^9 */
+    uint64_t carry = 0;     /* Carry into position i                  */
+    uint64_t pending1 = 0;  /* d1 contributions waiting for position i */
+    uint64_t pending2 = 0;  /* d2 contributions waiting for position i+1 */
+
+    for (size_t i = 0; i < na + nb; i++)
+    {
+        uint64_t d0 = 0, d1 = 0, d2 = 0;
+
+        if (i < conv_len)
+        {
+            d0 = job.residue[0][i];
+            d1 = job.residue[1][i];
+            d2 = job.residue[2][i];
+        }
+
+        uint64_t sum = d0 + pending1 + carry;
+        r[i] = (limb_t)(sum % LIMB_BASE);
+        carry = sum / LIMB_BASE;
+
+        /* Shift the window: d1 belongs to i + 1, d2 to i + 2 */
+        pending1 = pending2 + d1;
+        pending2 = d2;
+    }
+
+    free(work);
+    return SUCCESS;
+}
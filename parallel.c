@@ -0,0 +1,186 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : parallel.c
+ * Description   : Data-parallel loops for the limb kernels on a shared process-wide thread pool
+ * Functions     : parallel_threads, set_parallel_threads, parallel_for
+ *
+ * Design        : The first parallel_for starts one work-stealing pool (thread_pool.c) with
+ *                 parallel_threads() - 1 workers; the calling thread is the missing one.
+ *                 A loop of 'count' independent pieces queues at most one helper task per
+ *                 worker. The helpers and the caller claim pieces from a shared atomic counter,
+ *                 so the caller alone finishes the loop if the pool is busy, and the caller
+ *                 returns only when every helper has left (the loop state lives on its stack).
+ *
+ *   Nesting     : A piece that itself calls parallel_for runs that inner loop serially, so
+ *                 workers never block waiting for tasks queued behind them. Loops from several
+ *                 threads (batch workers) simply share the pool.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* State of one parallel_for, on the caller's stack */
+typedef struct {
+    parallel_fn fn;
+    void *arg;
+    size_t count;
+    atomic_size_t next;         /* Next piece to claim */
+    pthread_mutex_t lock;
+    pthread_cond_t helpers_done;
+    int helpers;                /* Helper tasks queued and not yet finished */
+} ParallelLoop;
+
+static ThreadPool *shared_pool;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+/* Thread count set by set_parallel_threads (0 = every online core) */
+static atomic_int thread_limit;
+
+/* online_cpu_count(), cached on first use */
+static atomic_int core_count;
+
+/* Non-zero while this thread runs a piece of a parallel loop */
+static _Thread_local int in_parallel_loop;
+
+/**
+ * @brief Start the shared pool (runs once per process; stays NULL on failure)
+ */
+static void start_shared_pool(void)
+{
+    shared_pool = thread_pool_create(parallel_threads() - 1);
+}
+
+/**
+ * @brief Claim and run pieces until none are left
+ */
+static void run_pieces(ParallelLoop *loop)
+{
+    in_parallel_loop++;
+    for (;;)
+    {
+        size_t index = atomic_fetch_add(&loop->next, 1);
+        if (index >= loop->count)
+        {
+            break;
+        }
+        loop->fn(loop->arg, index);
+    }
+    in_parallel_loop--;
+}
+
+/**
+ * @brief Pool task: help with the loop, then tell the caller this helper is gone
+ */
+static void helper_task(void *raw, int worker)
+{
+    ParallelLoop *loop = raw;
+    (void)worker;
+
+    run_pieces(loop);
+
+    /* Counters of the pieces run here would otherwise stay with the pool thread */
+    STAT_FLUSH();
+
+    pthread_mutex_lock(&loop->lock);
+    if (--loop->helpers == 0)
+    {
+        pthread_cond_signal(&loop->helpers_done);
+    }
+    pthread_mutex_unlock(&loop->lock);
+}
+
+/**
+ * Threads a parallel loop may use (the caller included)
+ */
+int parallel_threads(void)
+{
+    int limit = atomic_load(&thread_limit);
+    if (limit > 0)
+    {
+        return limit;
+    }
+
+    int cores = atomic_load(&core_count);
+    if (cores == 0)
+    {
+        cores = online_cpu_count();
+        atomic_store(&core_count, cores);
+    }
+    return cores;
+}
+
+/**
+ * Set the threads of parallel loops (0 = every online core)
+ */
+void set_parallel_threads(int threads)
+{
+    atomic_store(&thread_limit, (threads > 0) ? threads : 0);
+}
+
+/**
+ * Run fn(arg, i) for every i < count, spread over the shared pool and the caller
+ */
+void parallel_for(size_t count, parallel_fn fn, void *arg)
+{
+    int threads = parallel_threads();
+
+    if (count > 1 && threads > 1 && !in_parallel_loop)
+    {
+        pthread_once(&pool_once, start_shared_pool);
+    }
+
+    if (count <= 1 || threads <= 1 || in_parallel_loop || shared_pool == NULL)
+    {
+        in_parallel_loop++;
+        for (size_t i = 0; i < count; i++)
+        {
+            fn(arg, i);
+        }
+        in_parallel_loop--;
+        return;
+    }
+
+    ParallelLoop loop;
+    loop.fn = fn;
+    loop.arg = arg;
+    loop.count = count;
+    atomic_init(&loop.next, 0);
+    pthread_mutex_init(&loop.lock, NULL);
+    pthread_cond_init(&loop.helpers_done, NULL);
+    loop.helpers = 0;
+
+    /* One helper per extra thread and piece; a helper that cannot be queued is not needed */
+    size_t wanted = count - 1;
+    if (wanted > (size_t)threads - 1)
+    {
+        wanted = (size_t)threads - 1;
+    }
+    for (size_t i = 0; i < wanted; i++)
+    {
+        pthread_mutex_lock(&loop.lock);
+        loop.helpers++;
+        pthread_mutex_unlock(&loop.lock);
+
+        if (thread_pool_submit(shared_pool, helper_task, &loop) == FAILURE)
+        {
+            pthread_mutex_lock(&loop.lock);
+            loop.helpers--;
+            pthread_mutex_unlock(&loop.lock);
+            break;
+        }
+    }
+
+    run_pieces(&loop);
+
+    pthread_mutex_lock(&loop.lock);
+    while (loop.helpers > 0)
+    {
+        pthread_cond_wait(&loop.helpers_done, &loop.lock);
+    }
+    pthread_mutex_unlock(&loop.lock);
+
+    pthread_mutex_destroy(&loop.lock);
+    pthread_cond_destroy(&loop.helpers_done);
+}
@@ -0,0 +1,40 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : print_list.c
+ * Description   : Function to print a number stored as a doubly linked list
+ * Function      : print_list
+ * Input Params  : head - Pointer to the head of the list
+ * Return Value  : void
+ *
+ * Output        : Characters are collected in a stack buffer and written with one fwrite per
+ *                 PRINT_BUFFER_SIZE bytes instead of one printf call per digit node.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Characters buffered between writes */
+#define PRINT_BUFFER_SIZE 4096
+
+void print_list(Dlist *head)
+{
+    if (head == NULL)
+    {
+        fputc('0', stdout);
+        return;
+    }
+
+    char buffer[PRINT_BUFFER_SIZE];
+    size_t used = 0;
+
+    while (head != NULL)
+    {
+        buffer[used++] = (head->data == '.') ? '.' : (char)('0' + head->data);
+        if (used == sizeof(buffer))
+        {
+            fwrite(buffer, 1, used, stdout);
+            used = 0;
+        }
+        head = head->next;
+    }
+
+    fwrite(buffer, 1, used, stdout);
+}
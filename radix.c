@@ -0,0 +1,332 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : radix.c
+ * Description   : Conversion between base-10^9 limbs and binary (2^32) words
+ * Functions     : bn_to_binary, bn_from_binary
+ *
+ * Algorithm     : Both directions are divide and conquer over the powers P[j] = (2^32)^(2^j),
+ *                 kept in base 10^9 and built by repeated squaring (powers_extend):
+ *
+ *                   binary -> limbs : w = high * P[j] + low, with low the bottom 2^j words.
+ *                                     Both halves are converted recursively and recombined
+ *                                     with one limb_mul and one limb_add.
+ *                   limbs -> binary : a = q * P[j] + r (limb_div), with P[j] about half the
+ *                                     length of a. r becomes exactly the bottom 2^j words and
+ *                                     q the words above them, both recursively.
+ *
+ *                 Below WORDS_BASECASE words / LIMBS_BASECASE limbs the conversion is a Horner
+ *                 loop (multiply by 2^32 or 10^9 and add), which is quadratic but has tiny
+ *                 constants. With the
+ *                 size-dispatched limb_mul / limb_div underneath, a conversion costs
+ *                 O(M(n) log n) instead of O(n^2): a 10M-digit number converts in well under
+ *                 a minute instead of tens of minutes.
+ *
+ * Scope         : Binary words hold the integer magnitude only; the sign is passed separately
+ *                 and numbers with a non-zero fractional part cannot be converted.
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+/* Below these sizes the quadratic Horner loop is faster than recursing (the limb side is
+   higher because its recursion pays for a division instead of a multiplication) */
+#define WORDS_BASECASE 32
+#define LIMBS_BASECASE 96
+
+/* P[j] = (2^32)^(2^j) for j < RADIX_MAX_LEVELS covers any addressable operand */
+#define RADIX_MAX_LEVELS 64
+
+/* Limbs needed for n words (32 * log10(2) / 9 = 1.0703 limbs per word) and words for n limbs
+   (9 * log2(10) / 32 = 0.9346 words per limb), both rounded up generously */
+#define LIMBS_FOR_WORDS(n) ((n) + (n) / 8 + 4)
+#define WORDS_FOR_LIMBS(n) ((n) - (n) / 16 + 4)
+
+/* Powers (2^32)^(2^j) in base 10^9, built on demand */
+typedef struct {
+    limb_t *value[RADIX_MAX_LEVELS];
+    size_t length[RADIX_MAX_LEVELS];
+    size_t count;
+} RadixPowers;
+
+/**
+ * @brief Make P[0] .. P[level] available
+ * @return SUCCESS on success, FAILURE on memory error
+ */
+static int powers_extend(RadixPowers *powers, size_t level)
+{
+    if (level >= RADIX_MAX_LEVELS)
+    {
+        return FAILURE;
+    }
+
+    if (powers->count == 0)
+    {
+        /* P[0] = 2^32 = 4 * 10^9 + 294967296 */
+        powers->value[0] = malloc(2 * sizeof(limb_t));
+        if (powers->value[0] == NULL)
+        {
+            return FAILURE;
+        }
+        powers->value[0][0] = 294967296u;
+        powers->value[0][1] = 4u;
+        powers->length[0] = 2;
+        powers->count = 1;
+    }
+
+    while (powers->count <= level)
+    {
+        size_t j = powers->count;
+        size_t n = powers->length[j - 1];
+
+        powers->value[j] = malloc(2 * n * sizeof(limb_t));
+        if (powers->value[j] == NULL
+            || limb_mul(powers->value[j], powers->value[j - 1], n, powers->value[j - 1], n) == FAILURE)
+        {
+            free(powers->value[j]);
+            return FAILURE;
+        }
+        powers->length[j] = limb_trimmed_length(powers->value[j], 2 * n);
+        powers->count++;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Release every power
+ */
+static void powers_free(RadixPowers *powers)
+{
+    for (size_t j = 0; j < powers->count; j++)
+    {
+        free(powers->value[j]);
+    }
+    powers->count = 0;
+}
+
+/**
+ * @brief Convert n words to limbs
+ * @param out Output with room for LIMBS_FOR_WORDS(n) limbs
+ * @param out_len Output: limbs written (no leading zero limbs)
+ */
+static int words_to_limbs(limb_t *out, size_t *out_len, const uint32_t *words, size_t n,
+                          RadixPowers *powers)
+{
+    while (n > 0 && words[n - 1] == 0)
+    {
+        n--;
+    }
+
+    if (n <= WORDS_BASECASE)
+    {
+        /* Horner: out = out * 2^32 + word, most significant word first */
+        size_t len = 0;
+        for (size_t i = n; i-- > 0; )
+        {
+            uint64_t carry = words[i];
+            for (size_t k = 0; k < len; k++)
+            {
+                uint64_t t = ((uint64_t)out[k] << 32) + carry;
+                out[k] = (limb_t)(t % LIMB_BASE);
+                carry = t / LIMB_BASE;
+            }
+            while (carry > 0)
+            {
+                out[len++] = (limb_t)(carry % LIMB_BASE);
+                carry /= LIMB_BASE;
+            }
+        }
+        STAT_ADD(limb_ops, n * n);
+        *out_len = len;
+        return SUCCESS;
+    }
+
+    /* Split at the largest power-of-two word count below n: half < n <= 2 * half */
+    size_t level = 0;
+    while (((size_t)2 << level) < n)
+    {
+        level++;
+    }
+    size_t half = (size_t)1 << level;
+
+    if (powers_extend(powers, level) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    limb_t *low = malloc(LIMBS_FOR_WORDS(half) * sizeof(limb_t));
+    limb_t *high = malloc(LIMBS_FOR_WORDS(n - half) * sizeof(limb_t));
+    size_t low_len = 0;
+    size_t high_len = 0;
+
+    int status = (low != NULL && high != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+    {
+        status = words_to_limbs(low, &low_len, words, half, powers);
+    }
+    if (status == SUCCESS)
+    {
+        status = words_to_limbs(high, &high_len, words + half, n - half, powers);
+    }
+
+    /* out = high * P[level] + low (low < P[level], so it never has more limbs) */
+    if (status == SUCCESS)
+    {
+        const limb_t *power = powers->value[level];
+        size_t power_len = powers->length[level];
+
+        status = limb_mul(out, high, high_len, power, power_len);
+        if (status == SUCCESS)
+        {
+            size_t len = high_len + power_len;
+            limb_add(out, out, len, low, low_len);
+            *out_len = limb_trimmed_length(out, len);
+        }
+    }
+
+    free(low);
+    free(high);
+    return status;
+}
+
+/**
+ * @brief Convert n limbs to exactly 'capacity' words (zero padded above the value)
+ */
+static int limbs_to_words(uint32_t *out, size_t capacity, const limb_t *a, size_t n,
+                          RadixPowers *powers)
+{
+    n = limb_trimmed_length(a, n);
+
+    if (n <= LIMBS_BASECASE)
+    {
+        /* Horner: out = out * 10^9 + limb, most significant limb first */
+        size_t len = 0;
+        for (size_t i = n; i-- > 0; )
+        {
+            uint64_t carry = a[i];
+            for (size_t k = 0; k < len; k++)
+            {
+                uint64_t t = (uint64_t)out[k] * LIMB_BASE + carry;
+                out[k] = (uint32_t)t;
+                carry = t >> 32;
+            }
+            if (carry > 0)
+            {
+                out[len++] = (uint32_t)carry;
+            }
+        }
+        STAT_ADD(limb_ops, n * n);
+        memset(out + len, 0, (capacity - len) * sizeof(uint32_t));
+        return SUCCESS;
+    }
+
+    /* Divide by the largest P[level] of at most half the length of a */
+    size_t level = 0;
+    for (;;)
+    {
+        if (powers_extend(powers, level + 1) == FAILURE)
+        {
+            return FAILURE;
+        }
+        if (2 * powers->length[level + 1] > n + 1)
+        {
+            break;
+        }
+        level++;
+    }
+
+    const limb_t *power = powers->value[level];
+    size_t power_len = powers->length[level];
+    size_t half = (size_t)1 << level;
+    size_t q_len = n - power_len + 1;
+
+    limb_t *q = malloc(q_len * sizeof(limb_t));
+    limb_t *r = malloc(power_len * sizeof(limb_t));
+
+    int status = (q != NULL && r != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+    {
+        status = limb_div(q, r, a, n, power, power_len);
+    }
+    if (status == SUCCESS)
+    {
+        status = limbs_to_words(out, half, r, power_len, powers);
+    }
+    if (status == SUCCESS)
+    {
+        status = limbs_to_words(out + half, capacity - half, q, q_len, powers);
+    }
+
+    free(q);
+    free(r);
+    return status;
+}
+
+/**
+ * Integer magnitude of a BigNumber as 32-bit words, least significant first
+ */
+int bn_to_binary(const BigNumber *num, uint32_t **words, size_t *count)
+{
+    *words = NULL;
+    *count = 0;
+
+    /* Strip the fractional digits, which must all be zero */
+    BigNumber integer;
+    bn_init(&integer);
+    if (bn_to_integer(num, &integer) == FAILURE)
+    {
+        return FAILURE;
+    }
+    size_t n = integer.length;
+
+    size_t capacity = WORDS_FOR_LIMBS(n);
+    uint32_t *out = malloc(capacity * sizeof(uint32_t));
+    RadixPowers powers = { .count = 0 };
+
+    int status = (out != NULL) ? limbs_to_words(out, capacity, integer.limbs, n, &powers) : FAILURE;
+
+    powers_free(&powers);
+    bn_free(&integer);
+
+    if (status == FAILURE)
+    {
+        free(out);
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    while (capacity > 0 && out[capacity - 1] == 0)
+    {
+        capacity--;
+    }
+    *words = out;
+    *count = capacity;
+    return SUCCESS;
+}
+
+/**
+ * Set a BigNumber to the integer given by 32-bit words, least significant first
+ */
+int bn_from_binary(BigNumber *num, const uint32_t *words, size_t count, int negative)
+{
+    RadixPowers powers = { .count = 0 };
+
+    int status = bn_reserve(num, LIMBS_FOR_WORDS(count));
+    if (status == SUCCESS)
+    {
+        status = words_to_limbs(num->limbs, &num->length, words, count, &powers);
+    }
+    powers_free(&powers);
+
+    if (status == FAILURE)
+    {
+        num->length = 0;
+        num->is_negative = FALSE;
+        num->decimal_places = 0;
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    num->is_negative = negative;
+    num->decimal_places = 0;
+    bn_normalize(num);
+    return SUCCESS;
+}
@@ -17,6 +17,7 @@ Dlist* remove_dot(Dlist **head)
     }
 
     /* Search for the decimal point */
+    STAT_ADD(list_traversals, 1);
     Dlist *temp = *head;
     while (temp != NULL && temp->data != '.')
     {
@@ -51,7 +52,7 @@ Dlist* remove_dot(Dlist **head)
     }
 
     /* Free the decimal point node */
-    free(temp);
+    node_free(temp);
     
     return prev_node;
 }
\ No newline at end of file
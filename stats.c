@@ -0,0 +1,198 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : stats.c
+ * Description   : Optional per-operation statistics (node traffic, list walks, digit work, time)
+ * Functions     : stats_enabled, stats_clock_ns, stats_op_begin, stats_op_end, stats_phase_end,
+ *                 stats_get, stats_reset, stats_flush, stats_total, stats_print
+ *
+ * Design        : The hot paths are annotated with the STAT_* macros from apc.h. Unless the
+ *                 library is compiled with -DAPC_STATS (make stats) the macros expand to
+ *                 nothing, so the annotations cost nothing and every counter here stays zero.
+ *
+ *                 Counters live in a thread-local OpStats, so instrumented code never takes a
+ *                 lock. stats_flush() folds the calling thread's counters into process totals
+ *                 (the batch workers do this after every task) and stats_total() reports those
+ *                 totals plus the caller's own counters (the peak of live list nodes is the
+ *                 highest of any thread rather than a sum).
+ *
+ *   Nesting     : An operation may call others (the list division subtracts repeatedly), so
+ *                 only the outermost operation of a thread is timed and counted, and phases are
+ *                 only recorded for it; counters such as node allocations always accumulate.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <pthread.h>
+#include <time.h>
+
+_Thread_local OpStats stats_local;
+
+/* Depth of nested operations on this thread */
+static _Thread_local int op_depth;
+
+/* Counters flushed by threads (stats_flush) */
+static OpStats stats_flushed;
+static pthread_mutex_t flushed_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *const op_names[STAT_OP_COUNT] = {
+    "parse", "format", "add", "sub", "mul", "div", "pow", "mod", "root", "gcd"
+};
+
+static const char *const phase_names[STAT_PHASE_COUNT] = {
+    "align", "remove_dot", "kernel", "normalize"
+};
+
+/**
+ * @brief total += part
+ */
+static void stats_accumulate(OpStats *total, const OpStats *part)
+{
+    total->node_allocs += part->node_allocs;
+    total->node_frees += part->node_frees;
+    total->node_recycled += part->node_recycled;
+    total->node_slabs += part->node_slabs;
+    if (part->node_peak_live > total->node_peak_live)
+    {
+        total->node_peak_live = part->node_peak_live;
+    }
+    total->list_traversals += part->list_traversals;
+    total->digit_ops += part->digit_ops;
+    total->limb_ops += part->limb_ops;
+
+    for (int i = 0; i < STAT_OP_COUNT; i++)
+    {
+        total->op_calls[i] += part->op_calls[i];
+        total->op_ns[i] += part->op_ns[i];
+    }
+    for (int i = 0; i < STAT_PHASE_COUNT; i++)
+    {
+        total->phase_ns[i] += part->phase_ns[i];
+    }
+}
+
+/**
+ * Whether the library was built with statistics
+ */
+int stats_enabled(void)
+{
+#ifdef APC_STATS
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t stats_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Enter an operation; returns its start time
+ */
+uint64_t stats_op_begin(void)
+{
+    op_depth++;
+    return stats_clock_ns();
+}
+
+/**
+ * Leave an operation; only the outermost one is recorded
+ */
+void stats_op_end(StatOp op, uint64_t start)
+{
+    if (--op_depth == 0)
+    {
+        stats_local.op_calls[op]++;
+        stats_local.op_ns[op] += stats_clock_ns() - start;
+    }
+}
+
+/**
+ * Record a phase of the current (outermost) operation
+ */
+void stats_phase_end(StatPhase phase, uint64_t start)
+{
+    if (op_depth <= 1)
+    {
+        stats_local.phase_ns[phase] += stats_clock_ns() - start;
+    }
+}
+
+/**
+ * Counters of the calling thread
+ */
+void stats_get(OpStats *stats)
+{
+    *stats = stats_local;
+}
+
+/**
+ * Clear the calling thread's counters
+ */
+void stats_reset(void)
+{
+    memset(&stats_local, 0, sizeof(stats_local));
+}
+
+/**
+ * Move the calling thread's counters into the process totals
+ */
+void stats_flush(void)
+{
+    pthread_mutex_lock(&flushed_lock);
+    stats_accumulate(&stats_flushed, &stats_local);
+    pthread_mutex_unlock(&flushed_lock);
+
+    stats_reset();
+}
+
+/**
+ * Flushed process totals plus the calling thread's counters
+ */
+void stats_total(OpStats *stats)
+{
+    pthread_mutex_lock(&flushed_lock);
+    *stats = stats_flushed;
+    pthread_mutex_unlock(&flushed_lock);
+
+    stats_accumulate(stats, &stats_local);
+}
+
+/**
+ * Print counters as a table
+ */
+void stats_print(FILE *out, const OpStats *stats)
+{
+    fprintf(out, "%-12s %12s %14s %12s\n", "operation", "calls", "total ms", "avg us");
+    for (int i = 0; i < STAT_OP_COUNT; i++)
+    {
+        if (stats->op_calls[i] == 0)
+        {
+            continue;
+        }
+        fprintf(out, "%-12s %12llu %14.3f %12.3f\n", op_names[i],
+                (unsigned long long)stats->op_calls[i], (double)stats->op_ns[i] / 1e6,
+                (double)stats->op_ns[i] / 1e3 / (double)stats->op_calls[i]);
+    }
+
+    fprintf(out, "\n%-12s %12s %14s\n", "phase", "", "total ms");
+    for (int i = 0; i < STAT_PHASE_COUNT; i++)
+    {
+        fprintf(out, "%-12s %12s %14.3f\n", phase_names[i], "", (double)stats->phase_ns[i] / 1e6);
+    }
+
+    fprintf(out, "\n%-24s %14llu\n", "node allocations", (unsigned long long)stats->node_allocs);
+    fprintf(out, "%-24s %14llu\n", "node frees", (unsigned long long)stats->node_frees);
+    fprintf(out, "%-24s %14llu\n", "nodes recycled", (unsigned long long)stats->node_recycled);
+    fprintf(out, "%-24s %14llu\n", "node slabs", (unsigned long long)stats->node_slabs);
+    fprintf(out, "%-24s %14llu\n", "peak live nodes", (unsigned long long)stats->node_peak_live);
+    fprintf(out, "%-24s %14llu\n", "list traversals", (unsigned long long)stats->list_traversals);
+    fprintf(out, "%-24s %14llu\n", "digit operations", (unsigned long long)stats->digit_ops);
+    fprintf(out, "%-24s %14llu\n", "limb operations", (unsigned long long)stats->limb_ops);
+}
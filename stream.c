@@ -0,0 +1,826 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : stream.c
+ * Description   : Out-of-core addition and subtraction of numbers stored in files
+ * Function      : run_stream
+ * Input Params  : options - stream_path names the output file, output_format selects decimal or binary
+ *                 path1, path2 - Operand files (decimal text or binary number files)
+ *                 operator - '+' or '-'
+ * Return Value  : SUCCESS if the result was written, FAILURE otherwise (the reason is printed)
+ *
+ * Operands      : Each file is recognised from its first bytes: an "APCN" header is a binary
+ *                 number file (bn_binary.c), anything else must hold one decimal number
+ *                 ([-]digits[.digits], optionally followed by whitespace). Text operands are
+ *                 validated in a forward pre-scan that also finds the sign, the decimal point
+ *                 and the digit counts.
+ *
+ * Algorithm     : Memory stays bounded by STREAM_CHUNK_LIMBS / STREAM_CHUNK_BYTES whatever the
+ *                 operand sizes, in two passes over the digits:
+ *
+ *                   1. Both operands are produced least significant limb first, aligned to the
+ *                      larger number of decimal places: text files are read backwards in chunks
+ *                      with virtual trailing zeros, binary files forwards with the shift by 10^s
+ *                      applied as a running carry. The magnitudes are added (or subtracted)
+ *                      chunk by chunk with the carry (borrow) handed from one chunk to the next,
+ *                      and the raw result limbs go to "<output>.limbs". The pass also records
+ *                      the lowest non-zero limb, the highest non-zero limb and the highest limb
+ *                      that is not 10^9 - 1.
+ *                   2. The result is written from the raw limbs. A borrow out of the top limb
+ *                      means |b| > |a|: the raw limbs then hold 10^(9n) - (|b| - |a|), and the
+ *                      true magnitude is recovered limb by limb on the fly (zero below the lowest
+ *                      non-zero limb k, 10^9 - x at k, 10^9 - 1 - x above it), so no second
+ *                      subtraction or comparison pass is needed. Binary output copies the limbs
+ *                      forwards behind a header whose length is already known; decimal output
+ *                      reads them backwards, dropping leading zeros and trailing fractional zeros.
+ *
+ * Files         : The temporary "<output>.limbs" file lives next to the output so it is on a
+ *                 filesystem with room for the result; it is removed afterwards, and the output
+ *                 is removed as well when the operation fails.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <ctype.h>
+#include <sys/types.h>
+
+/* Limbs per operand and output chunk (256 KB each) */
+#define STREAM_CHUNK_LIMBS (1u << 16)
+
+/* Bytes per text read and decimal output write */
+#define STREAM_CHUNK_BYTES (1u << 16)
+
+/* Suffix of the raw result limbs written by pass 1 */
+#define STREAM_TEMP_SUFFIX ".limbs"
+
+/* Powers of ten that fit in a single limb, used for the decimal shift of binary operands */
+static const limb_t POW10[LIMB_DIGITS] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u
+};
+
+/* Decimal operand read backwards from its file */
+typedef struct {
+    off_t begin;             /* Offset of the first digit (or '.') */
+    off_t end;               /* Offset after the last digit (or '.') */
+    off_t dot;               /* Offset of the decimal point (-1 if none) */
+    off_t cursor;            /* Next byte is read from cursor - 1 */
+    uint64_t padding;        /* Virtual trailing zeros still to produce */
+    char *buffer;            /* File bytes [buffer_start, buffer_start + buffer_length) */
+    off_t buffer_start;
+    size_t buffer_length;
+} TextOperand;
+
+/* Binary operand read forwards, scaled by 10^shift */
+typedef struct {
+    BinaryReader reader;
+    uint64_t zero_limbs;     /* Whole limbs of the shift still to produce */
+    limb_t multiplier;       /* 10^(shift % 9) */
+    limb_t carry;            /* Carried into the next limb by the multiplier */
+    int carry_done;          /* The final carry limb has been produced */
+} BinaryOperand;
+
+/* One operand file as a stream of aligned limbs, least significant first */
+typedef struct {
+    FILE *file;              /* Text operands only */
+    int is_binary;
+    int is_negative;
+    int decimal_places;
+    uint64_t length;         /* Aligned limbs, including the shift */
+    int failed;              /* Read error */
+    TextOperand text;
+    BinaryOperand binary;
+} StreamOperand;
+
+/* What pass 1 learned about the raw result limbs */
+typedef struct {
+    uint64_t length;         /* Raw limbs in the temporary file */
+    uint64_t lowest;         /* Index of the lowest non-zero raw limb */
+    uint64_t highest;        /* Index of the highest non-zero raw limb */
+    uint64_t highest_not_max;/* Index of the highest raw limb != LIMB_BASE - 1 */
+    int any_nonzero;         /* Some raw limb is non-zero */
+    int any_not_max;         /* Some raw limb is != LIMB_BASE - 1 */
+    int complement;          /* Raw limbs hold 10^(9 * length) - magnitude */
+    int is_negative;
+    int decimal_places;
+    uint64_t magnitude_length; /* Limbs of the magnitude without leading zeros */
+} StreamResult;
+
+/**
+ * @brief Validate a decimal text operand and find its sign, digits and decimal point
+ * @return SUCCESS if the file holds one decimal number, FAILURE otherwise
+ */
+static int text_scan(StreamOperand *op)
+{
+    TextOperand *t = &op->text;
+    off_t offset = 0;
+    off_t digits = 0;
+    int started = FALSE;     /* Sign or first digit seen */
+    int finished = FALSE;    /* Trailing whitespace reached */
+    size_t n;
+
+    t->begin = -1;
+    t->end = -1;
+    t->dot = -1;
+
+    rewind(op->file);
+    while ((n = fread(t->buffer, 1, STREAM_CHUNK_BYTES, op->file)) > 0)
+    {
+        for (size_t i = 0; i < n; i++, offset++)
+        {
+            char c = t->buffer[i];
+
+            if (finished || (isspace((unsigned char)c) && started))
+            {
+                if (!isspace((unsigned char)c))
+                {
+                    return FAILURE;
+                }
+                finished = TRUE;
+            }
+            else if (c == '-' && !started)
+            {
+                op->is_negative = TRUE;
+                started = TRUE;
+            }
+            else if ((c >= '0' && c <= '9') || (c == '.' && t->dot < 0))
+            {
+                if (t->begin < 0)
+                {
+                    t->begin = offset;
+                }
+                if (c == '.')
+                {
+                    t->dot = offset;
+                }
+                else
+                {
+                    digits++;
+                }
+                t->end = offset + 1;
+                started = TRUE;
+            }
+            else
+            {
+                return FAILURE;
+            }
+        }
+    }
+
+    if (ferror(op->file) || digits == 0)
+    {
+        return FAILURE;
+    }
+
+    off_t fraction = (t->dot >= 0) ? t->end - t->dot - 1 : 0;
+    if (fraction > INT_MAX)
+    {
+        return FAILURE;
+    }
+    op->decimal_places = (int)fraction;
+    return SUCCESS;
+}
+
+/**
+ * @brief Next digit of a text operand, least significant first (0 past the most significant)
+ */
+static limb_t text_next_digit(StreamOperand *op)
+{
+    TextOperand *t = &op->text;
+
+    if (t->padding > 0)
+    {
+        t->padding--;
+        return 0;
+    }
+
+    while (t->cursor > t->begin)
+    {
+        off_t position = --t->cursor;
+        if (position == t->dot)
+        {
+            continue;
+        }
+
+        if (position < t->buffer_start || position >= t->buffer_start + (off_t)t->buffer_length)
+        {
+            /* Load the block that ends just after this byte */
+            off_t start = position + 1 - (off_t)STREAM_CHUNK_BYTES;
+            if (start < t->begin)
+            {
+                start = t->begin;
+            }
+            size_t size = (size_t)(position + 1 - start);
+            if (fseeko(op->file, start, SEEK_SET) != 0 || fread(t->buffer, 1, size, op->file) != size)
+            {
+                op->failed = TRUE;
+                t->cursor = t->begin;
+                return 0;
+            }
+            t->buffer_start = start;
+            t->buffer_length = size;
+        }
+
+        return (limb_t)(t->buffer[position - t->buffer_start] - '0');
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Rewind an opened operand to produce limbs aligned to 'decimal_places' (>= its own)
+ */
+static void operand_align(StreamOperand *op, int decimal_places)
+{
+    uint64_t shift = (uint64_t)(decimal_places - op->decimal_places);
+
+    if (op->is_binary)
+    {
+        BinaryOperand *b = &op->binary;
+        b->zero_limbs = shift / LIMB_DIGITS;
+        b->multiplier = POW10[shift % LIMB_DIGITS];
+        b->carry = 0;
+        b->carry_done = FALSE;
+        op->length = b->reader.limb_count + b->zero_limbs + ((b->multiplier > 1) ? 1 : 0);
+    }
+    else
+    {
+        TextOperand *t = &op->text;
+        uint64_t digits = (uint64_t)(t->end - t->begin) - ((t->dot >= 0) ? 1 : 0) + shift;
+        t->padding = shift;
+        t->cursor = t->end;
+        t->buffer_start = 0;
+        t->buffer_length = 0;
+        op->length = (digits + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    }
+}
+
+/**
+ * @brief Open an operand file and read its sign and decimal places
+ * @return SUCCESS on success, FAILURE if the file cannot be read or is not a number
+ */
+static int operand_open(StreamOperand *op, const char *path)
+{
+    memset(op, 0, sizeof(*op));
+
+    op->file = fopen(path, "rb");
+    if (op->file == NULL)
+    {
+        set_last_error("Cannot open operand file");
+        return FAILURE;
+    }
+
+    char magic[4];
+    if (fread(magic, 1, sizeof(magic), op->file) == sizeof(magic) && memcmp(magic, "APCN", 4) == 0)
+    {
+        fclose(op->file);
+        op->file = NULL;
+        op->is_binary = TRUE;
+
+        if (binary_reader_open(&op->binary.reader, path) == FAILURE)
+        {
+            return FAILURE;
+        }
+        op->is_negative = op->binary.reader.is_negative;
+        op->decimal_places = op->binary.reader.decimal_places;
+        return SUCCESS;
+    }
+
+    op->text.buffer = malloc(STREAM_CHUNK_BYTES);
+    if (op->text.buffer == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+    if (text_scan(op) == FAILURE)
+    {
+        set_last_error("Operand file is not a decimal or binary number");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Fill exactly n limbs with the next aligned limbs of an operand (zeros past its end)
+ */
+static void operand_read(StreamOperand *op, limb_t *limbs, size_t n)
+{
+    size_t filled = 0;
+
+    if (op->is_binary)
+    {
+        BinaryOperand *b = &op->binary;
+
+        for (; filled < n && b->zero_limbs > 0; filled++, b->zero_limbs--)
+        {
+            limbs[filled] = 0;
+        }
+
+        size_t got = binary_reader_read(&b->reader, limbs + filled, n - filled);
+        if (b->multiplier > 1)
+        {
+            for (size_t i = filled; i < filled + got; i++)
+            {
+                uint64_t t = (uint64_t)limbs[i] * b->multiplier + b->carry;
+                limbs[i] = (limb_t)(t % LIMB_BASE);
+                b->carry = (limb_t)(t / LIMB_BASE);
+            }
+        }
+        filled += got;
+
+        if (filled < n && !b->carry_done)
+        {
+            limbs[filled++] = b->carry;
+            b->carry_done = TRUE;
+        }
+        op->failed = b->reader.failed;
+    }
+    else
+    {
+        for (; filled < n; filled++)
+        {
+            limb_t limb = 0;
+            for (int k = 0; k < LIMB_DIGITS; k++)
+            {
+                limb += text_next_digit(op) * POW10[k];
+            }
+            limbs[filled] = limb;
+        }
+    }
+
+    for (; filled < n; filled++)
+    {
+        limbs[filled] = 0;
+    }
+}
+
+/**
+ * @brief Close an operand; a binary operand read to the end must match its checksum
+ */
+static int operand_close(StreamOperand *op)
+{
+    int status = SUCCESS;
+
+    if (op->is_binary)
+    {
+        /* A bad limb or read error is reported as a checksum mismatch */
+        status = binary_reader_close(&op->binary.reader);
+    }
+    else
+    {
+        if (op->failed)
+        {
+            set_last_error("Cannot read operand file");
+            status = FAILURE;
+        }
+        if (op->file != NULL)
+        {
+            fclose(op->file);
+        }
+        free(op->text.buffer);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Pass 1: add or subtract the aligned magnitudes chunk by chunk into the temporary file
+ * @param subtract TRUE for |a| - |b|, FALSE for |a| + |b|
+ */
+static int stream_pass1(StreamOperand *a, StreamOperand *b, int subtract, FILE *temp,
+                        limb_t *chunk_a, limb_t *chunk_b, StreamResult *result)
+{
+    uint64_t n = (a->length > b->length) ? a->length : b->length;
+    limb_t carry = 0;
+
+    for (uint64_t base = 0; base < n; base += STREAM_CHUNK_LIMBS)
+    {
+        size_t count = (n - base < STREAM_CHUNK_LIMBS) ? (size_t)(n - base) : STREAM_CHUNK_LIMBS;
+        operand_read(a, chunk_a, count);
+        operand_read(b, chunk_b, count);
+        if (a->failed || b->failed)
+        {
+            return FAILURE;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            limb_t x;
+            if (subtract)
+            {
+                int64_t d = (int64_t)chunk_a[i] - chunk_b[i] - carry;
+                carry = (d < 0) ? 1 : 0;
+                x = (limb_t)(d + (carry ? LIMB_BASE : 0));
+            }
+            else
+            {
+                limb_t s = chunk_a[i] + chunk_b[i] + carry;
+                carry = (s >= LIMB_BASE) ? 1 : 0;
+                x = s - (carry ? LIMB_BASE : 0);
+            }
+            chunk_a[i] = x;
+
+            if (x != 0)
+            {
+                if (!result->any_nonzero)
+                {
+                    result->lowest = base + i;
+                    result->any_nonzero = TRUE;
+                }
+                result->highest = base + i;
+            }
+            if (x != LIMB_BASE - 1)
+            {
+                result->highest_not_max = base + i;
+                result->any_not_max = TRUE;
+            }
+        }
+        STAT_ADD(limb_ops, count);
+
+        if (fwrite(chunk_a, sizeof(limb_t), count, temp) != count)
+        {
+            set_last_error("Cannot write temporary result file");
+            return FAILURE;
+        }
+    }
+
+    result->length = n;
+    if (carry && !subtract)
+    {
+        /* Carry out of the top limb: one more limb holding 1 */
+        limb_t one = 1;
+        if (fwrite(&one, sizeof(limb_t), 1, temp) != 1)
+        {
+            set_last_error("Cannot write temporary result file");
+            return FAILURE;
+        }
+        if (!result->any_nonzero)
+        {
+            result->lowest = n;
+            result->any_nonzero = TRUE;
+        }
+        result->highest = n;
+        result->highest_not_max = n;
+        result->any_not_max = TRUE;
+        result->length = n + 1;
+    }
+    result->complement = (carry && subtract);
+
+    if (fflush(temp) != 0)
+    {
+        set_last_error("Cannot write temporary result file");
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Limbs of the magnitude without leading zeros (0 for a zero result)
+ */
+static uint64_t magnitude_length(const StreamResult *result)
+{
+    if (!result->any_nonzero)
+    {
+        return 0;
+    }
+    if (!result->complement)
+    {
+        return result->highest + 1;
+    }
+
+    /* Above the lowest non-zero limb k the magnitude is 10^9 - 1 - x, zero where x is all nines */
+    if (result->any_not_max && result->highest_not_max > result->lowest)
+    {
+        return result->highest_not_max + 1;
+    }
+    return result->lowest + 1;
+}
+
+/**
+ * @brief Turn raw limbs [index, index + n) into magnitude limbs
+ */
+static void to_magnitude(const StreamResult *result, uint64_t index, limb_t *limbs, size_t n)
+{
+    if (!result->complement)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (index + i == result->lowest)
+        {
+            limbs[i] = LIMB_BASE - limbs[i];
+        }
+        else if (index + i > result->lowest)
+        {
+            limbs[i] = LIMB_BASE - 1 - limbs[i];
+        }
+    }
+}
+
+/**
+ * @brief Read raw limbs [index, index + n) from the temporary file as magnitude limbs
+ */
+static int read_magnitude(FILE *temp, const StreamResult *result, uint64_t index, limb_t *limbs, size_t n)
+{
+    if (fseeko(temp, (off_t)(index * sizeof(limb_t)), SEEK_SET) != 0
+        || fread(limbs, sizeof(limb_t), n, temp) != n)
+    {
+        set_last_error("Cannot read temporary result file");
+        return FAILURE;
+    }
+
+    to_magnitude(result, index, limbs, n);
+    return SUCCESS;
+}
+
+/**
+ * @brief Pass 2, binary output: copy the magnitude limbs forwards behind the header
+ */
+static int write_binary_result(FILE *temp, const StreamResult *result, const char *path, limb_t *chunk)
+{
+    BinaryWriter writer;
+    if (binary_writer_open(&writer, path, result->is_negative, result->decimal_places,
+                           result->magnitude_length) == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    int status = SUCCESS;
+    for (uint64_t base = 0; base < result->magnitude_length && status == SUCCESS; base += STREAM_CHUNK_LIMBS)
+    {
+        uint64_t left = result->magnitude_length - base;
+        size_t count = (left < STREAM_CHUNK_LIMBS) ? (size_t)left : STREAM_CHUNK_LIMBS;
+
+        status = read_magnitude(temp, result, base, chunk, count);
+        if (status == SUCCESS)
+        {
+            status = binary_writer_write(&writer, chunk, count);
+        }
+    }
+
+    if (binary_writer_close(&writer) == FAILURE)
+    {
+        status = FAILURE;
+    }
+    return status;
+}
+
+/**
+ * @brief Pass 2, decimal output: read the magnitude limbs backwards and write the digits
+ *
+ * Digit position p counts from the least significant digit of the aligned result, so the
+ * decimal point sits between positions decimal_places and decimal_places - 1. Positions above
+ * the highest limb are virtual zeros, which gives "0.000123" its leading zeros.
+ */
+static int write_decimal_result(FILE *temp, const StreamResult *result, const char *path, limb_t *chunk)
+{
+    uint64_t dp = (uint64_t)result->decimal_places;
+    uint64_t limbs = result->magnitude_length;
+
+    /* Lowest non-zero digit: trailing fractional zeros below it are not written */
+    uint64_t lowest_digit = dp;
+    if (limbs > 0)
+    {
+        limb_t low;
+        if (read_magnitude(temp, result, result->lowest, &low, 1) == FAILURE)
+        {
+            return FAILURE;
+        }
+        lowest_digit = result->lowest * LIMB_DIGITS;
+        while (low % 10 == 0)
+        {
+            low /= 10;
+            lowest_digit++;
+        }
+    }
+    uint64_t last = (lowest_digit < dp) ? lowest_digit : dp;
+
+    uint64_t top = limbs * LIMB_DIGITS;
+    if (top < dp + 1)
+    {
+        top = dp + 1;
+    }
+
+    char *out = malloc(STREAM_CHUNK_BYTES);
+    if (out == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return FAILURE;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        free(out);
+        set_last_error("Cannot open output file");
+        return FAILURE;
+    }
+
+    size_t used = 0;
+    int status = SUCCESS;
+    int leading = TRUE;      /* Still skipping leading integer zeros */
+    if (result->is_negative)
+    {
+        out[used++] = '-';
+    }
+
+    /* Limbs are read in chunks from the top; 'slot' holds the digits of the current limb */
+    char slot[LIMB_DIGITS];
+    uint64_t chunk_base = UINT64_MAX;
+    uint64_t slot_limb = UINT64_MAX;
+
+    for (uint64_t p = top; p-- > last && status == SUCCESS; )
+    {
+        uint64_t index = p / LIMB_DIGITS;
+        if (index != slot_limb)
+        {
+            limb_t limb = 0;
+            if (index < limbs)
+            {
+                if (chunk_base == UINT64_MAX || index < chunk_base)
+                {
+                    chunk_base = (index + 1 > STREAM_CHUNK_LIMBS) ? index + 1 - STREAM_CHUNK_LIMBS : 0;
+                    status = read_magnitude(temp, result, chunk_base, chunk, (size_t)(index + 1 - chunk_base));
+                }
+                limb = chunk[index - chunk_base];
+            }
+            limb_to_digits(slot, limb);
+            slot_limb = index;
+        }
+
+        char digit = slot[LIMB_DIGITS - 1 - p % LIMB_DIGITS];
+        if (leading && digit == '0' && p > dp)
+        {
+            continue;
+        }
+        leading = FALSE;
+
+        if (p + 1 == dp)
+        {
+            out[used++] = '.';
+        }
+        out[used++] = digit;
+
+        /* Room for a digit and a '.' next time */
+        if (used + 2 > STREAM_CHUNK_BYTES)
+        {
+            if (fwrite(out, 1, used, file) != used)
+            {
+                set_last_error("Cannot write output file");
+                status = FAILURE;
+            }
+            used = 0;
+        }
+    }
+
+    out[used++] = '\n';
+    if (status == SUCCESS && fwrite(out, 1, used, file) != used)
+    {
+        set_last_error("Cannot write output file");
+        status = FAILURE;
+    }
+    if (fclose(file) != 0 && status == SUCCESS)
+    {
+        set_last_error("Cannot write output file");
+        status = FAILURE;
+    }
+
+    free(out);
+    return status;
+}
+
+/**
+ * @brief Both passes over two opened operands
+ */
+static int stream_operate(StreamOperand *a, StreamOperand *b, char operator,
+                          const CalcOptions *options, const char *temp_path)
+{
+    StreamResult result;
+    memset(&result, 0, sizeof(result));
+
+    result.decimal_places = (a->decimal_places > b->decimal_places) ? a->decimal_places : b->decimal_places;
+    operand_align(a, result.decimal_places);
+    operand_align(b, result.decimal_places);
+
+    /* a + b with equal signs and a - b with different signs add the magnitudes */
+    int subtract = ((operator == '-') == (a->is_negative == b->is_negative));
+
+    limb_t *chunk_a = malloc(STREAM_CHUNK_LIMBS * sizeof(limb_t));
+    limb_t *chunk_b = malloc(STREAM_CHUNK_LIMBS * sizeof(limb_t));
+    FILE *temp = fopen(temp_path, "w+b");
+
+    int status = SUCCESS;
+    if (chunk_a == NULL || chunk_b == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        status = FAILURE;
+    }
+    else if (temp == NULL)
+    {
+        set_last_error("Cannot create temporary result file");
+        status = FAILURE;
+    }
+
+    if (status == SUCCESS)
+    {
+        status = stream_pass1(a, b, subtract, temp, chunk_a, chunk_b, &result);
+    }
+
+    /* Both operands must have been read completely and intact */
+    if (operand_close(a) == FAILURE)
+    {
+        status = FAILURE;
+    }
+    if (operand_close(b) == FAILURE)
+    {
+        status = FAILURE;
+    }
+
+    if (status == SUCCESS)
+    {
+        /* The sign of a, flipped when |b| turned out larger */
+        result.magnitude_length = magnitude_length(&result);
+        result.is_negative = (result.magnitude_length > 0) && (a->is_negative != result.complement);
+
+        if (options->output_format == NUMBER_FORMAT_BINARY)
+        {
+            status = write_binary_result(temp, &result, options->stream_path, chunk_a);
+        }
+        else
+        {
+            status = write_decimal_result(temp, &result, options->stream_path, chunk_a);
+        }
+
+        /* Never leave a partial result behind */
+        if (status == FAILURE)
+        {
+            remove(options->stream_path);
+        }
+    }
+
+    if (temp != NULL)
+    {
+        fclose(temp);
+        remove(temp_path);
+    }
+    free(chunk_a);
+    free(chunk_b);
+    return status;
+}
+
+/**
+ * Add or subtract two operand files into options->stream_path
+ */
+int run_stream(const CalcOptions *options, const char *path1, char operator, const char *path2)
+{
+    clear_last_error();
+    STAT_OP_BEGIN(op_start);
+
+    size_t length = strlen(options->stream_path);
+    char *temp_path = malloc(length + sizeof(STREAM_TEMP_SUFFIX));
+    StreamOperand a;
+    StreamOperand b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+
+    int status = SUCCESS;
+    if (temp_path == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        status = FAILURE;
+    }
+    else
+    {
+        memcpy(temp_path, options->stream_path, length);
+        memcpy(temp_path + length, STREAM_TEMP_SUFFIX, sizeof(STREAM_TEMP_SUFFIX));
+
+        status = operand_open(&a, path1);
+        if (status == SUCCESS)
+        {
+            status = operand_open(&b, path2);
+        }
+    }
+
+    if (status == SUCCESS)
+    {
+        status = stream_operate(&a, &b, operator, options, temp_path);
+    }
+    else
+    {
+        /* Keep the reason the operand could not be opened */
+        const char *reason = last_error();
+        operand_close(&a);
+        operand_close(&b);
+        set_last_error(reason);
+    }
+
+    if (status == FAILURE)
+    {
+        fprintf(stderr, "[ERROR]: %s\n", last_error());
+    }
+
+    free(temp_path);
+    STAT_OP_END((operator == '+') ? STAT_OP_ADD : STAT_OP_SUB, op_start);
+    return status;
+}
@@ -17,7 +17,7 @@
 
 #include "apc.h"
 
-int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
+static int subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
 {
     /* Validate input parameters */
     if (head1 == NULL || tail1 == NULL || head2 == NULL || tail2 == NULL || headR == NULL)
@@ -26,6 +26,7 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
     }
 
     /* Step 1: Count decimal places in both numbers */
+    STAT_PHASE_BEGIN(align_start);
     int decimal1 = count_decimal_places(*head1);
     int decimal2 = count_decimal_places(*head2);
     int max_decimal = (decimal1 > decimal2) ? decimal1 : decimal2;
@@ -46,11 +47,15 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_ALIGN, align_start);
+
     /* Step 3: Remove decimal points */
+    STAT_PHASE_BEGIN(remove_dot_start);
     remove_dot(head1);
     remove_dot(head2);
     
     /* Update tail pointers after removing decimal */
+    STAT_ADD(list_traversals, 2);
     Dlist *temp = *head1;
     while (temp != NULL && temp->next != NULL)
     {
@@ -64,8 +69,11 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         temp = temp->next;
     }
     *tail2 = temp;
+    STAT_PHASE_END(STAT_PHASE_REMOVE_DOT, remove_dot_start);
 
     /* Step 4: Perform subtraction from right to left */
+    STAT_PHASE_BEGIN(kernel_start);
+    STAT_ADD(list_traversals, 1);
     Dlist *t1 = *tail1;
     Dlist *t2 = *tail2;
     int borrow = 0;
@@ -90,6 +98,7 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         }
 
         int result = val1 - val2;
+        STAT_ADD(digit_ops, 1);
 
         if (insert_at_first(headR, result) == FAILURE)
         {
@@ -100,13 +109,17 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         if (t2 != NULL) t2 = t2->prev;
     }
 
+    STAT_PHASE_END(STAT_PHASE_KERNEL, kernel_start);
+
     /* Step 5: Insert decimal point if needed */
+    STAT_PHASE_BEGIN(normalize_start);
     if (max_decimal > 0)
     {
         /* Find the position to insert decimal from the right */
         Dlist *temp_r = *headR;
         
         /* Move to the end */
+        STAT_ADD(list_traversals, 1);
         while (temp_r != NULL && temp_r->next != NULL)
         {
             temp_r = temp_r->next;
@@ -121,7 +134,7 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         /* Insert decimal point */
         if (temp_r != NULL)
         {
-            Dlist *decimal_node = malloc(sizeof(Dlist));
+            Dlist *decimal_node = node_alloc();
             if (decimal_node == NULL)
             {
                 return FAILURE;
@@ -140,6 +153,7 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
     }
 
     /* Update tailR pointer */
+    STAT_ADD(list_traversals, 1);
     temp = *headR;
     while (temp != NULL && temp->next != NULL)
     {
@@ -162,5 +176,18 @@ int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlis
         }
     }
 
+    STAT_PHASE_END(STAT_PHASE_NORMALIZE, normalize_start);
+
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * Statistics builds time the whole operation around the list arithmetic
+ */
+int subtraction(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2, Dlist **headR, Dlist **tailR)
+{
+    STAT_OP_BEGIN(op_start);
+    int status = subtract_lists(head1, tail1, head2, tail2, headR, tailR);
+    STAT_OP_END(STAT_OP_SUB, op_start);
+    return status;
+}
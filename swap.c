@@ -0,0 +1,21 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : swap.c
+ * Description   : Function to exchange two doubly linked lists
+ * Function      : swap
+ * Input Params  : head1, tail1 - First list
+ *                 head2, tail2 - Second list
+ * Return Value  : void
+ *******************************************************************************************************************************************************************/
+
+#include "apc.h"
+
+void swap(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2)
+{
+    Dlist *temp_head = *head1;
+    *head1 = *head2;
+    *head2 = temp_head;
+
+    Dlist *temp_tail = *tail1;
+    *tail1 = *tail2;
+    *tail2 = temp_tail;
+}
@@ -0,0 +1,365 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : thread_pool.c
+ * Description   : Fixed-size work-stealing thread pool
+ * Functions     : thread_pool_create, thread_pool_submit, thread_pool_wait, thread_pool_size,
+ *                 thread_pool_destroy, online_cpu_count
+ *
+ * Algorithm     : Every worker owns a deque of tasks guarded by its own mutex. Submitted tasks
+ *                 are dealt round-robin onto the deques. A worker takes tasks from the front of
+ *                 its own deque (oldest first, which keeps results close to submission order)
+ *                 and, when it runs dry, steals from the back of the other workers' deques, so
+ *                 an expensive task never leaves the rest of its deque stranded behind it.
+ *
+ *                 Idle workers sleep on one condition variable; 'queued' counts tasks sitting in
+ *                 any deque and 'outstanding' counts tasks not yet finished (for thread_pool_wait).
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* Initial slots of a worker deque (doubles when full) */
+#define TASK_DEQUE_SIZE 64
+
+typedef struct {
+    task_fn fn;
+    void *arg;
+} PoolTask;
+
+/* Ring-buffer deque owned by one worker */
+typedef struct {
+    pthread_mutex_t lock;
+    PoolTask *items;
+    size_t capacity;
+    size_t head;        /* Index of the oldest task */
+    size_t count;       /* Tasks in the deque       */
+} TaskDeque;
+
+struct thread_pool {
+    int size;                   /* Workers (and deques)           */
+    int running;                /* Worker threads actually started */
+    pthread_t *threads;
+    TaskDeque *deques;
+
+    pthread_mutex_t lock;       /* Guards the counters and the shutdown flag */
+    pthread_cond_t work_ready;  /* Signalled when tasks are queued           */
+    pthread_cond_t all_done;    /* Signalled when outstanding drops to 0     */
+    size_t queued;
+    size_t outstanding;
+    size_t next_deque;
+    int shutdown;
+};
+
+/* Worker start-up argument */
+typedef struct {
+    ThreadPool *pool;
+    int id;
+} WorkerArg;
+
+/**
+ * @brief Append a task at the back of a deque
+ */
+static int deque_push(TaskDeque *deque, PoolTask task)
+{
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity)
+    {
+        size_t grown_capacity = deque->capacity * 2;
+        PoolTask *grown = malloc(grown_capacity * sizeof(PoolTask));
+        if (grown == NULL)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return FAILURE;
+        }
+        for (size_t i = 0; i < deque->count; i++)
+        {
+            grown[i] = deque->items[(deque->head + i) % deque->capacity];
+        }
+        free(deque->items);
+        deque->items = grown;
+        deque->capacity = grown_capacity;
+        deque->head = 0;
+    }
+
+    deque->items[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+
+    pthread_mutex_unlock(&deque->lock);
+    return SUCCESS;
+}
+
+/**
+ * @brief Take a task from the front (owner) or the back (thief) of a deque
+ */
+static int deque_take(TaskDeque *deque, int from_back, PoolTask *task)
+{
+    int found = FALSE;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        if (from_back)
+        {
+            *task = deque->items[(deque->head + deque->count - 1) % deque->capacity];
+        }
+        else
+        {
+            *task = deque->items[deque->head];
+            deque->head = (deque->head + 1) % deque->capacity;
+        }
+        deque->count--;
+        found = TRUE;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return found;
+}
+
+/**
+ * @brief Find work: own deque first, then steal round the other workers
+ */
+static int find_task(ThreadPool *pool, int id, PoolTask *task)
+{
+    if (deque_take(&pool->deques[id], FALSE, task))
+    {
+        return TRUE;
+    }
+
+    for (int i = 1; i < pool->size; i++)
+    {
+        if (deque_take(&pool->deques[(id + i) % pool->size], TRUE, task))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Worker loop: run tasks until shutdown and every deque is empty
+ */
+static void *worker_main(void *raw)
+{
+    WorkerArg *arg = raw;
+    ThreadPool *pool = arg->pool;
+    int id = arg->id;
+    free(arg);
+
+    for (;;)
+    {
+        PoolTask task;
+
+        if (find_task(pool, id, &task))
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->queued--;
+            pthread_mutex_unlock(&pool->lock);
+
+            task.fn(task.arg, id);
+
+            pthread_mutex_lock(&pool->lock);
+            if (--pool->outstanding == 0)
+            {
+                pthread_cond_broadcast(&pool->all_done);
+            }
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        /* Nothing to run: sleep until tasks are queued or the pool shuts down */
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->shutdown)
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        int stop = (pool->shutdown && pool->queued == 0);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Number of online processors (at least 1)
+ */
+int online_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+/**
+ * Start a pool with 'threads' workers
+ */
+ThreadPool *thread_pool_create(int threads)
+{
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (pool == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        return NULL;
+    }
+
+    pool->threads = calloc((size_t)threads, sizeof(pthread_t));
+    pool->deques = calloc((size_t)threads, sizeof(TaskDeque));
+    if (pool->threads == NULL || pool->deques == NULL)
+    {
+        set_last_error("Memory allocation failed");
+        free(pool->threads);
+        free(pool->deques);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    pool->size = threads;
+    int status = SUCCESS;
+    for (int i = 0; i < threads; i++)
+    {
+        TaskDeque *deque = &pool->deques[i];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->items = malloc(TASK_DEQUE_SIZE * sizeof(PoolTask));
+        deque->capacity = TASK_DEQUE_SIZE;
+        if (deque->items == NULL)
+        {
+            set_last_error("Memory allocation failed");
+            status = FAILURE;
+        }
+    }
+
+    /* Start workers; destroy joins only the ones that are running */
+    for (int i = 0; i < threads && status == SUCCESS; i++)
+    {
+        WorkerArg *arg = malloc(sizeof(WorkerArg));
+        if (arg == NULL)
+        {
+            set_last_error("Memory allocation failed");
+            status = FAILURE;
+            break;
+        }
+        arg->pool = pool;
+        arg->id = i;
+
+        if (pthread_create(&pool->threads[i], NULL, worker_main, arg) != 0)
+        {
+            set_last_error("Cannot start worker thread");
+            free(arg);
+            status = FAILURE;
+            break;
+        }
+        pool->running++;
+    }
+
+    if (status == FAILURE)
+    {
+        thread_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/**
+ * Queue fn(arg, worker) for execution
+ */
+int thread_pool_submit(ThreadPool *pool, task_fn fn, void *arg)
+{
+    PoolTask task = { fn, arg };
+
+    pthread_mutex_lock(&pool->lock);
+    size_t target = pool->next_deque++ % (size_t)pool->size;
+    pool->outstanding++;
+    pool->queued++;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (deque_push(&pool->deques[target], task) == FAILURE)
+    {
+        set_last_error("Memory allocation failed");
+        pthread_mutex_lock(&pool->lock);
+        pool->outstanding--;
+        pool->queued--;
+        if (pool->outstanding == 0)
+        {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        return FAILURE;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    return SUCCESS;
+}
+
+/**
+ * Block until every submitted task has finished
+ */
+void thread_pool_wait(ThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (pool->outstanding > 0)
+    {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Number of worker threads
+ */
+int thread_pool_size(const ThreadPool *pool)
+{
+    return pool->size;
+}
+
+/**
+ * Finish queued tasks, stop the workers and free the pool
+ */
+void thread_pool_destroy(ThreadPool *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = TRUE;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->running; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for (int i = 0; i < pool->size; i++)
+    {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].items);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool->threads);
+    free(pool->deques);
+    free(pool);
+}
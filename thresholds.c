@@ -0,0 +1,281 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : thresholds.c
+ * Description   : Runtime crossover points between the multiplication and division kernels
+ * Functions     : thresholds, set_thresholds, default_thresholds, thresholds_file_path,
+ *                 load_thresholds, save_thresholds
+ *
+ * Design        : limb_mul and limb_div pick their kernel by comparing operand sizes with the
+ *                 values returned by thresholds(). They start out as the compiled-in defaults
+ *                 below; on first use the thresholds file is read once (pthread_once) and any
+ *                 value it contains replaces the default. The file is $APC_THRESHOLDS if that
+ *                 variable is set, otherwise $HOME/.apc_thresholds; "calculator --tune" writes
+ *                 it. A missing or unreadable file simply leaves the defaults in place.
+ *
+ * File format   : One "name = limbs" pair per line, '#' starts a comment:
+ *
+ *                     karatsuba = 32
+ *                     toom3 = 120
+ *                     ntt = 1000
+ *                     newton_div = 700
+ *                     parallel_add = 65536
+ *                     parallel_mul = 512
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+
+/* Compiled-in crossover points in limbs (1 limb = 9 decimal digits) */
+#define DEFAULT_KARATSUBA_THRESHOLD 32
+#define DEFAULT_TOOM3_THRESHOLD 120
+#define DEFAULT_NTT_THRESHOLD 1000
+#define DEFAULT_NEWTON_DIV_THRESHOLD 700
+#define DEFAULT_PARALLEL_ADD_THRESHOLD 65536
+#define DEFAULT_PARALLEL_MUL_THRESHOLD 512
+
+/* Karatsuba needs at least 4 limbs and Toom-3 at least 8 for the recursion to shrink */
+#define MIN_KARATSUBA_THRESHOLD 4
+#define MIN_TOOM3_THRESHOLD 8
+#define MIN_NTT_THRESHOLD 1
+#define MIN_NEWTON_DIV_THRESHOLD 2
+
+/* A parallel addition splits into blocks of at least 1024 limbs, so it needs two of them */
+#define MIN_PARALLEL_ADD_THRESHOLD 2048
+
+/* A parallel product runs Karatsuba / Toom-3 or the NTT at the top, which needs 4 limbs */
+#define MIN_PARALLEL_MUL_THRESHOLD 4
+
+/* File name below $HOME when APC_THRESHOLDS is not set */
+#define THRESHOLDS_FILE_NAME ".apc_thresholds"
+
+/* Longest line of a thresholds file */
+#define THRESHOLDS_LINE_SIZE 256
+
+static Thresholds active = {
+    DEFAULT_KARATSUBA_THRESHOLD,
+    DEFAULT_TOOM3_THRESHOLD,
+    DEFAULT_NTT_THRESHOLD,
+    DEFAULT_NEWTON_DIV_THRESHOLD,
+    DEFAULT_PARALLEL_ADD_THRESHOLD,
+    DEFAULT_PARALLEL_MUL_THRESHOLD
+};
+
+static pthread_once_t load_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Raise every value to the smallest size its algorithm can handle
+ */
+static void clamp_thresholds(Thresholds *t)
+{
+    if (t->karatsuba < MIN_KARATSUBA_THRESHOLD)
+    {
+        t->karatsuba = MIN_KARATSUBA_THRESHOLD;
+    }
+    if (t->toom3 < MIN_TOOM3_THRESHOLD)
+    {
+        t->toom3 = MIN_TOOM3_THRESHOLD;
+    }
+    if (t->ntt < MIN_NTT_THRESHOLD)
+    {
+        t->ntt = MIN_NTT_THRESHOLD;
+    }
+    if (t->newton_div < MIN_NEWTON_DIV_THRESHOLD)
+    {
+        t->newton_div = MIN_NEWTON_DIV_THRESHOLD;
+    }
+    if (t->parallel_add < MIN_PARALLEL_ADD_THRESHOLD)
+    {
+        t->parallel_add = MIN_PARALLEL_ADD_THRESHOLD;
+    }
+    if (t->parallel_mul < MIN_PARALLEL_MUL_THRESHOLD)
+    {
+        t->parallel_mul = MIN_PARALLEL_MUL_THRESHOLD;
+    }
+}
+
+/**
+ * @brief Read the thresholds file over the defaults (runs once per process)
+ */
+static void load_active(void)
+{
+    char path[PATH_MAX];
+
+    if (thresholds_file_path(path, sizeof(path)) == SUCCESS)
+    {
+        load_thresholds(path, &active);
+    }
+}
+
+/**
+ * @brief Store a parsed "name = value" pair; unknown names are ignored
+ */
+static void assign_threshold(Thresholds *t, const char *name, size_t value)
+{
+    if (strcmp(name, "karatsuba") == 0)
+    {
+        t->karatsuba = value;
+    }
+    else if (strcmp(name, "toom3") == 0)
+    {
+        t->toom3 = value;
+    }
+    else if (strcmp(name, "ntt") == 0)
+    {
+        t->ntt = value;
+    }
+    else if (strcmp(name, "newton_div") == 0)
+    {
+        t->newton_div = value;
+    }
+    else if (strcmp(name, "parallel_add") == 0)
+    {
+        t->parallel_add = value;
+    }
+    else if (strcmp(name, "parallel_mul") == 0)
+    {
+        t->parallel_mul = value;
+    }
+}
+
+/**
+ * Thresholds in effect (loads the thresholds file on first use)
+ */
+const Thresholds *thresholds(void)
+{
+    pthread_once(&load_once, load_active);
+    return &active;
+}
+
+/**
+ * Replace the thresholds in effect (values are clamped to their minimums)
+ */
+void set_thresholds(const Thresholds *t)
+{
+    pthread_once(&load_once, load_active);
+    active = *t;
+    clamp_thresholds(&active);
+}
+
+/**
+ * Compiled-in thresholds
+ */
+void default_thresholds(Thresholds *t)
+{
+    t->karatsuba = DEFAULT_KARATSUBA_THRESHOLD;
+    t->toom3 = DEFAULT_TOOM3_THRESHOLD;
+    t->ntt = DEFAULT_NTT_THRESHOLD;
+    t->newton_div = DEFAULT_NEWTON_DIV_THRESHOLD;
+    t->parallel_add = DEFAULT_PARALLEL_ADD_THRESHOLD;
+    t->parallel_mul = DEFAULT_PARALLEL_MUL_THRESHOLD;
+}
+
+/**
+ * Location of the thresholds file: $APC_THRESHOLDS, else $HOME/.apc_thresholds
+ */
+int thresholds_file_path(char *path, size_t size)
+{
+    const char *env = getenv("APC_THRESHOLDS");
+    int written;
+
+    if (env != NULL && env[0] != '\0')
+    {
+        written = snprintf(path, size, "%s", env);
+    }
+    else
+    {
+        const char *home = getenv("HOME");
+        if (home == NULL || home[0] == '\0')
+        {
+            return FAILURE;
+        }
+        written = snprintf(path, size, "%s/%s", home, THRESHOLDS_FILE_NAME);
+    }
+
+    return (written > 0 && (size_t)written < size) ? SUCCESS : FAILURE;
+}
+
+/**
+ * Overwrite the fields of 't' named in a thresholds file
+ */
+int load_thresholds(const char *path, Thresholds *t)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return FAILURE;
+    }
+
+    char line[THRESHOLDS_LINE_SIZE];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+
+        char *equals = strchr(line, '=');
+        if (equals == NULL)
+        {
+            continue;
+        }
+        *equals = '\0';
+
+        /* Trim the name */
+        char *name = line;
+        while (isspace((unsigned char)*name))
+        {
+            name++;
+        }
+        char *name_end = equals;
+        while (name_end > name && isspace((unsigned char)name_end[-1]))
+        {
+            name_end--;
+        }
+        *name_end = '\0';
+
+        /* The value must be a plain decimal count */
+        char *end;
+        errno = 0;
+        unsigned long long value = strtoull(equals + 1, &end, 10);
+        while (isspace((unsigned char)*end))
+        {
+            end++;
+        }
+        if (errno != 0 || end == equals + 1 || *end != '\0' || strchr(equals + 1, '-') != NULL)
+        {
+            continue;
+        }
+
+        assign_threshold(t, name, (value > SIZE_MAX) ? SIZE_MAX : (size_t)value);
+    }
+
+    fclose(file);
+    clamp_thresholds(t);
+    return SUCCESS;
+}
+
+/**
+ * Write thresholds in the format load_thresholds reads
+ */
+int save_thresholds(const char *path, const Thresholds *t)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return FAILURE;
+    }
+
+    fprintf(file, "# APC kernel crossover points in limbs of 9 digits (written by calculator --tune)\n");
+    fprintf(file, "karatsuba = %zu\n", t->karatsuba);
+    fprintf(file, "toom3 = %zu\n", t->toom3);
+    fprintf(file, "ntt = %zu\n", t->ntt);
+    fprintf(file, "newton_div = %zu\n", t->newton_div);
+    fprintf(file, "parallel_add = %zu\n", t->parallel_add);
+    fprintf(file, "parallel_mul = %zu\n", t->parallel_mul);
+
+    return (fclose(file) == 0) ? SUCCESS : FAILURE;
+}
@@ -0,0 +1,303 @@
+/*******************************************************************************************************************************************************************
+ * File Name     : tune.c
+ * Description   : "calculator --tune": measure the kernel crossover points on this machine
+ * Function      : run_tune
+ *
+ * Algorithm     : The thresholds are tuned one at a time, smallest kernel first, with every
+ *                 threshold not yet tuned switched off (SIZE_MAX):
+ *
+ *                   karatsuba   - schoolbook vs Karatsuba      (n x n limbs)
+ *                   toom3       - Karatsuba  vs Toom-3         (n x n limbs)
+ *                   ntt         - Toom-3     vs NTT            (n x n limbs)
+ *                   newton_div  - Knuth D    vs Newton         (2n / n limbs)
+ *                   parallel_add - serial   vs carry-select   (n + n limbs, more than one thread)
+ *                   parallel_mul - serial   vs parallel       (n x n limbs, more than one thread)
+ *
+ *                 For each candidate size n the same operation is timed with the threshold at
+ *                 n + 1 (the top level uses the slower kernel) and at n (the top level switches
+ *                 to the faster one; the recursion below is unchanged). The crossover is the
+ *                 first candidate from which the faster kernel wins at two sizes in a row, so a
+ *                 single noisy measurement cannot pull the threshold down. When it never wins
+ *                 the largest candidate is kept.
+ *
+ *                 Each timing is the best of TUNE_REPEATS runs of at least TUNE_MIN_TIME seconds.
+ *******************************************************************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "apc.h"
+#include <time.h>
+
+/* Best of this many timings, each at least this long (seconds) */
+#define TUNE_REPEATS 3
+#define TUNE_MIN_TIME 0.01
+
+/* Candidate sizes in limbs (each list ends with 0) */
+static const size_t karatsuba_sizes[] = { 8, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 0 };
+static const size_t toom3_sizes[] = { 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512, 640, 0 };
+static const size_t ntt_sizes[] = { 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192, 0 };
+static const size_t newton_div_sizes[] = { 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 0 };
+static const size_t parallel_add_sizes[] = { 2048, 4096, 8192, 16384, 32768, 65536, 131072, 262144, 524288, 1048576, 0 };
+static const size_t parallel_mul_sizes[] = { 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 0 };
+
+/* Operation timed for a threshold */
+typedef enum {
+    TUNE_MUL,       /* (n limbs) x (n limbs) */
+    TUNE_DIV,       /* (2n limbs) / (n limbs) */
+    TUNE_ADD        /* (n limbs) + (n limbs) */
+} TuneKernel;
+
+/* Operands and outputs of the kernel being timed */
+typedef struct {
+    limb_t *a;
+    limb_t *b;
+    limb_t *q;
+    limb_t *r;
+    size_t n;
+    TuneKernel kernel;
+} TuneCase;
+
+/**
+ * @brief Monotonic clock in seconds
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Fill limbs with pseudo-random values below LIMB_BASE (xorshift, fixed seed)
+ */
+static void random_limbs(limb_t *x, size_t n, uint64_t *state)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        x[i] = (limb_t)(*state % LIMB_BASE);
+    }
+
+    /* Keep the top limb non-zero so the operand really has n limbs */
+    if (n > 0 && x[n - 1] == 0)
+    {
+        x[n - 1] = 1;
+    }
+}
+
+/**
+ * @brief Run the timed operation once
+ */
+static int run_case(const TuneCase *tc)
+{
+    switch (tc->kernel)
+    {
+        case TUNE_DIV:
+            return limb_div(tc->q, tc->r, tc->a, 2 * tc->n, tc->b, tc->n);
+
+        case TUNE_ADD:
+            limb_add(tc->r, tc->a, tc->n, tc->b, tc->n);
+            return SUCCESS;
+
+        default:
+            return limb_mul(tc->r, tc->a, tc->n, tc->b, tc->n);
+    }
+}
+
+/**
+ * @brief Seconds per operation under the current thresholds (negative on failure)
+ */
+static double time_case(const TuneCase *tc)
+{
+    double best = -1.0;
+
+    for (int repeat = 0; repeat < TUNE_REPEATS; repeat++)
+    {
+        long runs = 0;
+        double start = now_seconds();
+        double elapsed;
+
+        do
+        {
+            if (run_case(tc) == FAILURE)
+            {
+                return -1.0;
+            }
+            runs++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < TUNE_MIN_TIME);
+
+        double per_run = elapsed / (double)runs;
+        if (best < 0.0 || per_run < best)
+        {
+            best = per_run;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Find the crossover of one threshold and leave it set in 'tuned'
+ * @param name Threshold name for the report
+ * @param sizes Candidate sizes (0-terminated, ascending)
+ * @param field The threshold inside 'tuned'
+ * @param tuned Thresholds in effect while measuring
+ * @param kernel Operation to time
+ */
+static int tune_threshold(const char *name, const size_t *sizes, size_t *field, Thresholds *tuned,
+                          TuneKernel kernel)
+{
+    size_t largest = 0;
+    for (const size_t *n = sizes; *n != 0; n++)
+    {
+        largest = *n;
+    }
+
+    /* Buffers for the largest case, reused for every size */
+    TuneCase tc = { 0 };
+    tc.kernel = kernel;
+    tc.a = malloc(2 * largest * sizeof(limb_t));
+    tc.b = malloc(largest * sizeof(limb_t));
+    tc.q = malloc((largest + 1) * sizeof(limb_t));
+    tc.r = malloc(2 * largest * sizeof(limb_t));
+    if (tc.a == NULL || tc.b == NULL || tc.q == NULL || tc.r == NULL)
+    {
+        fprintf(stderr, "[ERROR]: Memory allocation failed in tune_threshold\n");
+        free(tc.a);
+        free(tc.b);
+        free(tc.q);
+        free(tc.r);
+        return FAILURE;
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    size_t crossover = largest;
+    size_t streak_start = 0;
+    int wins = 0;
+    int status = SUCCESS;
+
+    printf("%-10s  %8s  %12s  %12s  %6s\n", name, "limbs", "below (us)", "at (us)", "ratio");
+
+    for (const size_t *n = sizes; *n != 0 && status == SUCCESS; n++)
+    {
+        tc.n = *n;
+        random_limbs(tc.a, (kernel == TUNE_DIV) ? 2 * tc.n : tc.n, &state);
+        random_limbs(tc.b, tc.n, &state);
+
+        *field = tc.n + 1;
+        set_thresholds(tuned);
+        double below = time_case(&tc);
+
+        *field = tc.n;
+        set_thresholds(tuned);
+        double at = time_case(&tc);
+
+        if (below < 0.0 || at < 0.0)
+        {
+            fprintf(stderr, "[ERROR]: Kernel failed while tuning %s\n", name);
+            status = FAILURE;
+            break;
+        }
+
+        printf("%-10s  %8zu  %12.2f  %12.2f  %6.2f\n", "", tc.n, below * 1e6, at * 1e6, at / below);
+
+        if (at < below)
+        {
+            if (wins++ == 0)
+            {
+                streak_start = tc.n;
+            }
+            if (wins == 2)
+            {
+                crossover = streak_start;
+                break;
+            }
+        }
+        else
+        {
+            wins = 0;
+        }
+    }
+
+    *field = crossover;
+    set_thresholds(tuned);
+    printf("%-10s  -> %zu limbs\n\n", name, crossover);
+
+    free(tc.a);
+    free(tc.b);
+    free(tc.q);
+    free(tc.r);
+    return status;
+}
+
+/**
+ * Measure every threshold and write the thresholds file
+ */
+int run_tune(const CalcOptions *options)
+{
+    char default_path[PATH_MAX];
+    const char *path = options->tune_path;
+
+    if (path == NULL)
+    {
+        if (thresholds_file_path(default_path, sizeof(default_path)) == FAILURE)
+        {
+            fprintf(stderr, "[ERROR]: No thresholds file location (set APC_THRESHOLDS or HOME)\n");
+            return FAILURE;
+        }
+        path = default_path;
+    }
+
+    /* Start with every kernel above schoolbook / Knuth D switched off */
+    Thresholds tuned = { SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX };
+
+    int status = tune_threshold("karatsuba", karatsuba_sizes, &tuned.karatsuba, &tuned, TUNE_MUL);
+    if (status == SUCCESS)
+    {
+        status = tune_threshold("toom3", toom3_sizes, &tuned.toom3, &tuned, TUNE_MUL);
+    }
+    if (status == SUCCESS)
+    {
+        status = tune_threshold("ntt", ntt_sizes, &tuned.ntt, &tuned, TUNE_MUL);
+    }
+    if (status == SUCCESS)
+    {
+        status = tune_threshold("newton_div", newton_div_sizes, &tuned.newton_div, &tuned, TUNE_DIV);
+    }
+
+    /* With a single thread there is nothing to measure: keep the defaults */
+    if (status == SUCCESS && parallel_threads() > 1)
+    {
+        status = tune_threshold("parallel_add", parallel_add_sizes, &tuned.parallel_add, &tuned, TUNE_ADD);
+        if (status == SUCCESS)
+        {
+            status = tune_threshold("parallel_mul", parallel_mul_sizes, &tuned.parallel_mul, &tuned, TUNE_MUL);
+        }
+    }
+    else if (status == SUCCESS)
+    {
+        Thresholds defaults;
+        default_thresholds(&defaults);
+        tuned.parallel_add = defaults.parallel_add;
+        tuned.parallel_mul = defaults.parallel_mul;
+        set_thresholds(&tuned);
+        printf("%-10s  -> %zu limbs (single thread, default kept)\n", "parallel_add", tuned.parallel_add);
+        printf("%-10s  -> %zu limbs (single thread, default kept)\n\n", "parallel_mul", tuned.parallel_mul);
+    }
+    if (status == FAILURE)
+    {
+        return FAILURE;
+    }
+
+    if (save_thresholds(path, &tuned) == FAILURE)
+    {
+        fprintf(stderr, "[ERROR]: Cannot write thresholds file '%s'\n", path);
+        return FAILURE;
+    }
+
+    printf("Thresholds written to %s\n", path);
+    return SUCCESS;
+}
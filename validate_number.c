@@ -1,12 +1,13 @@
 /*******************************************************************************************************************************************************************
  * File Name     : validate_number.c
- * Description   : Function to validate if a string represents a valid number
+ * Description   : Function to validate if a string represents a valid number (decimal or 0x hex)
  * Function      : validate_number
  * Input Params  : str - String to validate
  * Return Value  : TRUE if valid number, FALSE otherwise
  *******************************************************************************************************************************************************************/
 
 #include "apc.h"
+#include <ctype.h>
 
 int validate_number(const char *str)
 {
@@ -32,6 +33,24 @@ int validate_number(const char *str)
         }
     }
 
+    /* Hexadecimal integer: "0x" and at least one hex digit */
+    if (str[i] == '0' && (str[i + 1] == 'x' || str[i + 1] == 'X'))
+    {
+        i += 2;
+        if (str[i] == '\0')
+        {
+            return FALSE;
+        }
+        for (; str[i] != '\0'; i++)
+        {
+            if (!isxdigit((unsigned char)str[i]))
+            {
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
     /* Check each character */
     while (str[i] != '\0')
     {